@@ -194,7 +194,7 @@ std::string getAbsolutePath();
 //         charactor->Move(charactor->velBySec(_TIME_PER_UPDATE));
 
 //         // 관측자 이동
-//         yOfCam = glm::radians(mainCam->getRotate().y);
+//         yOfCam = glm::radians(mainCam->getYaw());
 
 //         frontOfCam  = glm::vec3(sin(-yOfCam), 0.0f, cos(-yOfCam)) * camSpeed * _TIME_PER_UPDATE;
 //         rightOfCam  = glm::vec3(cos(yOfCam), 0.0f, sin(yOfCam)) * camSpeed * _TIME_PER_UPDATE;
@@ -396,7 +396,7 @@ public:
         lightPos->setPosition(mainLight->getPosition());     
 
         // 관측자 이동
-        yOfCam = glm::radians(mainCam->getRotate().y);
+        yOfCam = glm::radians(mainCam->getYaw());
 
         frontOfCam  = glm::vec3(sin(-yOfCam), 0.0f, cos(-yOfCam)) * camSpeed * _TIME_PER_UPDATE;
         rightOfCam  = glm::vec3(cos(yOfCam), 0.0f, sin(yOfCam)) * camSpeed * _TIME_PER_UPDATE;
@@ -458,44 +458,152 @@ public:
     } 
 };
 
-char** _UIMAP;
-
-void batchUI();
 uint32_t getUIIdx();
 
-int main() {
+int main(int argc, char** argv) {
     // standardRoutine rt;
     shadowRoutine rt;
-
-    _UIMAP = new char*[HEIGHT];
-    for (int i = 0; i< HEIGHT; i++) {
-        _UIMAP[i] = new char[WIDTH];
-        for (int j = 0; j < WIDTH; j++)
-            _UIMAP[i][j] = 0;
-    }
     
+    // 클릭 가능한 UI는 createUI에서 uiHitIndex에 들어간다
     rt.Awake();
-    // UI 배치
-    batchUI();
 
     try {
+        // --record <파일> / --replay <파일>: 프레임별 입력과 프레임 시간을 남기거나 되돌린다
+        // --headless [--width N --height N]: 창 없이 screenImage에 그린다
+        // --frames N: N 프레임을 그리고 끝낸다 (0이면 창을 닫거나 재생이 끝날 때까지)
+        // --capture <접두어>: 그린 프레임을 <접두어>000000.ppm ... 으로 저장 (소비 스레드에서)
+        // --gpu-profile [--gpu-profile-objects]: GPU 구간 시간 / pipeline statistics를 모아 끝날 때 출력
+        // --profile <파일>: CPU 구간을 처음부터 기록해 끝날 때 Chrome trace JSON으로 쓴다.
+        //                   F12는 기록을 켜고, 켜져 있으면 지금 링에 남은 구간을 같은 파일로 쓴다 (기본 profile.json)
+        // --threaded-physics: 고정 step 물리를 전용 스레드에서 돌린다 (--record / --replay 중에는 메인 스레드)
+        // --bindless: 전역 텍스처 배열 + draw 버퍼로 그린다 (장치가 descriptor indexing을 지원하지 않으면 기존 경로)
+        // --benchmark <이름>: 창 / Vulkan 없이 CPU 벤치마크 하나만 돌리고 끝낸다 (bodystore, matrix, narrowphase, broadphase)
+        uint32_t maxFrames = 0;
+        std::string capturePrefix;
+        std::string profilePath;
+        std::string benchmark;
+
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+
+            if (arg == "--record" && i + 1 < argc)
+                inputReplay.startRecording(argv[++i]);
+            else if (arg == "--replay" && i + 1 < argc)
+                inputReplay.startReplay(argv[++i]);
+            else if (arg == "--headless")
+                headless = true;
+            else if (arg == "--width" && i + 1 < argc)
+                headlessExtent.width = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (arg == "--height" && i + 1 < argc)
+                headlessExtent.height = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (arg == "--frames" && i + 1 < argc)
+                maxFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (arg == "--capture" && i + 1 < argc)
+                capturePrefix = argv[++i];
+            else if (arg == "--gpu-profile")
+                gpuProfiler.enabled = true;
+            else if (arg == "--gpu-profile-objects")
+                gpuProfiler.enabled = gpuProfiler.perObject = true;
+            else if (arg == "--profile" && i + 1 < argc) {
+                profilePath = argv[++i];
+                profiler::enabled = true;
+            }
+            else if (arg == "--threaded-physics")
+                physicsScheduler.threaded = true;
+            else if (arg == "--bindless")
+                enableBindless = true;
+            else if (arg == "--benchmark" && i + 1 < argc)
+                benchmark = argv[++i];
+            else
+                throw std::runtime_error("알 수 없는 인자: " + arg);
+        }
+
+        if (headless && (headlessExtent.width == 0 || headlessExtent.height == 0))
+            throw std::runtime_error("headless 해상도가 0");
+
+        if (!benchmark.empty()) {
+            if (benchmark == "bodystore")
+                benchmarkBodyStore();
+            else if (benchmark == "matrix")
+                benchmarkMatrixKernel();
+            else if (benchmark == "narrowphase")
+                benchmarkNarrowPhase();
+            else if (benchmark == "broadphase")
+                benchmarkBroadPhase();
+            else
+                throw std::runtime_error("알 수 없는 벤치마크: " + benchmark);
+            return EXIT_SUCCESS;
+        }
+
+        // 재생이 같은 step을 밟도록 물리는 프레임 시간으로만 진행
+        if (inputReplay.getMode() != InputReplay::Off)
+            physicsScheduler.threaded = false;
+
+        PROFILE_THREAD("main");
+
         initWindow();
         initVulkan();
+
+        if (!capturePrefix.empty()) {
+            frameCapture.start([capturePrefix](const FrameCapture::Frame& frame) {
+                char number[16];
+                snprintf(number, sizeof(number), "%06llu", static_cast<unsigned long long>(frame.index));
+                FrameCapture::savePPM(frame, capturePrefix + number + ".ppm");
+            });
+        }
         
         rt.Start();
 
-        while(!glfwWindowShouldClose(window)) {
-            glfwPollEvents();
+        // 물리는 고정 간격으로 (physicsScheduler.threaded = true 면 전용 스레드에서)
+        physicsScheduler.start([&rt]() { rt.PhysicalUpdate(); });
+
+        for (uint32_t frame = 0; !shouldClose() && (maxFrames == 0 || frame < maxFrames); frame++) {
+            // headless는 창이 없으므로 입력은 재생 파일에서만 온다
+            if (!headless) {
+                PROFILE_ZONE("input");
 
-            // rt.PhysicalUpdate();
-            rt.Update();
+                glfwPollEvents();
+                // 이번 프레임의 Update와 클릭 판정은 같은 입력 snapshot을 본다
+                input::update();
+            }
+
+            {
+                PROFILE_ZONE("Update");
+
+                std::lock_guard<std::mutex> lock(physicsScheduler.mutex);
+                rt.Update();
+            }
+            physicsScheduler.advance(rt._TIME_PER_UPDATE);
             
             if (input::getMouseButtonDown(GLFW_MOUSE_BUTTON_LEFT))
                 getUIIdx();
 
+            if (input::getKeyDown(GLFW_KEY_F12)) {
+                std::string path = profilePath.empty() ? "profile.json" : profilePath;
+
+                if (!profiler::enabled) {
+                    profiler::enabled = true;
+                    std::cout << "CPU profiler on (F12로 " << path << "에 저장)" << std::endl;
+                }
+                else {
+                    profiler::writeChromeTrace(path);
+                    std::cout << "CPU profile: " << path << std::endl;
+                }
+            }
+
             drawFrame();
+
+            PROFILE_FRAME();
         }
+        physicsScheduler.stop();
+        inputReplay.stop();
         vkDeviceWaitIdle(device);
+
+        if (gpuProfiler.isActive())
+            gpuProfiler.report(std::cout);
+
+        if (!profilePath.empty())
+            profiler::writeChromeTrace(profilePath);
         
         rt.End();
         
@@ -509,6 +617,14 @@ int main() {
             delete(ui);
         }
 
+        for (Text* text : textList) {
+            delete(text);
+        }
+
+        for (Font* font : fontList) {
+            delete(font);
+        }
+
         for (Camera* cam : cameraObejctList) {
             delete(cam);
         }
@@ -523,39 +639,18 @@ int main() {
         return EXIT_FAILURE;
     }
 
-    for (int i = 0; i < HEIGHT; i++) {
-        delete(_UIMAP[i]);
-    }
-    delete[] (_UIMAP);
-
     return EXIT_SUCCESS;
 }
 
-void batchUI() {
-    for (UI* ui : UIList) {
-        if (!ui->clickable)
-            continue;
-        uint32_t x0(ui->getExtent()[0]),
-                 y0(ui->getExtent()[1]),
-                 x1(ui->getExtent()[2]), 
-                 y1(ui->getExtent()[3]);
-
-        uint32_t idx = ui->getIndex();
-
-        for (int y = y0; y < y1; y++)
-            for (int x = x0; x < x1; x++)
-                _UIMAP[y][x] = idx;
-    }
-}
-
 uint32_t getUIIdx() {
     double xpos, ypos;
-    glfwGetCursorPos(window, &xpos, &ypos);
+    input::getMousePos(xpos, ypos);
 
-    if ((int)xpos < WIDTH && (int)ypos < HEIGHT)
-        std::cout << (int)_UIMAP[(int)ypos][(int)xpos] << std::endl;
+    UI* ui = pickUI(xpos, ypos);
+    uint32_t idx = ui ? ui->getIndex() : 0;
+    std::cout << idx << std::endl;
 
-    return 0;
+    return idx;
 }
 
 std::string getAbsolutePath() {
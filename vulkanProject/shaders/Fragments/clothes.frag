@@ -1,8 +1,24 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
-
-layout(binding = 1) uniform sampler2D texSampler;
-layout(set = 0, binding = 2) uniform sampler2D alphaSampler;
+#ifdef BINDLESS
+#extension GL_EXT_nonuniform_qualifier : enable
+#endif
+
+#ifdef BINDLESS
+layout( push_constant ) uniform DrawIndex {
+    layout(offset = 68) uint textureIndex;
+    uint alphaIndex;
+} drawIdx;
+
+layout(set = 0, binding = 4) uniform sampler2D textures[];
+
+#define texSampler textures[drawIdx.textureIndex]
+#define alphaSampler textures[drawIdx.alphaIndex]
+#else
+// 재질 셋 : 텍스처가 같은 모델끼리 공유
+layout(set = 1, binding = 1) uniform sampler2D texSampler;
+layout(set = 1, binding = 2) uniform sampler2D alphaSampler;
+#endif
 
 layout(location = 0) in vec2 fragTexCoord;
 layout(location = 1) in vec3 normalVector;
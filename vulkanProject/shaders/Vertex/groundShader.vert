@@ -1,13 +1,22 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(binding = 0) uniform UniformBufferObject {
+#ifdef BINDLESS
+// 전역 draw 버퍼에서 drawIndex 번째 항목을 사용
+struct DrawData {
     mat4 model;
-    
-    mat4 pitch;
-    mat4 yaw;
-    mat4 roll;
+    mat4 view;
+    mat4 proj;
+};
 
+layout(set = 0, binding = 0) readonly buffer DrawBufferObject {
+    DrawData draws[];
+} dbo;
+
+#define ubo dbo.draws[targetVec.drawIndex]
+#else
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
     mat4 view;
     mat4 proj;
 } ubo;
@@ -16,6 +25,7 @@ layout(binding = 3) uniform TexelBufferObject {
     vec4 position;
     vec4 color;
 } tbo;
+#endif
 
 layout( push_constant ) uniform TargetVec {
     vec3 CamPos;
@@ -24,6 +34,9 @@ layout( push_constant ) uniform TargetVec {
 
     // 그림자가 적용이 되어질 오브젝트의 inPosition
     vec3 inShadowModelPosition;
+#ifdef BINDLESS
+    layout(offset = 64) uint drawIndex;
+#endif
 } targetVec;
 
 // Normal
@@ -53,8 +66,8 @@ void main() {
                             (shadow_coords.y < shadow_coords.z - 0.005)
                         ) ? 0.2f : 1.0f));
 
+    // view에 카메라 회전이 이미 곱해져 있음
     gl_Position =   ubo.proj *
-                    ( ubo.pitch * ubo.yaw * ubo.roll ) *  
                     ubo.view *
                     ubo.model * 
                     vec4(inPosition, 1.0);
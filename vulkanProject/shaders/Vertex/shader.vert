@@ -1,13 +1,22 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(binding = 0) uniform UniformBufferObject {
+#ifdef BINDLESS
+// 전역 draw 버퍼에서 drawIndex 번째 항목을 사용
+struct DrawData {
     mat4 model;
-    
-    mat4 pitch;
-    mat4 yaw;
-    mat4 roll;
+    mat4 view;
+    mat4 proj;
+};
 
+layout(set = 0, binding = 0) readonly buffer DrawBufferObject {
+    DrawData draws[];
+} dbo;
+
+#define ubo dbo.draws[targetVec.drawIndex]
+#else
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
     mat4 view;
     mat4 proj;
 } ubo;
@@ -16,11 +25,15 @@ layout(binding = 3) uniform TexelBufferObject {
     vec4 position;
     vec4 color;
 } tbo;
+#endif
 
 layout( push_constant ) uniform TargetVec {
     vec3 CamPos;
     vec3 LightPos;
     vec3 Normal;
+#ifdef BINDLESS
+    layout(offset = 64) uint drawIndex;
+#endif
 } targetVec;
 
 // Normal
@@ -39,9 +52,7 @@ layout(location = 6) out mat3 modelMatrix;
 layout(location = 9) out float attenuation;
 
 void main() {
-    lightPosition = mat3(   ( ubo.pitch * ubo.yaw * ubo.roll ) *
-                            ubo.model) * 
-                            inPosition - targetVec.LightPos;
+    lightPosition = mat3(ubo.model) * inPosition - targetVec.LightPos;
     vec3 lightPos = vec3(-targetVec.LightPos.x, targetVec.LightPos.y, targetVec.LightPos.z);
 
     float distance = length ( lightPosition );
@@ -51,7 +62,6 @@ void main() {
     
     vec4 GL_POSITION =  ubo.proj *
                         ubo.view * 
-                        ( ubo.pitch * ubo.yaw * ubo.roll ) *
                         ubo.model * 
                         vec4(lightPos, 1.0) * 
                         vec4(inPosition, 1.0);
@@ -63,8 +73,8 @@ void main() {
                         ) ? 0.2f : 1.0f));
     // testshadow = vec3 (shadow_coords);
 
+    // view에 카메라 회전이 이미 곱해져 있음
     gl_Position =   ubo.proj *
-                    ( ubo.pitch * ubo.yaw * ubo.roll ) *  
                     ubo.view *
                     ubo.model * 
                     vec4(inPosition, 1.0);
@@ -12,6 +12,7 @@ void createSurface();
 void pickPhysicalDevice() ;
 void createLogicalDevice();
 void createSwapChain();
+void createHeadlessTarget();
 void createImageViews();
 void createRenderPass();
 void createFramebuffers();
@@ -22,31 +23,57 @@ void createDepthResources();
 void generateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels);
 void createTextureSampler();
 void createCommandBuffers();
+void createBindlessResources();
+void cleanupBindless();
 
 
 // Will be deplicated.
 void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) ;
+void copyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize size, VkDeviceSize dstOffset = 0);
 void createSyncObjects();
 
-void updateUniformBuffer(uint32_t currentImage, GameObject* gameObject);
+void updateUniformBuffer(uint32_t frame, GameObject* gameObject, Models* m, const glm::mat4& view, const glm::mat4& proj);
+
+// headless가 아니면 창이 닫혔을 때, headless면 requestClose 뒤
+bool shouldClose() {
+    return headless ? closeRequested : glfwWindowShouldClose(window);
+}
+
+void requestClose() {
+    if (headless)
+        closeRequested = true;
+    else
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+}
 
 void initWindow() {
+    // 창도 GLFW도 쓰지 않는다 (디스플레이가 없어도 된다)
+    if (headless)
+        return;
+
     glfwInit();
 
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 
     window = glfwCreateWindow(WIDTH, HEIGHT, "Vulkan", nullptr, nullptr);
     glfwSetFramebufferSizeCallback(window, nullptr);
+
+    input::init(window);
 }
 
 void initVulkan() {
     createInstance();
     setupDebugMessenger();
-    createSurface();
+    if (!headless)
+        createSurface();
     pickPhysicalDevice();
     createLogicalDevice();
-    createSwapChain();
-    createImageViews();
+    if (headless)
+        createHeadlessTarget();
+    else {
+        createSwapChain();
+        createImageViews();
+    }
     createRenderPass();
     createCommandPool();
     createColorResources();
@@ -54,6 +81,11 @@ void initVulkan() {
     createDepthResources();
     createFramebuffers();
     createTextureSampler();
+    if (enableBindless)
+        createBindlessResources();
+    else
+        createMaterialSetLayout();
+    uiBatcher.init();
     createCommandBuffers();
     createSyncObjects();
 }
@@ -85,10 +117,13 @@ void cleanupSwapChain() {
         vkDestroyImageView(device, imageView, nullptr);
     }
 
-    vkDestroySwapchainKHR(device, swapChain, nullptr);
+    if (!headless)
+        vkDestroySwapchainKHR(device, swapChain, nullptr);
 }
 
 void cleanup() {
+    frameCapture.stop();
+
     cleanupSwapChain();
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
@@ -97,6 +132,23 @@ void cleanup() {
         vkDestroyFence(device, inFlightFences[i], nullptr);
     }
 
+    if (enableBindless)
+        cleanupBindless();
+
+    uiBatcher.destroy();
+    geometryPool.destroy();
+    gpuProfiler.destroy();
+
+    if (!enableBindless) {
+        descriptorCache.dropLayout(materialSetLayout);
+        vkDestroyDescriptorSetLayout(device, materialSetLayout, nullptr);
+    }
+
+    descriptorCache.destroy();
+    descriptorAllocator.destroy();
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        frameDescriptorAllocators[i].destroy();
+
     vkDestroySampler(device, textureSampler, nullptr);
 
     vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
@@ -111,6 +163,11 @@ void cleanup() {
         destroyDebugUtilsMessenger(instance, debugMessenger, nullptr);
     }
 
+    if (headless) {
+        vkDestroyInstance(instance, nullptr);
+        return;
+    }
+
     vkDestroySurfaceKHR(instance, surface, nullptr);
     vkDestroyInstance(instance, nullptr);
 
@@ -138,9 +195,13 @@ void recreateSwapChain() {
     createScreenResources();
     createDepthResources();
     createFramebuffers();
+    uiBatcher.refresh();
     createCommandBuffers();
 
     imagesInFlight.resize(swapChainImages.size(), VK_NULL_HANDLE);
+
+    // 크기 / 형식이 바뀌었을 수 있다
+    frameCapture.refresh();
 }
 
 void createInstance() {
@@ -160,8 +221,14 @@ void createInstance() {
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo = &appInfo;
 
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(instanceExtensions.size());
-    createInfo.ppEnabledExtensionNames = instanceExtensions.data();
+    // headless는 surface 확장 (VK_KHR_surface, xcb) 없이 만든다
+    std::vector<const char*> extensions;
+    for (const char* name : instanceExtensions)
+        if (!headless || !strstr(name, "surface"))
+            extensions.push_back(name);
+
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
 
     VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo;
     if (enableValidationLayers) {
@@ -250,6 +317,47 @@ void pickPhysicalDevice() {
     else                                 { msaaSamples = VK_SAMPLE_COUNT_1_BIT;  }
 }
 
+// bindless에 필요한 확장과 descriptor indexing 기능을 지원하는지 확인
+bool checkBindlessSupport() {
+    uint32_t extCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, nullptr);
+    std::vector<VkExtensionProperties> extProps(extCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, extProps.data());
+
+    for (const char* name : bindlessDeviceExtensions) {
+        bool found = false;
+        for (const VkExtensionProperties& prop : extProps) {
+            if (!strcmp(prop.extensionName, name)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            return false;
+    }
+
+    PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2;
+    getPhysicalDeviceFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR"));
+    if (!getPhysicalDeviceFeatures2)
+        return false;
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2KHR features2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features2.pNext = &indexingFeatures;
+
+    getPhysicalDeviceFeatures2(physicalDevice, &features2);
+
+    return  features2.features.shaderSampledImageArrayDynamicIndexing &&
+            indexingFeatures.runtimeDescriptorArray &&
+            indexingFeatures.descriptorBindingPartiallyBound &&
+            indexingFeatures.descriptorBindingVariableDescriptorCount &&
+            indexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+            indexingFeatures.descriptorBindingUpdateUnusedWhilePending;
+}
+
 void createLogicalDevice() {
     QueueFamilyIndices indices;
 
@@ -268,7 +376,11 @@ void createLogicalDevice() {
         if (prop.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
             indices.graphicsFamily = i;
         }
-        vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &isSupportedSurface);
+        // headless는 present하지 않으므로 그래픽 큐를 presentQueue로도 쓴다
+        if (headless)
+            isSupportedSurface = (prop.queueFlags & VK_QUEUE_GRAPHICS_BIT) ? VK_TRUE : VK_FALSE;
+        else
+            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &isSupportedSurface);
         if  (isSupportedSurface) {
             indices.presentFamily = i;
         }
@@ -292,17 +404,44 @@ void createLogicalDevice() {
 
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    gpuProfiler.requestFeatures(deviceFeatures);
+
+    std::vector<const char*> enabledExtensions;
+    for (const char* name : deviceExtensions)
+        if (!headless || strcmp(name, VK_KHR_SWAPCHAIN_EXTENSION_NAME))
+            enabledExtensions.push_back(name);
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+    if (enableBindless && !checkBindlessSupport()) {
+        std::cerr << "descriptor indexing을 지원하지 않는 물리디바이스. bindless 비활성화." << std::endl;
+        enableBindless = false;
+    }
+
+    if (enableBindless) {
+        enabledExtensions.insert(enabledExtensions.end(), bindlessDeviceExtensions.begin(), bindlessDeviceExtensions.end());
+
+        deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
+        indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+        indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+        indexingFeatures.descriptorBindingVariableDescriptorCount = VK_TRUE;
+        indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    }
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = enableBindless ? &indexingFeatures : nullptr;
 
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
     createInfo.pEnabledFeatures = &deviceFeatures;
 
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     if (enableValidationLayers) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(deviceLayers.size());
@@ -381,6 +520,9 @@ void createSwapChain() {
     createInfo.imageExtent = extent;
     createInfo.imageArrayLayers = 1;
     createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // frameCapture가 present 전에 복사해 갈 수 있도록
+    if (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+        createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
     QueueFamilyIndices indices;
 
@@ -437,6 +579,12 @@ void createSwapChain() {
     swapChainExtent = extent;
 }
 
+void createHeadlessTarget() {
+    // swapchain 대신 screenImage가 resolve 대상. 이미지는 createScreenResources가 같은 형식 / 크기로 만든다
+    swapChainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+    swapChainExtent = headlessExtent;
+}
+
 void createImageViews() {
     swapChainImageViews.resize(swapChainImages.size());
 
@@ -509,7 +657,8 @@ void createRenderPass() {
     colorAttachmentResolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachmentResolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    // headless는 present 대신 screenImage를 읽어 간다
+    colorAttachmentResolve.finalLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
@@ -533,11 +682,23 @@ void createRenderPass() {
     VkSubpassDependency dependency{};
     dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
     dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.srcAccessMask = 0;
+    // 프레임이 겹치므로 이전 프레임의 깊이 쓰기와 headless 복사 읽기 이후에 시작
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
     dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
     dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
+    // headless: 그린 screenImage를 다음 복사가 읽을 수 있게
+    VkSubpassDependency readbackDependency{};
+    readbackDependency.srcSubpass = 0;
+    readbackDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+    readbackDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    readbackDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    readbackDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    readbackDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    std::array<VkSubpassDependency, 2> dependencies = { dependency, readbackDependency };
+
     std::array<VkAttachmentDescription, 3> attachments = {colorAttachment, depthAttachment, colorAttachmentResolve };
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -545,8 +706,8 @@ void createRenderPass() {
     renderPassInfo.pAttachments = attachments.data();
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
+    renderPassInfo.dependencyCount = headless ? 2 : 1;
+    renderPassInfo.pDependencies = dependencies.data();
 
     if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
         throw std::runtime_error("failed to create render pass!");
@@ -554,6 +715,12 @@ void createRenderPass() {
 }
 
 void GameObject::createDescriptorSetLayout() {
+    // bindless : 전역 셋 레이아웃을 공유
+    if (enableBindless) {
+        this->descriptorSetLayout = bindlessSetLayout;
+        return;
+    }
+
     VkDescriptorSetLayoutBinding uboLayoutBinding{};
     uboLayoutBinding.binding = 0;
     uboLayoutBinding.descriptorCount = 1;
@@ -561,20 +728,6 @@ void GameObject::createDescriptorSetLayout() {
     uboLayoutBinding.pImmutableSamplers = nullptr;
     uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
-    VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-    samplerLayoutBinding.binding = 1;
-    samplerLayoutBinding.descriptorCount = 1;
-    samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    samplerLayoutBinding.pImmutableSamplers = nullptr;
-    samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-    VkDescriptorSetLayoutBinding alphaLayoutBinding{};
-    alphaLayoutBinding.binding = 2;
-    alphaLayoutBinding.descriptorCount = 1;
-    alphaLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    alphaLayoutBinding.pImmutableSamplers = nullptr;
-    alphaLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
     VkDescriptorSetLayoutBinding texelBufferBinding{};
     texelBufferBinding.binding = 3;
     texelBufferBinding.descriptorCount = 1;
@@ -589,9 +742,8 @@ void GameObject::createDescriptorSetLayout() {
     texelVertexBufferBinding.pImmutableSamplers = nullptr;
     texelVertexBufferBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
-    std::array<VkDescriptorSetLayoutBinding, 5> bindings = {    uboLayoutBinding, 
-                                                                samplerLayoutBinding, 
-                                                                alphaLayoutBinding, 
+    // set 0 : 모델 / 스왑체인 이미지마다 다른 버퍼
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings = {    uboLayoutBinding, 
                                                                 texelBufferBinding, 
                                                                 texelVertexBufferBinding 
                                                             };
@@ -605,6 +757,35 @@ void GameObject::createDescriptorSetLayout() {
     }
 }
 
+void createMaterialSetLayout() {
+    VkDescriptorSetLayoutBinding samplerLayoutBinding{};
+    samplerLayoutBinding.binding = 1;
+    samplerLayoutBinding.descriptorCount = 1;
+    samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    samplerLayoutBinding.pImmutableSamplers = nullptr;
+    samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutBinding alphaLayoutBinding{};
+    alphaLayoutBinding.binding = 2;
+    alphaLayoutBinding.descriptorCount = 1;
+    alphaLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    alphaLayoutBinding.pImmutableSamplers = nullptr;
+    alphaLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // set 1 : 재질 텍스처 (캐시 대상)
+    std::array<VkDescriptorSetLayoutBinding, 2> materialBindings = {    samplerLayoutBinding, 
+                                                                        alphaLayoutBinding 
+                                                                    };
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(materialBindings.size());
+    layoutInfo.pBindings = materialBindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &materialSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+}
+
 void GameObject::createComputePipeline() {
     std::vector<char> compShaderCode = readFile("spv/Compute/exam.spv");
     VkShaderModule compShaderModule = createShaderModule(compShaderCode);
@@ -632,7 +813,10 @@ void GameObject::createComputePipeline() {
     pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
     pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
 
-    if ( vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &this->computePipelineLayout) != VK_SUCCESS ) {
+    if (enableBindless) {
+        this->computePipelineLayout = bindlessComputePipelineLayout;
+    }
+    else if ( vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &this->computePipelineLayout) != VK_SUCCESS ) {
         throw std::runtime_error("pipelineLayout 생성 실패");
     }
 
@@ -687,21 +871,33 @@ void GameObject::createGraphicsPipeline() {
     pushConstantRange.size = sizeof(GraphicsConstantLayouts);
 
     // create PipelineLayout
+    // set 0 : UBO / texel buffer, set 1 : 재질 텍스처
+    std::array<VkDescriptorSetLayout, 2> setLayouts = { this->descriptorSetLayout, materialSetLayout };
+
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &this->descriptorSetLayout;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &this->pipelineLayout) != VK_SUCCESS) {
+    if (enableBindless) {
+        this->pipelineLayout = bindlessPipelineLayout;
+    }
+    else if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &this->pipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
     }
 
     // Init each Graphics Pipelines.
     for (Models* m : models) {
-        vertShaderCode = readFile(m->_initParam.vertPath);
-        fragShaderCode = readFile(m->_initParam.fragPath);
+        if (enableBindless) {
+            vertShaderCode = readFile(getBindlessShaderPath(m->_initParam.vertPath));
+            fragShaderCode = readFile(getBindlessShaderPath(m->_initParam.fragPath));
+        }
+        else {
+            vertShaderCode = readFile(m->_initParam.vertPath);
+            fragShaderCode = readFile(m->_initParam.fragPath);
+        }
 
         vertShaderModule = createShaderModule(vertShaderCode);
         fragShaderModule = createShaderModule(fragShaderCode);
@@ -823,10 +1019,10 @@ void createFramebuffers() {
         }
     }
 
-    // screenImageView를 destination으로 하는 프레임 버퍼
-    screenFramebuffers.resize(swapChainImageViews.size());
+    // screenImageView를 destination으로 하는 프레임 버퍼 (headless는 이것 하나로 그린다)
+    screenFramebuffers.resize(headless ? 1 : swapChainImageViews.size());
 
-    for (size_t i = 0; i < swapChainImageViews.size(); i++) {
+    for (size_t i = 0; i < screenFramebuffers.size(); i++) {
         std::array<VkImageView, 3> attachments = {
             colorImageView,
             depthImageView,
@@ -865,7 +1061,10 @@ void createCommandPool() {
         if (prop.queueFlags & VK_QUEUE_GRAPHICS_BIT ) {
             queueFamilyIndices.graphicsFamily = i;
         }
-        vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &isSurpportedSurface);
+        if (headless)
+            isSurpportedSurface = (prop.queueFlags & VK_QUEUE_GRAPHICS_BIT) ? VK_TRUE : VK_FALSE;
+        else
+            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &isSurpportedSurface);
         if (isSurpportedSurface) {
             queueFamilyIndices.presentFamily = i;
         }
@@ -883,6 +1082,9 @@ void createCommandPool() {
     if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics command pool!");
     }
+
+    // timestamp는 이 큐 패밀리의 커맨드 버퍼에 기록된다
+    gpuProfiler.init(queueFamilyIndices.graphicsFamily.value());
 }
 
 void createColorResources() {
@@ -1117,7 +1319,8 @@ void createDepthResources() {
     }
 }
 
-void GameObject::createTextureImage() {
+// 파일 하나를 읽어 밉맵까지 만든 이미지를 texture에 채운다
+static void createTextureFromFile(const std::string& path, SharedTexture& texture) {
     int texWidth, texHeight, texChannels;
     stbi_uc* pixels;
     VkDeviceSize imageSize;
@@ -1132,255 +1335,207 @@ void GameObject::createTextureImage() {
     VkPhysicalDeviceMemoryProperties memProp;
     vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProp);
 
-    for (Models* m : models) {
-        pixels = stbi_load(m->texturePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        imageSize = texWidth * texHeight * 4;
-        mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+    pixels = stbi_load(path.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    imageSize = texWidth * texHeight * 4;
+    mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+    texture.mipLevels = mipLevels;
 
-        if (!pixels) {
-            throw std::runtime_error("failed to load texture image!");
-        }
+    if (!pixels) {
+        throw std::runtime_error("failed to load texture image!");
+    }
 
-        createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+    createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 
-        vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-            memcpy(data, pixels, static_cast<size_t>(imageSize));
-        vkUnmapMemory(device, stagingBufferMemory);
+    vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
+        memcpy(data, pixels, static_cast<size_t>(imageSize));
+    vkUnmapMemory(device, stagingBufferMemory);
 
-        stbi_image_free(pixels);
+    stbi_image_free(pixels);
 
-        imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-        imageCreateInfo.pNext = nullptr;
-        imageCreateInfo.flags = 0;
-        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-        imageCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-        imageCreateInfo.extent = {static_cast<unsigned int>(texWidth), static_cast<unsigned int>(texHeight), 1};
-        imageCreateInfo.mipLevels = mipLevels;
-        imageCreateInfo.arrayLayers = 1;
-        imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-        imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-        imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-        imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCreateInfo.pNext = nullptr;
+    imageCreateInfo.flags = 0;
+    imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+    imageCreateInfo.extent = {static_cast<unsigned int>(texWidth), static_cast<unsigned int>(texHeight), 1};
+    imageCreateInfo.mipLevels = mipLevels;
+    imageCreateInfo.arrayLayers = 1;
+    imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-        if (vkCreateImage(device, &imageCreateInfo, nullptr, &m->textureImage) != VK_SUCCESS) {
-            throw std::runtime_error("textureImage 생성 실패");
-        }
+    if (vkCreateImage(device, &imageCreateInfo, nullptr, &texture.image) != VK_SUCCESS) {
+        throw std::runtime_error("textureImage 생성 실패");
+    }
 
-        VkMemoryRequirements memRequir;
-        vkGetImageMemoryRequirements(device, m->textureImage, &memRequir);
+    VkMemoryRequirements memRequir;
+    vkGetImageMemoryRequirements(device, texture.image, &memRequir);
 
-        int memTypeIdx = -1;
-        for (int i = 0; i< memProp.memoryTypeCount; i++) {
-            if (memRequir.memoryTypeBits & (1 << i) && memProp.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT == VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
-                memTypeIdx = i;
-                break;
-            }
-        }
-        if (memTypeIdx == -1) {
-            throw std::runtime_error("textureImageMemory에서 요구하는 유형의 메모리를 찾을 수 없음.");
+    int memTypeIdx = -1;
+    for (int i = 0; i< memProp.memoryTypeCount; i++) {
+        if (memRequir.memoryTypeBits & (1 << i) && memProp.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT == VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
+            memTypeIdx = i;
+            break;
         }
+    }
+    if (memTypeIdx == -1) {
+        throw std::runtime_error("textureImageMemory에서 요구하는 유형의 메모리를 찾을 수 없음.");
+    }
 
-        VkMemoryAllocateInfo memAlloc;
-        memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        memAlloc.pNext = nullptr;
-        memAlloc.memoryTypeIndex = memTypeIdx;
-        memAlloc.allocationSize = memRequir.size;
+    VkMemoryAllocateInfo memAlloc;
+    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memAlloc.pNext = nullptr;
+    memAlloc.memoryTypeIndex = memTypeIdx;
+    memAlloc.allocationSize = memRequir.size;
 
-        if (vkAllocateMemory(device, &memAlloc, nullptr, &m->textureImageMemory) != VK_SUCCESS) {
-            throw std::runtime_error("textureImageMemory 할당 실패");
-        }
+    if (vkAllocateMemory(device, &memAlloc, nullptr, &texture.memory) != VK_SUCCESS) {
+        throw std::runtime_error("textureImageMemory 할당 실패");
+    }
 
-        // Image, ImageMermory Binding..
-        vkBindImageMemory(device, m->textureImage, m->textureImageMemory, 0);
+    // Image, ImageMermory Binding..
+    vkBindImageMemory(device, texture.image, texture.memory, 0);
 
-        // Recording..
-        VkCommandBuffer recordBuffer;
+    // Recording..
+    VkCommandBuffer recordBuffer;
 
-        VkCommandBufferAllocateInfo cmdbufAllocInfo;
-        cmdbufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        cmdbufAllocInfo.pNext = nullptr;
-        cmdbufAllocInfo.commandPool = commandPool;
-        cmdbufAllocInfo.commandBufferCount = 1;
-        cmdbufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    VkCommandBufferAllocateInfo cmdbufAllocInfo;
+    cmdbufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdbufAllocInfo.pNext = nullptr;
+    cmdbufAllocInfo.commandPool = commandPool;
+    cmdbufAllocInfo.commandBufferCount = 1;
+    cmdbufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 
-        vkAllocateCommandBuffers(device, &cmdbufAllocInfo, &recordBuffer);
+    vkAllocateCommandBuffers(device, &cmdbufAllocInfo, &recordBuffer);
 
-        VkCommandBufferBeginInfo cmdbufBeginInfo{};
-        cmdbufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        cmdbufBeginInfo.pNext = nullptr;
-        cmdbufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VkCommandBufferBeginInfo cmdbufBeginInfo{};
+    cmdbufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdbufBeginInfo.pNext = nullptr;
+    cmdbufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-        vkBeginCommandBuffer(recordBuffer, &cmdbufBeginInfo);
+    vkBeginCommandBuffer(recordBuffer, &cmdbufBeginInfo);
 
-        VkImageMemoryBarrier imageMemoryBarrier{};
-        imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        imageMemoryBarrier.image = m->textureImage;
-        imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imageMemoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
-        imageMemoryBarrier.subresourceRange.baseMipLevel = 0;
-        imageMemoryBarrier.subresourceRange.layerCount = 1;
-        // 모든 밉맵에 레이아웃을 적용하기 위해 dimension을 주입. 
-        imageMemoryBarrier.subresourceRange.levelCount = mipLevels;
+    VkImageMemoryBarrier imageMemoryBarrier{};
+    imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageMemoryBarrier.image = texture.image;
+    imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
+    imageMemoryBarrier.subresourceRange.baseMipLevel = 0;
+    imageMemoryBarrier.subresourceRange.layerCount = 1;
+    // 모든 밉맵에 레이아웃을 적용하기 위해 dimension을 주입. 
+    imageMemoryBarrier.subresourceRange.levelCount = mipLevels;
 
-        vkCmdPipelineBarrier(   recordBuffer, 
-                                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 
-                                VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                0,
-                                0, nullptr,
-                                0, nullptr,
-                                1, &imageMemoryBarrier);
+    vkCmdPipelineBarrier(   recordBuffer, 
+                            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 
+                            VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            0,
+                            0, nullptr,
+                            0, nullptr,
+                            1, &imageMemoryBarrier);
 
-        vkEndCommandBuffer(recordBuffer);
+    vkEndCommandBuffer(recordBuffer);
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.pNext = nullptr;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &recordBuffer;
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = nullptr;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &recordBuffer;
 
-        vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(graphicsQueue);
+    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(graphicsQueue);
 
-        vkFreeCommandBuffers(device, commandPool, 1, &recordBuffer);
+    vkFreeCommandBuffers(device, commandPool, 1, &recordBuffer);
 
-        cmdbufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        cmdbufAllocInfo.pNext = nullptr;
-        cmdbufAllocInfo.commandPool = commandPool;
-        cmdbufAllocInfo.commandBufferCount = 1;
-        cmdbufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdbufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdbufAllocInfo.pNext = nullptr;
+    cmdbufAllocInfo.commandPool = commandPool;
+    cmdbufAllocInfo.commandBufferCount = 1;
+    cmdbufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 
-        vkAllocateCommandBuffers(device, &cmdbufAllocInfo, &recordBuffer);
+    vkAllocateCommandBuffers(device, &cmdbufAllocInfo, &recordBuffer);
 
-        cmdbufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        cmdbufBeginInfo.pNext = nullptr;
-        cmdbufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    cmdbufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdbufBeginInfo.pNext = nullptr;
+    cmdbufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-        vkBeginCommandBuffer(recordBuffer, &cmdbufBeginInfo);
+    vkBeginCommandBuffer(recordBuffer, &cmdbufBeginInfo);
 
-        VkBufferImageCopy bufImgCopy;
-        bufImgCopy.bufferOffset = 0;
-        bufImgCopy.bufferRowLength = 0;
-        bufImgCopy.bufferImageHeight = 0;
-        bufImgCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        bufImgCopy.imageSubresource.mipLevel = 0;
-        bufImgCopy.imageSubresource.baseArrayLayer = 0;
-        bufImgCopy.imageSubresource.layerCount = 1;
-        bufImgCopy.imageOffset = {0, 0, 0};
-        bufImgCopy.imageExtent = {  static_cast<unsigned int>(texWidth),
-                                    static_cast<unsigned int>(texHeight),
-                                    1};
+    VkBufferImageCopy bufImgCopy;
+    bufImgCopy.bufferOffset = 0;
+    bufImgCopy.bufferRowLength = 0;
+    bufImgCopy.bufferImageHeight = 0;
+    bufImgCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    bufImgCopy.imageSubresource.mipLevel = 0;
+    bufImgCopy.imageSubresource.baseArrayLayer = 0;
+    bufImgCopy.imageSubresource.layerCount = 1;
+    bufImgCopy.imageOffset = {0, 0, 0};
+    bufImgCopy.imageExtent = {  static_cast<unsigned int>(texWidth),
+                                static_cast<unsigned int>(texHeight),
+                                1};
 
-        vkCmdCopyBufferToImage(recordBuffer, stagingBuffer, m->textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufImgCopy);
-        vkEndCommandBuffer(recordBuffer);
+    vkCmdCopyBufferToImage(recordBuffer, stagingBuffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufImgCopy);
+    vkEndCommandBuffer(recordBuffer);
 
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &recordBuffer;
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &recordBuffer;
 
-        vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(graphicsQueue);
+    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(graphicsQueue);
 
-        vkFreeCommandBuffers(device, commandPool, 1, &recordBuffer);
+    vkFreeCommandBuffers(device, commandPool, 1, &recordBuffer);
 
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    vkFreeMemory(device, stagingBufferMemory, nullptr);
 
-        generateMipmaps(m->textureImage, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, mipLevels);
+    generateMipmaps(texture.image, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, mipLevels);
+}
 
-        // define alpha 
-        if (!m->alphaPath.empty()) {
-            pixels = stbi_load(m->alphaPath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+SharedTexture& acquireTexture(const std::string& path) {
+    auto it = textureCache.find(path);
+    if (it != textureCache.end()) {
+        it->second.refCount++;
+        return it->second;
+    }
 
-            if (!pixels) {
-                throw std::runtime_error("failed to load alpha texture image!");
-            }
-
-            // create Staging, StagingBuffer
-            createBuffer(   imageSize, 
-                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-                            stagingBuffer, 
-                            stagingBufferMemory);
-
-            vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-                memcpy(data, pixels, static_cast<size_t>(imageSize));
-            vkUnmapMemory(device, stagingBufferMemory);
-
-            stbi_image_free(pixels);
-
-            if (vkCreateImage(device, &imageCreateInfo, nullptr, &m->alphaTextureImage) != VK_SUCCESS) {
-                throw std::runtime_error("textureImage 생성 실패");
-            }
-
-            vkGetImageMemoryRequirements(device, m->alphaTextureImage, &memRequir);
-
-            memTypeIdx = -1;
-            for (int i = 0; i< memProp.memoryTypeCount; i++) {
-                if (memRequir.memoryTypeBits & (1 << i) && memProp.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT == VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
-                    memTypeIdx = i;
-                    break;
-                }
-            }
-            if (memTypeIdx == -1) {
-                throw std::runtime_error("alphaTextureImageMemory에서 요구하는 유형의 메모리를 찾을 수 없음.");
-            }
-
-            memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            memAlloc.pNext = nullptr;
-            memAlloc.memoryTypeIndex = memTypeIdx;
-            memAlloc.allocationSize = memRequir.size;
-
-            if (vkAllocateMemory(device, &memAlloc, nullptr, &m->alphaTextureImageMemory) != VK_SUCCESS) {
-                throw std::runtime_error("textureImageMemory 할당 실패");
-            }
-
-            // Image, ImageMermory Binding..
-            vkBindImageMemory(device, m->alphaTextureImage, m->alphaTextureImageMemory, 0);
-            
-            // Recording..
-            vkAllocateCommandBuffers(device, &cmdbufAllocInfo, &recordBuffer);
-            vkBeginCommandBuffer(recordBuffer, &cmdbufBeginInfo);
+    // 읽기에 실패하면 캐시에 빈 항목이 남지 않도록 다 만든 뒤 넣는다
+    SharedTexture texture;
+    createTextureFromFile(path, texture);
+    texture.refCount = 1;
 
-            imageMemoryBarrier.image = m->alphaTextureImage;
-
-            vkCmdPipelineBarrier(   recordBuffer, 
-                                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 
-                                    VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                    0,
-                                    0, nullptr,
-                                    0, nullptr,
-                                    1, &imageMemoryBarrier);
-
-
-            vkEndCommandBuffer(recordBuffer);
-
-            vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-            vkQueueWaitIdle(graphicsQueue);
-
-            vkFreeCommandBuffers(device, commandPool, 1, &recordBuffer);
-
-            vkAllocateCommandBuffers(device, &cmdbufAllocInfo, &recordBuffer);
-
-            vkBeginCommandBuffer(recordBuffer, &cmdbufBeginInfo);
-
-            vkCmdCopyBufferToImage(recordBuffer, stagingBuffer, m->alphaTextureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufImgCopy);
+    return textureCache.emplace(path, texture).first->second;
+}
 
-            vkEndCommandBuffer(recordBuffer);
+void releaseTexture(const std::string& path) {
+    auto it = textureCache.find(path);
+    if (it == textureCache.end() || --it->second.refCount > 0)
+        return;
 
-            vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-            vkQueueWaitIdle(graphicsQueue);
+    SharedTexture& texture = it->second;
+    if (texture.view != VK_NULL_HANDLE)
+        vkDestroyImageView(device, texture.view, nullptr);
+    vkDestroyImage(device, texture.image, nullptr);
+    vkFreeMemory(device, texture.memory, nullptr);
 
-            vkFreeCommandBuffers(device, commandPool, 1, &recordBuffer);
+    textureCache.erase(it);
+}
 
-            vkDestroyBuffer(device, stagingBuffer, nullptr);
-            vkFreeMemory(device, stagingBufferMemory, nullptr);
+void GameObject::createTextureImage() {
+    for (Models* m : models) {
+        SharedTexture& texture = acquireTexture(m->texturePath);
+        m->textureImage = texture.image;
+        m->textureImageMemory = texture.memory;
 
-            generateMipmaps(m->alphaTextureImage, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, mipLevels);
+        // define alpha 
+        if (!m->alphaPath.empty()) {
+            SharedTexture& alpha = acquireTexture(m->alphaPath);
+            m->alphaTextureImage = alpha.image;
+            m->alphaTextureImageMemory = alpha.memory;
         }
     }
 }
@@ -1526,230 +1681,294 @@ void createTextureSampler() {
     }
 }
 
-void GameObject::createTextureImageView() {
+// 뷰도 경로별로 하나. 이미 다른 모델이 만든 뷰가 있으면 그대로 쓴다.
+static VkImageView getTextureView(const std::string& path) {
+    SharedTexture& texture = textureCache.at(path);
+    if (texture.view != VK_NULL_HANDLE)
+        return texture.view;
+
     VkImageViewCreateInfo createInfo;
+    createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    createInfo.pNext = nullptr;
+    createInfo.flags = 0;
+    createInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+    createInfo.image = texture.image;
+    createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    createInfo.components = {   VK_COMPONENT_SWIZZLE_R,
+                                VK_COMPONENT_SWIZZLE_G,
+                                VK_COMPONENT_SWIZZLE_B,
+                                VK_COMPONENT_SWIZZLE_A };
+    createInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT,
+                                    0,
+                                    texture.mipLevels,
+                                    0,
+                                    1};
 
-    for (Models* m : models) {
-        createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        createInfo.pNext = nullptr;
-        createInfo.flags = 0;
-        createInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-        createInfo.image = m->textureImage;
-        createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        createInfo.components = {   VK_COMPONENT_SWIZZLE_R,
-                                    VK_COMPONENT_SWIZZLE_G,
-                                    VK_COMPONENT_SWIZZLE_B,
-                                    VK_COMPONENT_SWIZZLE_A };
-        createInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT,
-                                        0,
-                                        mipLevels,
-                                        0,
-                                        1};
+    if (vkCreateImageView(device, &createInfo, nullptr, &texture.view) != VK_SUCCESS) {
+        throw std::runtime_error("textureImageView 생성 실패");
+    }
 
-        if (vkCreateImageView(device, &createInfo, nullptr, &m->textureImageView) != VK_SUCCESS) {
-            throw std::runtime_error("textureImageView 생성 실패");
-        }
+    return texture.view;
+}
 
-        // create alpha textureImageView
-        if (!m->alphaPath.empty()) {
-            createInfo.image = m->alphaTextureImage;
+void GameObject::createTextureImageView() {
+    for (Models* m : models) {
+        m->textureImageView = getTextureView(m->texturePath);
 
-            if (vkCreateImageView(device, &createInfo, nullptr, &m->alphaTextureImageView) != VK_SUCCESS) {
-                throw std::runtime_error("alphaTextureImageView 생성 실패");
-            }
-        }
+        // create alpha textureImageView
+        if (!m->alphaPath.empty())
+            m->alphaTextureImageView = getTextureView(m->alphaPath);
     }
 }
 
-void GameObject::loadModel() {
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
-
-    for (Models* m : models) {
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, m->objectPath.c_str())) {
-            throw std::runtime_error(warn + err);
+// 삼각형마다 면 법선(면적 가중)과 꼭짓점 각을 구한 뒤,
+// 각 꼭짓점에서 creaseAngle 이내의 인접 면 법선을 (각 x 면적) 가중으로 더한다.
+// positionIndices : 삼각형 꼭짓점(corner)별 위치 인덱스, cornerNormals : 결과
+void computeSmoothNormals(  const std::vector<glm::vec3>& positions,
+                            const std::vector<uint32_t>& positionIndices,
+                            float creaseAngle,
+                            std::vector<glm::vec3>& cornerNormals) {
+    size_t cornerCount = positionIndices.size();
+    size_t triangleCount = cornerCount / 3;
+
+    std::vector<glm::vec4> faceWeighted(triangleCount);
+    std::vector<glm::vec3> faceNormals(triangleCount);
+    std::vector<float> cornerAngles(cornerCount);
+
+    parallelFor(triangleCount, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            const glm::vec3& p0 = positions[positionIndices[3 * t]];
+            const glm::vec3& p1 = positions[positionIndices[3 * t + 1]];
+            const glm::vec3& p2 = positions[positionIndices[3 * t + 2]];
+
+            // 길이 = 면적 x 2
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float len = glm::length(n);
+
+            faceWeighted[t] = glm::vec4(n, 0.0f);
+            faceNormals[t] = len > 1e-20f ? n / len : glm::vec3(0.0f);
+
+            const glm::vec3* p[3] = { &p0, &p1, &p2 };
+            for (int k = 0; k < 3; k++) {
+                glm::vec3 a = *p[(k + 1) % 3] - *p[k];
+                glm::vec3 b = *p[(k + 2) % 3] - *p[k];
+                float la = glm::length(a), lb = glm::length(b);
+
+                cornerAngles[3 * t + k] = (la > 0.0f && lb > 0.0f) ? acosf(glm::clamp(glm::dot(a, b) / (la * lb), -1.0f, 1.0f)) : 0.0f;
+            }
         }
+    });
 
-        std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+    // 위치 -> 그 위치를 쓰는 corner 목록 (CSR)
+    std::vector<uint32_t> adjOffset(positions.size() + 1, 0);
+    for (uint32_t p : positionIndices)
+        adjOffset[p + 1]++;
+    for (size_t i = 0; i < positions.size(); i++)
+        adjOffset[i + 1] += adjOffset[i];
 
-        uint32_t size(0);
-        glm::vec3 AB(0.0f); 
-        glm::vec3 AC(0.0f);  
-        glm::vec3 Normal(0.0f);
-
-        for (const auto& shape : shapes) {
-            int i = 0; 
-            for (const auto& index : shape.mesh.indices) {
-                Vertex vertex{};
-                vertex.pos = {
-                    attrib.vertices[3 * index.vertex_index],
-                    attrib.vertices[3 * index.vertex_index + 1],
-                    attrib.vertices[3 * index.vertex_index + 2]
-                };
+    std::vector<uint32_t> adjCorners(cornerCount);
+    std::vector<uint32_t> fill(adjOffset.begin(), adjOffset.end() - 1);
+    for (size_t c = 0; c < cornerCount; c++)
+        adjCorners[fill[positionIndices[c]]++] = static_cast<uint32_t>(c);
 
-                vertex.texCoord = {
-                    attrib.texcoords[2 * index.texcoord_index],
-                    1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-                };
+    float cosCrease = cosf(glm::radians(creaseAngle));
 
-                if (uniqueVertices.count(vertex) == 0) {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(m->vertices.size());
-                    m->vertices.push_back(vertex);
-                }
+    cornerNormals.resize(cornerCount);
 
-                m->indices.push_back(uniqueVertices[vertex]);
+    parallelFor(triangleCount, [&](size_t begin, size_t end) {
+        for (size_t c = 3 * begin; c < 3 * end; c++) {
+            size_t t = c / 3;
+            const glm::vec3& own = faceNormals[t];
+            uint32_t p = positionIndices[c];
 
-                ++i;
+#ifdef USE_SSE
+            __m128 sum = _mm_setzero_ps();
+            for (uint32_t i = adjOffset[p]; i < adjOffset[p + 1]; i++) {
+                uint32_t a = adjCorners[i];
+                uint32_t f = a / 3;
 
-                // New Half
-                if (!(i % 3)) {
-                    size = m->vertices.size();
+                if (glm::dot(own, faceNormals[f]) < cosCrease)
+                    continue;
 
-                    // AB_Vec
-                    AB = m->vertices[size - 2].pos - m->vertices[size - 3].pos; 
-                    // AC_Vec
-                    AC = m->vertices[size - 1].pos - m->vertices[size - 3].pos;  
+                __m128 n = _mm_loadu_ps(&faceWeighted[f].x);
+                sum = _mm_add_ps(sum, _mm_mul_ps(n, _mm_set1_ps(cornerAngles[a])));
+            }
 
-                    Normal = glm::cross(AB, AC);
+            alignas(16) float res[4];
+            _mm_store_ps(res, sum);
+            glm::vec3 normal(res[0], res[1], res[2]);
+#else
+            glm::vec3 normal(0.0f);
+            for (uint32_t i = adjOffset[p]; i < adjOffset[p + 1]; i++) {
+                uint32_t a = adjCorners[i];
+                uint32_t f = a / 3;
 
-                    m->vertices[size - 1].normal = Normal;
-                    m->vertices[size - 2].normal = Normal;
-                    m->vertices[size - 3].normal = Normal;
-                }
+                if (glm::dot(own, faceNormals[f]) < cosCrease)
+                    continue;
+
+                normal += glm::vec3(faceWeighted[f]) * cornerAngles[a];
             }
+#endif
+            float len = glm::length(normal);
+            cornerNormals[c] = len > 1e-20f ? normal / len : own;
         }
-    }
+    });
 }
 
-void GameObject::createVertexBuffer() {
-    VkDeviceSize bufferSize;
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-
-    void* data;
-
-    VkCommandBuffer commandBuffer;
-    VkCommandBufferAllocateInfo cmdbufAllocInfo{};
-
-    for (Models* m : models) {
-        bufferSize = sizeof(m->vertices[0]) * m->vertices.size();
-
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-            memcpy(data, m->vertices.data(), (size_t) bufferSize);
-        vkUnmapMemory(device, stagingBufferMemory);
+// UV 기준 tangent. 공유 정점은 누적 후 법선에 대해 Gram-Schmidt 직교화.
+void computeTangents(Models* m) {
+    std::vector<glm::vec3> tan(m->vertices.size(), glm::vec3(0.0f));
+    std::vector<glm::vec3> bitan(m->vertices.size(), glm::vec3(0.0f));
 
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m->vertexBuffer, m->vertexBufferMemory);
+    for (size_t i = 0; i + 2 < m->indices.size(); i += 3) {
+        uint32_t i0 = m->indices[i], i1 = m->indices[i + 1], i2 = m->indices[i + 2];
+        const Vertex& v0 = m->vertices[i0];
+        const Vertex& v1 = m->vertices[i1];
+        const Vertex& v2 = m->vertices[i2];
 
-        cmdbufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        cmdbufAllocInfo.pNext = nullptr;
-        cmdbufAllocInfo.commandPool = commandPool;
-        cmdbufAllocInfo.commandBufferCount = 1;
-        cmdbufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        glm::vec3 dp1 = v1.pos - v0.pos;
+        glm::vec3 dp2 = v2.pos - v0.pos;
+        glm::vec2 duv1 = v1.texCoord - v0.texCoord;
+        glm::vec2 duv2 = v2.texCoord - v0.texCoord;
 
-        vkAllocateCommandBuffers(device, &cmdbufAllocInfo, &commandBuffer);
-
-        VkCommandBufferBeginInfo cmdbufBeginInfo{};
-        cmdbufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        cmdbufBeginInfo.pNext = nullptr;
-        cmdbufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        float r = duv1.x * duv2.y - duv1.y * duv2.x;
+        if (fabsf(r) < 1e-12f)
+            continue;
+        r = 1.0f / r;
 
-        vkBeginCommandBuffer(commandBuffer, &cmdbufBeginInfo);
+        glm::vec3 t = (dp1 * duv2.y - dp2 * duv1.y) * r;
+        glm::vec3 b = (dp2 * duv1.x - dp1 * duv2.x) * r;
 
-        VkBufferCopy copyRegion{};
-        copyRegion.size = bufferSize;
-        vkCmdCopyBuffer(commandBuffer, stagingBuffer, m->vertexBuffer, 1, &copyRegion);
+        tan[i0] += t; tan[i1] += t; tan[i2] += t;
+        bitan[i0] += b; bitan[i1] += b; bitan[i2] += b;
+    }
 
-        vkEndCommandBuffer(commandBuffer);
+    m->tangents.resize(m->vertices.size());
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.pNext = nullptr;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
-        
-        vkQueueSubmit(graphicsQueue, 1, &submitInfo, nullptr);
-        vkQueueWaitIdle(graphicsQueue);
+    parallelFor(m->vertices.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const glm::vec3& n = m->vertices[i].normal;
+            glm::vec3 t = tan[i] - n * glm::dot(n, tan[i]);
+            float len = glm::length(t);
 
-        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+            // UV가 퇴화된 정점은 법선에 수직인 임의의 축
+            if (len < 1e-12f) {
+                t = glm::cross(n, fabsf(n.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+                len = glm::length(t);
+            }
+            t /= len;
 
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
-    }
+            float w = glm::dot(glm::cross(n, t), bitan[i]) < 0.0f ? -1.0f : 1.0f;
+            m->tangents[i] = glm::vec4(t, w);
+        }
+    });
 }
 
-void GameObject::createIndexBuffer() {
+void GameObject::loadModel() {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+
     for (Models* m : models) {
-        VkDeviceSize bufferSize = sizeof(m->indices[0]) * m->indices.size();
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, m->objectPath.c_str())) {
+            throw std::runtime_error(warn + err);
+        }
 
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+        // 삼각형 corner 목록 (LoadObj는 기본으로 삼각형 분할)
+        std::vector<tinyobj::index_t> corners;
+        for (const auto& shape : shapes)
+            corners.insert(corners.end(), shape.mesh.indices.begin(), shape.mesh.indices.end());
 
-        void* data;
-        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-            memcpy(data, m->indices.data(), (size_t) bufferSize);
-        vkUnmapMemory(device, stagingBufferMemory);
+        bool hasNormals = !attrib.normals.empty();
+        for (const auto& index : corners) {
+            if (index.normal_index < 0) {
+                hasNormals = false;
+                break;
+            }
+        }
 
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m->indexBuffer, m->indexBufferMemory);
+        // OBJ에 법선이 없으면 smooth normal 생성
+        std::vector<glm::vec3> cornerNormals;
+        if (!hasNormals) {
+            std::vector<glm::vec3> positions(attrib.vertices.size() / 3);
+            for (size_t i = 0; i < positions.size(); i++)
+                positions[i] = glm::vec3(attrib.vertices[3 * i], attrib.vertices[3 * i + 1], attrib.vertices[3 * i + 2]);
 
-        VkCommandBuffer commandBuffer;
+            std::vector<uint32_t> positionIndices(corners.size());
+            for (size_t i = 0; i < corners.size(); i++)
+                positionIndices[i] = static_cast<uint32_t>(corners[i].vertex_index);
 
-        VkCommandBufferAllocateInfo cmdbufAllocInfo{};
-        cmdbufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        cmdbufAllocInfo.pNext = nullptr;
-        cmdbufAllocInfo.commandPool = commandPool;
-        cmdbufAllocInfo.commandBufferCount = 1;
-        cmdbufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            computeSmoothNormals(positions, positionIndices, m->creaseAngle, cornerNormals);
+        }
 
-        vkAllocateCommandBuffers(device, &cmdbufAllocInfo, &commandBuffer);
+        std::unordered_map<Vertex, uint32_t> uniqueVertices{};
 
-        VkCommandBufferBeginInfo cmdbufBeginInfo{};
-        cmdbufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        cmdbufBeginInfo.pNext = nullptr;
-        cmdbufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        for (size_t c = 0; c < corners.size(); c++) {
+            const tinyobj::index_t& index = corners[c];
 
-        vkBeginCommandBuffer(commandBuffer, &cmdbufBeginInfo);
+            Vertex vertex{};
+            vertex.pos = {
+                attrib.vertices[3 * index.vertex_index],
+                attrib.vertices[3 * index.vertex_index + 1],
+                attrib.vertices[3 * index.vertex_index + 2]
+            };
 
-        VkBufferCopy copyRegion{};
-        copyRegion.size = bufferSize;
-        vkCmdCopyBuffer(commandBuffer, stagingBuffer, m->indexBuffer, 1, &copyRegion);
+            if (index.texcoord_index >= 0) {
+                vertex.texCoord = {
+                    attrib.texcoords[2 * index.texcoord_index],
+                    1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+                };
+            }
 
-        vkEndCommandBuffer(commandBuffer);
+            if (hasNormals) {
+                vertex.normal = {
+                    attrib.normals[3 * index.normal_index],
+                    attrib.normals[3 * index.normal_index + 1],
+                    attrib.normals[3 * index.normal_index + 2]
+                };
+            }
+            else {
+                vertex.normal = cornerNormals[c];
+            }
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.pNext = nullptr;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
-        
-        vkQueueSubmit(graphicsQueue, 1, &submitInfo, nullptr);
-        vkQueueWaitIdle(graphicsQueue);
+            if (uniqueVertices.count(vertex) == 0) {
+                uniqueVertices[vertex] = static_cast<uint32_t>(m->vertices.size());
+                m->vertices.push_back(vertex);
+            }
+
+            m->indices.push_back(uniqueVertices[vertex]);
+        }
 
-        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+        if (m->generateTangents)
+            computeTangents(m);
 
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
+        m->indexType = m->vertices.size() <= 65536 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
     }
 }
 
+void GameObject::createGeometryBuffer() {
+    for (Models* m : models)
+        geometryPool.upload(m);
+}
+
 void GameObject::createUniformBuffers() {
     VkDeviceSize bufferSize = sizeof(UniformBufferObject);
 
     for (Models* m : models) {
-        m->uniformBuffers.resize(swapChainImages.size());
-        m->uniformBuffersMemory.resize(swapChainImages.size());
+        m->uniformBuffers.resize(swapChainImageCount());
+        m->uniformBuffersMemory.resize(swapChainImageCount());
+        m->uniformBuffersMapped.resize(swapChainImageCount());
 
-        for (size_t i = 0; i < swapChainImages.size(); i++) {
+        for (size_t i = 0; i < swapChainImageCount(); i++) {
             createBuffer (  bufferSize, 
                             VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
                             m->uniformBuffers[i], 
                             m->uniformBuffersMemory[i]);
+
+            // 영구 매핑 : updateUniformBuffer가 프레임마다 map / unmap 하지 않도록
+            vkMapMemory(device, m->uniformBuffersMemory[i], 0, bufferSize, 0, &m->uniformBuffersMapped[i]);
         }
     }
 }
@@ -1926,120 +2145,49 @@ void GameObject::createTexelUniformBuffers() {
     }
 }
 
-void GameObject::createDescriptorPool() {
-    std::array<VkDescriptorPoolSize, 5> poolSizes{};
-    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSizes[0].descriptorCount = static_cast<uint32_t>(swapChainImages.size());
-    poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[1].descriptorCount = static_cast<uint32_t>(swapChainImages.size());
-    poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[2].descriptorCount = static_cast<uint32_t>(swapChainImages.size());
-    poolSizes[3].type = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
-    poolSizes[3].descriptorCount = static_cast<uint32_t>(swapChainImages.size());
-    poolSizes[4].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSizes[4].descriptorCount = static_cast<uint32_t>(swapChainImages.size());
+void GameObject::createDescriptorSets() 
+{
+    for (Models* m : models) {
+        // 재질 셋은 refresh 후에도 그대로 유효
+        if (m->materialSet != VK_NULL_HANDLE)
+            continue;
 
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = static_cast<uint32_t>(swapChainImages.size());
+        // alpha 텍스처가 없으면 본 텍스처를 재사용
+        VkImageView alphaImageView = m->alphaPath.empty() ? m->textureImageView : m->alphaTextureImageView;
 
-    for (Models* m : models) {
-        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &m->descriptorPool) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create descriptor pool!");
-        }
+        // 텍스처 뷰는 경로별로 공유되므로 같은 재질이면 같은 키
+        DescriptorSetKey key(materialSetLayout);
+        key.addImage(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m->textureImageView, textureSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+           .addImage(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, alphaImageView, textureSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        m->materialSet = descriptorCache.acquire(key);
     }
 }
 
-void GameObject::createDescriptorSets() 
-{
+// 이미지별 버퍼는 모델마다 달라 공유할 일이 없으므로 캐시를 거치지 않고
+// 프레임 할당기에서 잘라 쓴다. 펜스 대기 뒤 풀이 reset되므로 매 프레임 다시 기록.
+void GameObject::allocateFrameSets() {
     for (Models* m : models) {
-        std::vector<VkDescriptorSetLayout> layouts(swapChainImages.size(), this->descriptorSetLayout);
-        VkDescriptorSetAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocInfo.descriptorPool = m->descriptorPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(swapChainImages.size());
-        allocInfo.pSetLayouts = layouts.data();
-
-        m->descriptorSets.resize(swapChainImages.size());
-        if (vkAllocateDescriptorSets(device, &allocInfo, m->descriptorSets.data()) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate descriptor sets!");
-        }
-
-        for (size_t i = 0; i < swapChainImages.size(); i++) {
-            VkDescriptorBufferInfo bufferInfo{};
-            bufferInfo.buffer = m->uniformBuffers[i];
-            bufferInfo.offset = 0;
-            bufferInfo.range = sizeof(UniformBufferObject);
-
-            VkDescriptorImageInfo imageInfo{};
-            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView = m->textureImageView;
-            imageInfo.sampler = textureSampler;
-
-            VkDescriptorImageInfo alphaImageInfo{};
-            if (!m->alphaPath.empty()) {
-                alphaImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                alphaImageInfo.imageView = m->alphaTextureImageView;
-                alphaImageInfo.sampler = textureSampler;
-            }
-            else {
-                alphaImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                alphaImageInfo.imageView = m->textureImageView;
-                alphaImageInfo.sampler = textureSampler;
-            }
+        DescriptorSetKey key(this->descriptorSetLayout);
+        key.addBuffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m->uniformBuffers[currentFrame], 0, sizeof(UniformBufferObject))
+           .addTexelBuffer(3, VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, m->texelUniformBuffersView)
+           .addBuffer(4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m->texelUniformBuffer, 0, sizeof(TexelBufferObject[0]));
 
-            VkDescriptorBufferInfo texelBufferInfo{};
-            texelBufferInfo.buffer = m->texelUniformBuffer;
-            texelBufferInfo.offset = 0;
-            texelBufferInfo.range = sizeof(TexelBufferObject[0]);
-
-            std::array<VkWriteDescriptorSet, 5> descriptorWrites{};
-
-            descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[0].dstSet = m->descriptorSets[i];
-            descriptorWrites[0].dstBinding = 0;
-            descriptorWrites[0].dstArrayElement = 0;
-            descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptorWrites[0].descriptorCount = 1;
-            descriptorWrites[0].pBufferInfo = &bufferInfo;
-
-            descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[1].dstSet = m->descriptorSets[i];
-            descriptorWrites[1].dstBinding = 1;
-            descriptorWrites[1].dstArrayElement = 0;
-            descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrites[1].descriptorCount = 1;
-            descriptorWrites[1].pImageInfo = &imageInfo;
-
-            descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[2].dstSet = m->descriptorSets[i];
-            descriptorWrites[2].dstBinding = 2;
-            descriptorWrites[2].dstArrayElement = 0;
-            descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrites[2].descriptorCount = 1;
-            descriptorWrites[2].pImageInfo = &alphaImageInfo;
-
-            descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[3].dstSet = m->descriptorSets[i];
-            descriptorWrites[3].dstBinding = 3;
-            descriptorWrites[3].dstArrayElement = 0;
-            descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
-            descriptorWrites[3].descriptorCount = 1;
-            descriptorWrites[3].pBufferInfo = &texelBufferInfo;
-            descriptorWrites[3].pTexelBufferView = &m->texelUniformBuffersView;
-
-            descriptorWrites[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[4].dstSet = m->descriptorSets[i];
-            descriptorWrites[4].dstBinding = 4;
-            descriptorWrites[4].dstArrayElement = 0;
-            descriptorWrites[4].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptorWrites[4].descriptorCount = 1;
-            descriptorWrites[4].pBufferInfo = &texelBufferInfo;
-
-            vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
-        }
+        m->frameSet = allocateFrameDescriptorSet(this->descriptorSetLayout);
+        writeDescriptorSet(m->frameSet, key);
+    }
+}
+
+void GameObject::registerBindless() {
+    for (Models* m : models) {
+        m->drawIndex = acquireBindlessDraw();
+        m->textureIndex = registerBindlessTexture(m->textureImageView);
+
+        // alpha 텍스처가 없으면 기존과 같이 본 텍스처를 재사용
+        if (!m->alphaPath.empty())
+            m->alphaIndex = registerBindlessTexture(m->alphaTextureImageView);
+        else
+            m->alphaIndex = m->textureIndex;
     }
 }
 
@@ -2047,44 +2195,207 @@ void GameObject::createDescriptorSets()
 /////////////////      UI      ////////////////////
 ///////////////////////////////////////////////////
 
-void UI::createDescriptorSetLayout() {
-    VkDescriptorSetLayoutBinding uboLayoutBinding{};
-    uboLayoutBinding.binding = 0;
-    uboLayoutBinding.descriptorCount = 1;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBinding.pImmutableSamplers = nullptr;
-    uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+// 일회성 커맨드 버퍼 (atlas 업로드, readback). 끝날 때까지 기다린다
+static VkCommandBuffer beginUploadCommands() {
+    VkCommandBuffer recordBuffer;
+
+    VkCommandBufferAllocateInfo cmdbufAllocInfo{};
+    cmdbufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdbufAllocInfo.commandPool = commandPool;
+    cmdbufAllocInfo.commandBufferCount = 1;
+    cmdbufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+    vkAllocateCommandBuffers(device, &cmdbufAllocInfo, &recordBuffer);
+
+    VkCommandBufferBeginInfo cmdbufBeginInfo{};
+    cmdbufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdbufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(recordBuffer, &cmdbufBeginInfo);
+    return recordBuffer;
+}
+
+static void endUploadCommands(VkCommandBuffer recordBuffer) {
+    vkEndCommandBuffer(recordBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &recordBuffer;
+
+    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(graphicsQueue);
+
+    vkFreeCommandBuffers(device, commandPool, 1, &recordBuffer);
+}
+
+static void colorImageBarrier(   VkCommandBuffer recordBuffer, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                 VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = image;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+    vkCmdPipelineBarrier(recordBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void UIBatcher::init() {
+    createAtlas();
+    createIndexBuffer();
 
     VkDescriptorSetLayoutBinding samplerLayoutBinding{};
     samplerLayoutBinding.binding = 1;
     samplerLayoutBinding.descriptorCount = 1;
     samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    samplerLayoutBinding.pImmutableSamplers = nullptr;
     samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-
-    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, samplerLayoutBinding};
-
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = bindings.size();
-    layoutInfo.pBindings = bindings.data();
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &samplerLayoutBinding;
 
-    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &this->descriptorSetLayout) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create descriptor set layout!");
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("UI descriptor set layout 생성 실패");
     }
+
+    DescriptorSetKey key(descriptorSetLayout);
+    key.addImage(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, atlasView, atlasSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    descriptorSet = descriptorCache.acquire(key);
+
+    createGraphicsPipeline();
 }
 
-void UI::createGraphicsPipeline() {
-    auto vertShaderCode = readFile(this->_initParam.vertPath);
-    auto fragShaderCode = readFile(this->_initParam.fragPath);
+void UIBatcher::createAtlas() {
+    VkImageCreateInfo imageCreateInfo{};
+    imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+    imageCreateInfo.extent = { atlasSize, atlasSize, 1 };
+    imageCreateInfo.mipLevels = 1;
+    imageCreateInfo.arrayLayers = 1;
+    imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+    if (vkCreateImage(device, &imageCreateInfo, nullptr, &atlasImage) != VK_SUCCESS) {
+        throw std::runtime_error("UI atlas 생성 실패");
+    }
 
-    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    VkMemoryRequirements memRequir;
+    vkGetImageMemoryRequirements(device, atlasImage, &memRequir);
+
+    VkPhysicalDeviceMemoryProperties memProp;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProp);
+
+    int memTypeIdx = -1;
+    for (uint32_t i = 0; i < memProp.memoryTypeCount; i++) {
+        if ((memRequir.memoryTypeBits & (1 << i)) && (memProp.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+            memTypeIdx = i;
+            break;
+        }
+    }
+    if (memTypeIdx == -1) {
+        throw std::runtime_error("UI atlas에서 요구하는 유형의 메모리를 찾을 수 없음.");
+    }
+
+    VkMemoryAllocateInfo memAlloc{};
+    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memAlloc.memoryTypeIndex = memTypeIdx;
+    memAlloc.allocationSize = memRequir.size;
+
+    if (vkAllocateMemory(device, &memAlloc, nullptr, &atlasMemory) != VK_SUCCESS) {
+        throw std::runtime_error("UI atlas 메모리 할당 실패");
+    }
+
+    vkBindImageMemory(device, atlasImage, atlasMemory, 0);
+
+    // 빈 칸은 투명 (frag에서 discard)
+    VkCommandBuffer recordBuffer = beginUploadCommands();
+
+    colorImageBarrier(   recordBuffer, atlasImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkClearColorValue clearColor = {{ 0.0f, 0.0f, 0.0f, 0.0f }};
+    VkImageSubresourceRange range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    vkCmdClearColorImage(recordBuffer, atlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor, 1, &range);
+
+    colorImageBarrier(   recordBuffer, atlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    endUploadCommands(recordBuffer);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = atlasImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+    viewInfo.subresourceRange = range;
+
+    if (vkCreateImageView(device, &viewInfo, nullptr, &atlasView) != VK_SUCCESS) {
+        throw std::runtime_error("UI atlas view 생성 실패");
+    }
+
+    // 이웃 칸이 번지지 않도록 밉맵 없이 가장자리 고정
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &atlasSampler) != VK_SUCCESS) {
+        throw std::runtime_error("UI atlas sampler 생성 실패");
+    }
+}
+
+void UIBatcher::createIndexBuffer() {
+    std::vector<uint16_t> indices(quadsPerDraw * 6);
+    for (uint32_t q = 0; q < quadsPerDraw; q++) {
+        uint16_t v = static_cast<uint16_t>(q * 4);
+        uint16_t quad[6] = { v, uint16_t(v + 1), uint16_t(v + 2), uint16_t(v + 2), uint16_t(v + 3), v };
+        std::copy(quad, quad + 6, &indices[q * 6]);
+    }
+
+    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+    void* data;
+    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
+        memcpy(data, indices.data(), (size_t) bufferSize);
+    vkUnmapMemory(device, stagingBufferMemory);
+
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
+    copyBuffer(stagingBuffer, indexBuffer, bufferSize);
+
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    vkFreeMemory(device, stagingBufferMemory, nullptr);
+}
+
+void UIBatcher::createGraphicsPipeline() {
+    auto vertShaderCode = readFile("spv/UI/vert.spv");
+    auto fragShaderCode = readFile("spv/UI/frag.spv");
+
+    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
+    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+
+    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
     vertShaderStageInfo.module = vertShaderModule;
     vertShaderStageInfo.pName = "main";
 
@@ -2096,12 +2407,22 @@ void UI::createGraphicsPipeline() {
 
     VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    // UI.vert의 vec3 inPosition에 vec2를 넣으면 z = 0으로 채워진다
+    VkVertexInputBindingDescription bindingDescription{};
+    bindingDescription.binding = 0;
+    bindingDescription.stride = sizeof(UIVertex);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+    std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
+    attributeDescriptions[0].location = 0;
+    attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+    attributeDescriptions[0].offset = offsetof(UIVertex, pos);
+    attributeDescriptions[1].location = 1;
+    attributeDescriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
+    attributeDescriptions[1].offset = offsetof(UIVertex, texCoord);
 
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertexInputInfo.vertexBindingDescriptionCount = 1;
     vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
     vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
@@ -2109,7 +2430,7 @@ void UI::createGraphicsPipeline() {
 
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = this->_initParam.topologyMode;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     inputAssembly.primitiveRestartEnable = VK_FALSE;
 
     VkViewport viewport{};
@@ -2135,9 +2456,9 @@ void UI::createGraphicsPipeline() {
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     rasterizer.depthClampEnable = VK_FALSE;
     rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = this->_initParam.polygonMode;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
     rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = this->_initParam.cullMode;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
     rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
     rasterizer.depthBiasEnable = VK_FALSE;
 
@@ -2146,17 +2467,24 @@ void UI::createGraphicsPipeline() {
     multisampling.sampleShadingEnable = VK_FALSE;
     multisampling.rasterizationSamples = msaaSamples;
 
+    // 모든 UI가 z = 0이므로 깊이 대신 그리는 순서(zOrder)로 겹침을 정한다
     VkPipelineDepthStencilStateCreateInfo depthStencil{};
     depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-    depthStencil.depthTestEnable = VK_TRUE;
-    depthStencil.depthWriteEnable = VK_TRUE;
-    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthTestEnable = VK_FALSE;
+    depthStencil.depthWriteEnable = VK_FALSE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_ALWAYS;
     depthStencil.depthBoundsTestEnable = VK_FALSE;
     depthStencil.stencilTestEnable = VK_FALSE;
 
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
     colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
+    colorBlendAttachment.blendEnable = VK_TRUE;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 
     VkPipelineColorBlendStateCreateInfo colorBlending{};
     colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
@@ -2164,17 +2492,13 @@ void UI::createGraphicsPipeline() {
     colorBlending.logicOp = VK_LOGIC_OP_COPY;
     colorBlending.attachmentCount = 1;
     colorBlending.pAttachments = &colorBlendAttachment;
-    colorBlending.blendConstants[0] = 0.0f;
-    colorBlending.blendConstants[1] = 0.0f;
-    colorBlending.blendConstants[2] = 0.0f;
-    colorBlending.blendConstants[3] = 0.0f;
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &this->descriptorSetLayout;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
 
-    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &this->pipelineLayout) != VK_SUCCESS) {
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
     }
 
@@ -2189,12 +2513,12 @@ void UI::createGraphicsPipeline() {
     pipelineInfo.pMultisampleState = &multisampling;
     pipelineInfo.pDepthStencilState = &depthStencil;
     pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.layout = this->pipelineLayout;
+    pipelineInfo.layout = pipelineLayout;
     pipelineInfo.renderPass = renderPass;
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &this->graphicsPipeline) != VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
 
@@ -2202,341 +2526,855 @@ void UI::createGraphicsPipeline() {
     vkDestroyShaderModule(device, vertShaderModule, nullptr);
 }
 
-void UI::createTextureImage() {
-    int texWidth, texHeight, texChannels;
+void UIBatcher::refresh() {
+    vkDestroyPipeline(device, graphicsPipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
 
-    std::string path = "textures/Button.png";
+    createGraphicsPipeline();
+}
 
-    stbi_uc* pixels = stbi_load(path.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
-    mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+void UIBatcher::destroy() {
+    if (atlasImage == VK_NULL_HANDLE)
+        return;
 
-    if (!pixels) {
-        throw std::runtime_error("failed to load texture image!");
-    }
+    vkDestroyPipeline(device, graphicsPipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+    descriptorCache.release(descriptorSet);
+    descriptorCache.dropLayout(descriptorSetLayout);
+    vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-        memcpy(data, pixels, static_cast<size_t>(imageSize));
-    vkUnmapMemory(device, stagingBufferMemory);
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (vertexBuffers[i] == VK_NULL_HANDLE)
+            continue;
+
+        vkUnmapMemory(device, vertexBuffersMemory[i]);
+        vkDestroyBuffer(device, vertexBuffers[i], nullptr);
+        vkFreeMemory(device, vertexBuffersMemory[i], nullptr);
+        vertexBuffers[i] = VK_NULL_HANDLE;
+        vertexCapacity[i] = 0;
+    }
 
-    stbi_image_free(pixels);
+    vkDestroyBuffer(device, indexBuffer, nullptr);
+    vkFreeMemory(device, indexBufferMemory, nullptr);
 
-    VkImageCreateInfo imageCreateInfo;
-    imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-    imageCreateInfo.pNext = nullptr;
-    imageCreateInfo.flags = 0;
-    imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-    imageCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-    imageCreateInfo.extent = {static_cast<unsigned int>(texWidth), static_cast<unsigned int>(texHeight), 1};
-    imageCreateInfo.mipLevels = mipLevels;
-    imageCreateInfo.arrayLayers = 1;
-    imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-    imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-    imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    vkDestroySampler(device, atlasSampler, nullptr);
+    vkDestroyImageView(device, atlasView, nullptr);
+    vkDestroyImage(device, atlasImage, nullptr);
+    vkFreeMemory(device, atlasMemory, nullptr);
+    atlasImage = VK_NULL_HANDLE;
 
-    if (vkCreateImage(device, &imageCreateInfo, nullptr, &this->textureImage) != VK_SUCCESS) {
-        throw std::runtime_error("textureImage 생성 실패");
-    }
+    atlasEntries.clear();
+    shelfX = shelfY = shelfHeight = 0;
+}
 
-    VkMemoryRequirements memRequir;
-    vkGetImageMemoryRequirements(device, this->textureImage, &memRequir);
+glm::vec4 UIBatcher::addTexture(const std::string& path) {
+    auto it = atlasEntries.find(path);
+    if (it != atlasEntries.end())
+        return it->second;
 
-    VkPhysicalDeviceMemoryProperties memProp;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProp);
+    int texWidth, texHeight, texChannels;
+    stbi_uc* pixels = stbi_load(path.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
 
-    int memTypeIdx = -1;
-    for (int i = 0; i< memProp.memoryTypeCount; i++) {
-        if (memRequir.memoryTypeBits & (1 << i) && memProp.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT == VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
-            memTypeIdx = i;
-            break;
-        }
-    }
-    if (memTypeIdx == -1) {
-        throw std::runtime_error("textureImageMemory에서 요구하는 유형의 메모리를 찾을 수 없음.");
+    if (!pixels) {
+        throw std::runtime_error("failed to load texture image!");
     }
 
-    VkMemoryAllocateInfo memAlloc;
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    memAlloc.pNext = nullptr;
-    memAlloc.memoryTypeIndex = memTypeIdx;
-    memAlloc.allocationSize = memRequir.size;
-
-    if (vkAllocateMemory(device, &memAlloc, nullptr, &this->textureImageMemory) != VK_SUCCESS) {
-        throw std::runtime_error("textureImageMemory 할당 실패");
+    glm::vec4 uv;
+    try {
+        uv = addImage(path, pixels, texWidth, texHeight);
+    } catch (...) {
+        stbi_image_free(pixels);
+        throw;
     }
 
-    vkBindImageMemory(device, this->textureImage, this->textureImageMemory, 0);
-
-    VkCommandBuffer recordBuffer;
-
-    VkCommandBufferAllocateInfo cmdbufAllocInfo;
-    cmdbufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    cmdbufAllocInfo.pNext = nullptr;
-    cmdbufAllocInfo.commandPool = commandPool;
-    cmdbufAllocInfo.commandBufferCount = 1;
-    cmdbufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-
-    vkAllocateCommandBuffers(device, &cmdbufAllocInfo, &recordBuffer);
-
-    VkCommandBufferBeginInfo cmdbufBeginInfo;
-    cmdbufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    cmdbufBeginInfo.pNext = nullptr;
-    cmdbufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(recordBuffer, &cmdbufBeginInfo);
-
-    VkImageMemoryBarrier imageMemoryBarrier{};
-    imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    imageMemoryBarrier.image = this->textureImage;
-    imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    imageMemoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
-    imageMemoryBarrier.subresourceRange.baseMipLevel = 0;
-    imageMemoryBarrier.subresourceRange.layerCount = 1;
-    // 모든 밉맵에 레이아웃을 적용하기 위해 dimension을 주입. 
-    imageMemoryBarrier.subresourceRange.levelCount = mipLevels;
+    stbi_image_free(pixels);
+    return uv;
+}
 
-    vkCmdPipelineBarrier(   recordBuffer, 
-                            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 
-                            VK_PIPELINE_STAGE_TRANSFER_BIT,
-                            0,
-                            0, nullptr,
-                            0, nullptr,
-                            1, &imageMemoryBarrier);
+glm::vec4 UIBatcher::addImage(const std::string& key, const unsigned char* rgba, int width, int height, bool inset) {
+    auto it = atlasEntries.find(key);
+    if (it != atlasEntries.end())
+        return it->second;
 
-    vkEndCommandBuffer(recordBuffer);
+    // 선형 필터가 옆 칸을 읽지 않도록 1픽셀 간격
+    uint32_t w = width + 1, h = height + 1;
 
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.pNext = nullptr;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &recordBuffer;
+    if (shelfX + w > atlasSize) {
+        shelfX = 0;
+        shelfY += shelfHeight;
+        shelfHeight = 0;
+    }
+    if (w > atlasSize || shelfY + h > atlasSize) {
+        throw std::runtime_error("UI atlas 공간 부족: " + key);
+    }
 
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
+    uint32_t x = shelfX, y = shelfY;
+    shelfX += w;
+    shelfHeight = std::max(shelfHeight, h);
 
-    vkFreeCommandBuffers(device, commandPool, 1, &recordBuffer);
+    VkDeviceSize imageSize = width * height * 4;
 
-    cmdbufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    cmdbufAllocInfo.pNext = nullptr;
-    cmdbufAllocInfo.commandPool = commandPool;
-    cmdbufAllocInfo.commandBufferCount = 1;
-    cmdbufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 
-    vkAllocateCommandBuffers(device, &cmdbufAllocInfo, &recordBuffer);
+    void* data;
+    vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
+        memcpy(data, rgba, static_cast<size_t>(imageSize));
+    vkUnmapMemory(device, stagingBufferMemory);
 
-    cmdbufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    cmdbufBeginInfo.pNext = nullptr;
-    cmdbufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VkCommandBuffer recordBuffer = beginUploadCommands();
 
-    vkBeginCommandBuffer(recordBuffer, &cmdbufBeginInfo);
+    colorImageBarrier(   recordBuffer, atlasImage, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
 
-    VkBufferImageCopy bufImgCopy;
-    bufImgCopy.bufferOffset = 0;
-    bufImgCopy.bufferRowLength = 0;
-    bufImgCopy.bufferImageHeight = 0;
+    VkBufferImageCopy bufImgCopy{};
     bufImgCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     bufImgCopy.imageSubresource.mipLevel = 0;
     bufImgCopy.imageSubresource.baseArrayLayer = 0;
     bufImgCopy.imageSubresource.layerCount = 1;
-    bufImgCopy.imageOffset = {0, 0, 0};
-    bufImgCopy.imageExtent = {  static_cast<unsigned int>(texWidth),
-                                static_cast<unsigned int>(texHeight),
+    bufImgCopy.imageOffset = { static_cast<int32_t>(x), static_cast<int32_t>(y), 0 };
+    bufImgCopy.imageExtent = {  static_cast<unsigned int>(width),
+                                static_cast<unsigned int>(height),
                                 1};
 
-    vkCmdCopyBufferToImage(recordBuffer, stagingBuffer, this->textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufImgCopy);
+    vkCmdCopyBufferToImage(recordBuffer, stagingBuffer, atlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufImgCopy);
 
-    vkEndCommandBuffer(recordBuffer);
-
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &recordBuffer;
-
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
+    colorImageBarrier(   recordBuffer, atlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 
-    vkFreeCommandBuffers(device, commandPool, 1, &recordBuffer);
+    endUploadCommands(recordBuffer);
 
     vkDestroyBuffer(device, stagingBuffer, nullptr);
     vkFreeMemory(device, stagingBufferMemory, nullptr);
 
-    generateMipmaps(this->textureImage, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, mipLevels);
+    // inset: 가장자리 텍셀의 중심까지만 (반 텍셀 안쪽)
+    float s = 1.0f / atlasSize;
+    float in = inset ? 0.5f : 0.0f;
+    glm::vec4 uv(   (x + in) * s, (y + in) * s,
+                    (x + width - in) * s, (y + height - in) * s);
+
+    atlasEntries[key] = uv;
+    return uv;
 }
 
-void UI::createTextureImageView() {
-    VkImageViewCreateInfo createInfo;
-    createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    createInfo.pNext = nullptr;
-    createInfo.flags = 0;
-    createInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-    createInfo.image = textureImage;
-    createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-    createInfo.components = {   VK_COMPONENT_SWIZZLE_R,
-                                VK_COMPONENT_SWIZZLE_G,
-                                VK_COMPONENT_SWIZZLE_B,
-                                VK_COMPONENT_SWIZZLE_A };
-    createInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT,
-                                    0,
-                                    mipLevels,
-                                    0,
-                                    1};
+void UIBatcher::reserveVertices(uint32_t frame, uint32_t count) {
+    if (count <= vertexCapacity[frame])
+        return;
 
-    if (vkCreateImageView(device, &createInfo, nullptr, &textureImageView) != VK_SUCCESS) {
-        throw std::runtime_error("textureImageView 생성 실패");
+    if (vertexBuffers[frame] != VK_NULL_HANDLE) {
+        vkUnmapMemory(device, vertexBuffersMemory[frame]);
+        vkDestroyBuffer(device, vertexBuffers[frame], nullptr);
+        vkFreeMemory(device, vertexBuffersMemory[frame], nullptr);
     }
-}
 
-void UI::createUniformBuffers() {
-    VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+    uint32_t capacity = std::max(vertexCapacity[frame], 256u);
+    while (capacity < count)
+        capacity *= 2;
 
-    uniformBuffers.resize(swapChainImages.size());
-    uniformBuffersMemory.resize(swapChainImages.size());
+    VkDeviceSize bufferSize = sizeof(UIVertex) * 4 * capacity;
+    createBuffer(   bufferSize,
+                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                    vertexBuffers[frame],
+                    vertexBuffersMemory[frame]);
 
-    for (size_t i = 0; i < swapChainImages.size(); i++) {
-        createBuffer(   bufferSize, 
-                        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-                        uniformBuffers[i], 
-                        uniformBuffersMemory[i]);
-    }
+    vkMapMemory(device, vertexBuffersMemory[frame], 0, bufferSize, 0, &vertexDataPoint[frame]);
+    vertexCapacity[frame] = capacity;
 }
 
-void UI::loadModel() {
-    srand(time(NULL));
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+void UIBatcher::collectUI(UI* ui) {
+    if (!ui->visible)
+        return;
 
-    float y0(normExtent[0]), x0(normExtent[1]), y1(normExtent[2]), x1(normExtent[3]);
+    if (ui->inAtlas)
+        drawItems.push_back({ ui->zOrder, ui, NULL, 0, 0 });
 
-    for (int ind = 0; ind < 1; ind++) {
-        for (int i = 0; i < 7; i++) {
-            Vertex vertex{};
+    for (UI* child : ui->children)
+        collectUI(child);
+}
 
-            switch (i)
-            {
-            case 0:
-                vertex.pos = glm::vec3(y0, x0, 0.0f);
-                vertex.texCoord = glm::vec2(0.0f, 0.0f);
-                break;
+void UIBatcher::buildLayout() {
+    drawItems.clear();
+    for (UI* ui : UIList)
+        if (!ui->parent)
+            collectUI(ui);
+    for (Text* text : textList)
+        if (text->isVisible())
+            drawItems.push_back({ text->getZOrder(), NULL, text, 0, 0 });
+
+    // 같은 zOrder는 만든 순서대로 (나중 것이 위, 자식은 부모 위), Text는 UI 위
+    std::stable_sort(drawItems.begin(), drawItems.end(), [](const DrawItem& a, const DrawItem& b) { return a.zOrder < b.zOrder; });
+
+    quads.clear();
+    for (DrawItem& item : drawItems) {
+        item.first = static_cast<uint32_t>(quads.size());
+
+        if (item.ui)
+            quads.push_back({ item.ui->normExtent, item.ui->uvRect });
+        else {
+            const std::vector<UIQuad>& glyphs = item.text->getQuads();
+            quads.insert(quads.end(), glyphs.begin(), glyphs.end());
+        }
 
-            case 1:
-                vertex.pos = glm::vec3(y1, x0, 0.0f);
-                vertex.texCoord = glm::vec2(1.0f, 0.0f);
-                break;
-            
-            case 2:
-                vertex.pos = glm::vec3(y1, x1, 0.0f);
-                vertex.texCoord = glm::vec2(1.0f, 1.0f);
-                break;
+        item.count = static_cast<uint32_t>(quads.size()) - item.first;
+    }
 
-            case 3:
-                vertex.pos = glm::vec3(y0, x0, 0.0f);
-                vertex.texCoord = glm::vec2(0.0f, 0.0f);
-                break;
-            
-            case 4:
-                vertex.pos = glm::vec3(y0, x1, 0.0f);
-                vertex.texCoord = glm::vec2(0.0f, 1.0f);
-                break;
-            
-            case 5:
-                vertex.pos = glm::vec3(y1, x1, 0.0f);
-                vertex.texCoord = glm::vec2(1.0f, 1.0f);
-                break;
+    builtVersion = version;
+    builtLayoutVersion = layoutVersion;
+}
 
-            case 6:
-                vertex.pos = glm::vec3(y0, x0, 0.0f);
-                vertex.texCoord = glm::vec2(0.0f, 0.0f);
-                break;
-            }
+void UIBatcher::updateQuads() {
+    if (builtLayoutVersion != layoutVersion) {
+        buildLayout();
+        return;
+    }
 
-            // 새로운 인스턴스 vertex이면
-            if (uniqueVertices.count(vertex) == 0) {
-                // 키: vertex 인스턴스 주소, 값: vertices 사이즈 크기
-                uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                vertices.push_back(vertex);
-            }
+    if (builtVersion == version)
+        return;
 
-            indices.push_back(uniqueVertices[vertex]);
+    for (const DrawItem& item : drawItems) {
+        if (item.ui) {
+            if (item.ui->batchVersion > builtVersion)
+                quads[item.first] = { item.ui->normExtent, item.ui->uvRect };
+            continue;
         }
+
+        if (item.text->batchVersion <= builtVersion)
+            continue;
+
+        // 글자 수가 바뀌면 뒤 요소의 구간이 밀리므로 전부 다시 배치
+        const std::vector<UIQuad>& glyphs = item.text->getQuads();
+        if (glyphs.size() != item.count) {
+            touchLayout();
+            buildLayout();
+            return;
+        }
+
+        std::copy(glyphs.begin(), glyphs.end(), quads.begin() + item.first);
     }
+
+    builtVersion = version;
 }
 
-void UI::createVertexBuffer() {
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
+void UIBatcher::writeQuads(uint32_t frame, uint32_t first, uint32_t count) {
+    UIVertex* v = static_cast<UIVertex*>(vertexDataPoint[frame]) + first * 4;
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+    for (uint32_t i = first; i < first + count; i++) {
+        glm::vec4 e = quads[i].rect;
+        glm::vec4 uv = quads[i].uv;
 
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, vertices.data(), (size_t) bufferSize);
-    vkUnmapMemory(device, stagingBufferMemory);
+        v[0] = { glm::vec2(e[0], e[1]), glm::vec2(uv[0], uv[1]) };
+        v[1] = { glm::vec2(e[2], e[1]), glm::vec2(uv[2], uv[1]) };
+        v[2] = { glm::vec2(e[2], e[3]), glm::vec2(uv[2], uv[3]) };
+        v[3] = { glm::vec2(e[0], e[3]), glm::vec2(uv[0], uv[3]) };
+        v += 4;
+    }
 
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+    writtenQuadCount += count;
+}
 
-    VkCommandBuffer commandBuffer;
+void UIBatcher::record(VkCommandBuffer commandBuffer, uint32_t frame) {
+    updateQuads();
 
-    VkCommandBufferAllocateInfo cmdbufAllocInfo{};
-    cmdbufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    cmdbufAllocInfo.pNext = nullptr;
-    cmdbufAllocInfo.commandPool = commandPool;
-    cmdbufAllocInfo.commandBufferCount = 1;
-    cmdbufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    quadCount = static_cast<uint32_t>(quads.size());
+    drawCount = 0;
+    writtenQuadCount = 0;
 
-    vkAllocateCommandBuffers(device, &cmdbufAllocInfo, &commandBuffer);
+    // 이 버퍼가 마지막으로 쓰인 뒤 배치가 바뀌었으면 전부, 아니면 그 뒤에 바뀐 요소만
+    if (frameLayoutVersion[frame] != builtLayoutVersion) {
+        reserveVertices(frame, quadCount);
+        writeQuads(frame, 0, quadCount);
+    }
+    else if (frameVersion[frame] != builtVersion) {
+        for (const DrawItem& item : drawItems) {
+            uint64_t itemVersion = item.ui ? item.ui->batchVersion : item.text->batchVersion;
+            if (itemVersion > frameVersion[frame])
+                writeQuads(frame, item.first, item.count);
+        }
+    }
 
-    VkCommandBufferBeginInfo cmdbufBeginInfo{};
-    cmdbufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    cmdbufBeginInfo.pNext = nullptr;
-    cmdbufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    frameVersion[frame] = builtVersion;
+    frameLayoutVersion[frame] = builtLayoutVersion;
 
-    vkBeginCommandBuffer(commandBuffer, &cmdbufBeginInfo);
+    if (quadCount == 0)
+        return;
 
-    VkBufferCopy copyRegion{};
-    copyRegion.size = bufferSize;
-    vkCmdCopyBuffer(commandBuffer, stagingBuffer, vertexBuffer, 1, &copyRegion);
+    VkDeviceSize offset = 0;
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffers[frame], &offset);
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+
+    // uint16 인덱스 범위를 넘으면 vertexOffset을 옮겨 가며 나눠 그린다
+    for (uint32_t first = 0; first < quadCount; first += quadsPerDraw) {
+        uint32_t count = quadCount - first;
+        if (count > quadsPerDraw)
+            count = quadsPerDraw;
+        vkCmdDrawIndexed(commandBuffer, count * 6, 1, 0, static_cast<int32_t>(first * 4), 0);
+        drawCount++;
+    }
+}
 
-    vkEndCommandBuffer(commandBuffer);
+Font::Font(const std::string& path, float pixelHeight) : pixelHeight(pixelHeight) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
 
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.pNext = nullptr;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
-    
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, nullptr);
-    vkQueueWaitIdle(graphicsQueue);
+    if (!file.is_open()) {
+        throw std::runtime_error("font 파일을 열 수 없음: " + path);
+    }
 
-    vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+    std::vector<unsigned char> ttf((size_t) file.tellg());
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(ttf.data()), ttf.size());
+
+    stbtt_fontinfo info;
+    if (!stbtt_InitFont(&info, ttf.data(), stbtt_GetFontOffsetForIndex(ttf.data(), 0))) {
+        throw std::runtime_error("font를 읽을 수 없음: " + path);
+    }
+
+    float scale = stbtt_ScaleForPixelHeight(&info, pixelHeight);
+    int asc, desc, gap;
+    stbtt_GetFontVMetrics(&info, &asc, &desc, &gap);
+
+    ascent = asc * scale;
+    lineHeight = (asc - desc + gap) * scale;
+
+    // 글자가 다 들어갈 때까지 비트맵을 키운다
+    std::vector<unsigned char> bitmap;
+    for (bitmapSize = 128;; bitmapSize *= 2) {
+        if (bitmapSize > static_cast<int>(uiBatcher.atlasSize)) {
+            throw std::runtime_error("font 글리프가 UI atlas보다 큼: " + path);
+        }
+
+        bitmap.assign(bitmapSize * bitmapSize, 0);
+
+        stbtt_pack_context pc;
+        stbtt_PackBegin(&pc, bitmap.data(), bitmapSize, bitmapSize, 0, 1, nullptr);
+        int packed = stbtt_PackFontRange(&pc, ttf.data(), 0, pixelHeight, firstChar, charCount, glyphs);
+        stbtt_PackEnd(&pc);
+
+        if (packed)
+            break;
+    }
+
+    std::vector<unsigned char> rgba(bitmap.size() * 4);
+    for (size_t i = 0; i < bitmap.size(); i++) {
+        rgba[i * 4 + 0] = 255;
+        rgba[i * 4 + 1] = 255;
+        rgba[i * 4 + 2] = 255;
+        rgba[i * 4 + 3] = bitmap[i];
+    }
+
+    // 글리프 사이 간격은 packer가 이미 넣었다
+    atlasRect = uiBatcher.addImage(path + "#" + std::to_string(pixelHeight), rgba.data(), bitmapSize, bitmapSize, false);
+}
+
+static AABB extentToAABB(glm::vec4 extent) {
+    return { glm::vec3(extent[0], extent[1], 0.0f), glm::vec3(extent[2], extent[3], 0.0f) };
+}
+
+void UIHitIndex::insert(UI* ui) {
+    if (ui->hitProxy != -1)
+        return;
+
+    ui->hitProxy = tree.createProxy(extentToAABB(ui->getWorldExtent()), ui);
+    count++;
+}
+
+void UIHitIndex::remove(UI* ui) {
+    if (ui->hitProxy == -1)
+        return;
+
+    tree.destroyProxy(ui->hitProxy);
+    ui->hitProxy = -1;
+    count--;
+}
+
+void UIHitIndex::update(UI* ui) {
+    if (ui->hitProxy == -1)
+        return;
+
+    tree.moveProxy(ui->hitProxy, extentToAABB(ui->getWorldExtent()), glm::vec3(0.0f));
+}
+
+UI* UIHitIndex::pick(float x, float y) {
+    glm::vec3 p(x, y, 0.0f);
+    UI* top = NULL;
+
+    // Extent는 [x0, x1) x [y0, y1)
+    tree.query({ p, p }, [&](int proxyId) {
+        UI* ui = static_cast<UI*>(tree.getUserData(proxyId));
+        glm::vec4 e = ui->getWorldExtent();
+
+        if (x < e[0] || x >= e[2] || y < e[1] || y >= e[3] || !ui->isShown())
+            return true;
+
+        if (!top || ui->zOrder > top->zOrder || (ui->zOrder == top->zOrder && ui->getIndex() > top->getIndex()))
+            top = ui;
+        return true;
+    });
+
+    return top;
+}
+
+UI* pickUI(double windowX, double windowY) {
+    // UI는 normExtent로 그려져 창 크기를 따라 늘어나므로 커서도 기준 해상도로 맞춘다
+    // headless는 창이 없으므로 (재생한 커서 좌표가) 이미 기준 해상도
+    int width = WIDTH, height = HEIGHT;
+    if (!headless)
+        glfwGetWindowSize(window, &width, &height);
+
+    if (width <= 0 || height <= 0)
+        return NULL;
+
+    return uiHitIndex.pick( static_cast<float>(windowX * WIDTH / width),
+                            static_cast<float>(windowY * HEIGHT / height));
+}
+
+///////////////////////////////////////////////////
+//////////////////   BINDLESS   ///////////////////
+///////////////////////////////////////////////////
+
+void createBindlessResources() {
+    // 텍스처 배열 크기를 장치 한도에 맞춤
+    PFN_vkGetPhysicalDeviceProperties2KHR getPhysicalDeviceProperties2;
+    getPhysicalDeviceProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2KHR"));
+
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProps{};
+    indexingProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+
+    VkPhysicalDeviceProperties2KHR props2{};
+    props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+    props2.pNext = &indexingProps;
+
+    getPhysicalDeviceProperties2(physicalDevice, &props2);
+
+    bindlessTextureCapacity = std::min({    MAX_BINDLESS_TEXTURES,
+                                            indexingProps.maxDescriptorSetUpdateAfterBindSampledImages,
+                                            indexingProps.maxDescriptorSetUpdateAfterBindSamplers,
+                                            indexingProps.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                            indexingProps.maxPerStageDescriptorUpdateAfterBindSamplers });
+
+    // set layout
+    // binding 0 : draw 버퍼, binding 3 : compute texel buffer, binding 4 : 텍스처 배열
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorCount = 1;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    bindings[1].binding = 3;
+    bindings[1].descriptorCount = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[2].binding = 4;
+    bindings[2].descriptorCount = bindlessTextureCapacity;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // 텍스처 배열은 일부만 채워진 채로, 프레임 진행 중에도 갱신 가능
+    std::array<VkDescriptorBindingFlagsEXT, 3> bindingFlags = { 0,
+                                                                0,
+                                                                VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                                                                VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT_EXT |
+                                                                VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                                                                VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &bindlessSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("bindless descriptor set layout 생성 실패");
+    }
+
+    // pipeline layout
+    // GraphicsConstantLayouts(64 byte) 뒤에 BindlessDrawConstants
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(GraphicsConstantLayouts) + sizeof(BindlessDrawConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &bindlessSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &bindlessPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("bindless pipelineLayout 생성 실패");
+    }
+
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.size = sizeof(ComputeConstantLayouts);
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &bindlessComputePipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("bindless compute pipelineLayout 생성 실패");
+    }
+
+    // draw 버퍼 (프레임마다 하나, 영구 매핑)
+    VkDeviceSize drawBufferSize = sizeof(UniformBufferObject) * MAX_BINDLESS_DRAWS;
+
+    bindlessDrawBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    bindlessDrawBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    bindlessDrawDataPoint.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        createBuffer(   drawBufferSize,
+                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                        bindlessDrawBuffers[i],
+                        bindlessDrawBuffersMemory[i]);
+
+        vkMapMemory(device, bindlessDrawBuffersMemory[i], 0, drawBufferSize, 0, &bindlessDrawDataPoint[i]);
+    }
+
+    // compute texel buffer (기존에는 Models마다 같은 내용으로 하나씩 만들었음)
+    VkDeviceSize texelBufferSize = sizeof(TexelBufferObject[0]) * TexelBufferObject.size();
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    createBuffer(texelBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+    void* data;
+    vkMapMemory(device, stagingBufferMemory, 0, texelBufferSize, 0, &data);
+        memcpy(data, TexelBufferObject.data(), (size_t) texelBufferSize);
+    vkUnmapMemory(device, stagingBufferMemory);
+
+    createBuffer(   texelBufferSize,
+                    VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                    bindlessTexelBuffer,
+                    bindlessTexelBufferMemory);
+
+    copyBuffer(stagingBuffer, bindlessTexelBuffer, texelBufferSize);
 
     vkDestroyBuffer(device, stagingBuffer, nullptr);
     vkFreeMemory(device, stagingBufferMemory, nullptr);
+
+    VkBufferViewCreateInfo bufferViewCreateInfo{};
+    bufferViewCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO;
+    bufferViewCreateInfo.buffer = bindlessTexelBuffer;
+    bufferViewCreateInfo.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    bufferViewCreateInfo.offset = 0;
+    bufferViewCreateInfo.range = VK_WHOLE_SIZE;
+
+    if (vkCreateBufferView(device, &bufferViewCreateInfo, nullptr, &bindlessTexelBufferView) != VK_SUCCESS) {
+        throw std::runtime_error("bindless texelBufferView 생성 실패");
+    }
+
+    // descriptor pool / sets
+    std::array<VkDescriptorPoolSize, 3> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[0].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+    poolSizes[1].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[2].descriptorCount = MAX_FRAMES_IN_FLIGHT * bindlessTextureCapacity;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &bindlessDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("bindless descriptor pool 생성 실패");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, bindlessSetLayout);
+    std::vector<uint32_t> variableCounts(MAX_FRAMES_IN_FLIGHT, bindlessTextureCapacity);
+
+    VkDescriptorSetVariableDescriptorCountAllocateInfoEXT variableCountInfo{};
+    variableCountInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO_EXT;
+    variableCountInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
+    variableCountInfo.pDescriptorCounts = variableCounts.data();
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.pNext = &variableCountInfo;
+    allocInfo.descriptorPool = bindlessDescriptorPool;
+    allocInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
+    allocInfo.pSetLayouts = layouts.data();
+
+    bindlessDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    if (vkAllocateDescriptorSets(device, &allocInfo, bindlessDescriptorSets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("bindless descriptor sets 할당 실패");
+    }
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        VkDescriptorBufferInfo drawBufferInfo{};
+        drawBufferInfo.buffer = bindlessDrawBuffers[i];
+        drawBufferInfo.offset = 0;
+        drawBufferInfo.range = VK_WHOLE_SIZE;
+
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+
+        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].dstSet = bindlessDescriptorSets[i];
+        descriptorWrites[0].dstBinding = 0;
+        descriptorWrites[0].dstArrayElement = 0;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].pBufferInfo = &drawBufferInfo;
+
+        descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[1].dstSet = bindlessDescriptorSets[i];
+        descriptorWrites[1].dstBinding = 3;
+        descriptorWrites[1].dstArrayElement = 0;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pTexelBufferView = &bindlessTexelBufferView;
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+    }
 }
 
-void UI::createIndexBuffer() {
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+void cleanupBindless() {
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        vkUnmapMemory(device, bindlessDrawBuffersMemory[i]);
+        vkDestroyBuffer(device, bindlessDrawBuffers[i], nullptr);
+        vkFreeMemory(device, bindlessDrawBuffersMemory[i], nullptr);
+    }
+
+    vkDestroyBufferView(device, bindlessTexelBufferView, nullptr);
+    vkDestroyBuffer(device, bindlessTexelBuffer, nullptr);
+    vkFreeMemory(device, bindlessTexelBufferMemory, nullptr);
+
+    vkDestroyDescriptorPool(device, bindlessDescriptorPool, nullptr);
+
+    vkDestroyPipelineLayout(device, bindlessComputePipelineLayout, nullptr);
+    vkDestroyPipelineLayout(device, bindlessPipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, bindlessSetLayout, nullptr);
+}
+
+// 텍스처 배열의 빈 슬롯에 imageView를 기록하고 인덱스를 반환
+uint32_t registerBindlessTexture(VkImageView imageView) {
+    uint32_t index;
+
+    if (!bindlessFreeTextures.empty()) {
+        index = bindlessFreeTextures.back();
+        bindlessFreeTextures.pop_back();
+    }
+    else {
+        if (bindlessTextureCount >= bindlessTextureCapacity)
+            throw std::runtime_error("bindless 텍스처 배열이 가득 참.");
+        index = bindlessTextureCount++;
+    }
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView = imageView;
+    imageInfo.sampler = textureSampler;
+
+    std::vector<VkWriteDescriptorSet> descriptorWrites(MAX_FRAMES_IN_FLIGHT);
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = bindlessDescriptorSets[i];
+        descriptorWrites[i].dstBinding = 4;
+        descriptorWrites[i].dstArrayElement = index;
+        descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pImageInfo = &imageInfo;
+    }
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+    return index;
+}
+
+// partially bound 이므로 슬롯은 비워둔 채 재사용 목록에만 넣는다
+void releaseBindlessTexture(uint32_t index) {
+    bindlessFreeTextures.push_back(index);
+}
+
+uint32_t acquireBindlessDraw() {
+    if (!bindlessFreeDraws.empty()) {
+        uint32_t index = bindlessFreeDraws.back();
+        bindlessFreeDraws.pop_back();
+        return index;
+    }
+
+    if (bindlessDrawCount >= MAX_BINDLESS_DRAWS)
+        throw std::runtime_error("bindless draw 버퍼가 가득 참.");
+
+    return bindlessDrawCount++;
+}
+
+void releaseBindlessDraw(uint32_t index) {
+    bindlessFreeDraws.push_back(index);
+}
+
+// spv/GameObject/base.spv -> spv/GameObject/Bindless/base.spv
+std::string getBindlessShaderPath(const std::string& path) {
+    size_t pos = path.find_last_of('/');
+
+    if (pos == std::string::npos)
+        return "Bindless/" + path;
+    return path.substr(0, pos + 1) + "Bindless/" + path.substr(pos + 1);
+}
+
+///////////////////////////////////////////////////
+//////////////////   GEOMETRY   ///////////////////
+///////////////////////////////////////////////////
+
+// vertexOffset / firstIndex 는 원소 단위이므로 원소 크기에 맞춰 정렬
+static VkDeviceSize alignUp(VkDeviceSize v, VkDeviceSize a) {
+    return (v + a - 1) / a * a;
+}
+
+// 구간을 offset 순으로 되돌리고 이웃과 합친다. 끝에 닿으면 used를 줄인다.
+static void releaseGeometryRange(std::vector<GeometryRange>& freeRanges, VkDeviceSize& used, VkDeviceSize offset, VkDeviceSize size) {
+    if (size == 0)
+        return;
+
+    auto it = std::lower_bound(freeRanges.begin(), freeRanges.end(), offset,
+                                [](const GeometryRange& r, VkDeviceSize o) { return r.offset < o; });
+    it = freeRanges.insert(it, { offset, size });
+
+    auto next = it + 1;
+    if (next != freeRanges.end() && it->offset + it->size == next->offset) {
+        it->size += next->size;
+        freeRanges.erase(next);
+    }
+    if (it != freeRanges.begin()) {
+        auto prev = it - 1;
+        if (prev->offset + prev->size == it->offset) {
+            prev->size += it->size;
+            freeRanges.erase(it);
+        }
+    }
+
+    if (!freeRanges.empty() && freeRanges.back().offset + freeRanges.back().size == used) {
+        used = freeRanges.back().offset;
+        freeRanges.pop_back();
+    }
+}
+
+// 빈 구간 중 처음 맞는 곳, 없으면 used 뒤. rangeIndex는 쓴 빈 구간 (-1이면 used 뒤)
+static bool findGeometryRange(  const std::vector<GeometryRange>& freeRanges, VkDeviceSize used, VkDeviceSize capacity,
+                                VkDeviceSize size, VkDeviceSize align, VkDeviceSize& start, int& rangeIndex) {
+    for (size_t i = 0; i < freeRanges.size(); i++) {
+        start = alignUp(freeRanges[i].offset, align);
+        if (start + size <= freeRanges[i].offset + freeRanges[i].size) {
+            rangeIndex = static_cast<int>(i);
+            return true;
+        }
+    }
+
+    start = alignUp(used, align);
+    rangeIndex = -1;
+    return start + size <= capacity;
+}
+
+// findGeometryRange로 찾은 자리를 차지. 빈 구간은 앞뒤 남는 부분만 남긴다.
+static void takeGeometryRange(std::vector<GeometryRange>& freeRanges, VkDeviceSize& used, VkDeviceSize start, VkDeviceSize size, int rangeIndex) {
+    if (size == 0)
+        return;
+
+    if (rangeIndex < 0) {
+        // 정렬로 생긴 틈도 빈 구간으로 남겨둔다
+        VkDeviceSize gap = used;
+        used = start + size;
+        releaseGeometryRange(freeRanges, used, gap, start - gap);
+        return;
+    }
+
+    GeometryRange range = freeRanges[rangeIndex];
+    freeRanges.erase(freeRanges.begin() + rangeIndex);
+
+    VkDeviceSize end = start + size;
+    VkDeviceSize rangeEnd = range.offset + range.size;
+
+    if (rangeEnd > end)
+        freeRanges.insert(freeRanges.begin() + rangeIndex, { end, rangeEnd - end });
+    if (start > range.offset)
+        freeRanges.insert(freeRanges.begin() + rangeIndex, { range.offset, start - range.offset });
+}
+
+GeometryBlock* GeometryPool::createBlock(VkDeviceSize vertexSize, VkDeviceSize indexSize) {
+    GeometryBlock* block = new GeometryBlock();
+
+    block->vertexCapacity = std::max(vertexSize, blockVertexSize);
+    block->indexCapacity = std::max(indexSize, blockIndexSize);
+    block->vertexUsed = 0;
+    block->indexUsed = 0;
+
+    createBuffer(   block->vertexCapacity, 
+                    VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
+                    block->vertexBuffer, 
+                    block->vertexBufferMemory);
+
+    createBuffer(   block->indexCapacity, 
+                    VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
+                    block->indexBuffer, 
+                    block->indexBufferMemory);
+
+    blocks.push_back(block);
+
+    return block;
+}
+
+void GeometryPool::upload(Models* m) {
+    VkDeviceSize indexStride = m->indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    VkDeviceSize vertexSize = sizeof(m->vertices[0]) * m->vertices.size();
+    VkDeviceSize indexSize = indexStride * m->indices.size();
+
+    GeometryBlock* block = nullptr;
+    VkDeviceSize vertexStart, indexStart;
+    int vertexRange, indexRange;
+
+    for (GeometryBlock* b : blocks) {
+        if (findGeometryRange(b->freeVertexRanges, b->vertexUsed, b->vertexCapacity, vertexSize, sizeof(Vertex), vertexStart, vertexRange) &&
+            findGeometryRange(b->freeIndexRanges, b->indexUsed, b->indexCapacity, indexSize, indexStride, indexStart, indexRange)) {
+            block = b;
+            break;
+        }
+    }
+
+    if (!block) {
+        block = createBlock(vertexSize, indexSize);
+        vertexStart = 0;
+        indexStart = 0;
+        vertexRange = -1;
+        indexRange = -1;
+    }
+
+    takeGeometryRange(block->freeVertexRanges, block->vertexUsed, vertexStart, vertexSize, vertexRange);
+    takeGeometryRange(block->freeIndexRanges, block->indexUsed, indexStart, indexSize, indexRange);
 
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingBufferMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+    createBuffer(vertexSize + indexSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 
     void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, indices.data(), (size_t) bufferSize);
-    vkUnmapMemory(device, stagingBufferMemory);
+    vkMapMemory(device, stagingBufferMemory, 0, vertexSize + indexSize, 0, &data);
+        memcpy(data, m->vertices.data(), (size_t) vertexSize);
 
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
+        if (m->indexType == VK_INDEX_TYPE_UINT16) {
+            uint16_t* dst = reinterpret_cast<uint16_t*>(static_cast<char*>(data) + vertexSize);
+            for (size_t i = 0; i < m->indices.size(); i++)
+                dst[i] = static_cast<uint16_t>(m->indices[i]);
+        }
+        else {
+            memcpy(static_cast<char*>(data) + vertexSize, m->indices.data(), (size_t) indexSize);
+        }
+    vkUnmapMemory(device, stagingBufferMemory);
 
     VkCommandBuffer commandBuffer;
 
@@ -2557,8 +3395,15 @@ void UI::createIndexBuffer() {
     vkBeginCommandBuffer(commandBuffer, &cmdbufBeginInfo);
 
     VkBufferCopy copyRegion{};
-    copyRegion.size = bufferSize;
-    vkCmdCopyBuffer(commandBuffer, stagingBuffer, indexBuffer, 1, &copyRegion);
+    copyRegion.srcOffset = 0;
+    copyRegion.dstOffset = vertexStart;
+    copyRegion.size = vertexSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, block->vertexBuffer, 1, &copyRegion);
+
+    copyRegion.srcOffset = vertexSize;
+    copyRegion.dstOffset = indexStart;
+    copyRegion.size = indexSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, block->indexBuffer, 1, &copyRegion);
 
     vkEndCommandBuffer(commandBuffer);
 
@@ -2575,69 +3420,3371 @@ void UI::createIndexBuffer() {
 
     vkDestroyBuffer(device, stagingBuffer, nullptr);
     vkFreeMemory(device, stagingBufferMemory, nullptr);
+
+    m->geometryBlock = block;
+    m->vertexBytes = vertexSize;
+    m->indexBytes = indexSize;
+    m->vertexOffset = static_cast<int32_t>(vertexStart / sizeof(Vertex));
+    // 바인딩 오프셋은 항상 0, firstIndex는 해당 인덱스 타입 단위
+    m->firstIndex = static_cast<uint32_t>(indexStart / indexStride);
+    m->indexCount = static_cast<uint32_t>(m->indices.size());
 }
 
-void UI::createDescriptorPool() {
-    std::array<VkDescriptorPoolSize, 2> poolSizes{};
-    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSizes[0].descriptorCount = static_cast<uint32_t>(swapChainImages.size());
-    poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[1].descriptorCount = static_cast<uint32_t>(swapChainImages.size());
+void GeometryPool::release(Models* m) {
+    if (!m->geometryBlock)
+        return;
 
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = static_cast<uint32_t>(swapChainImages.size());
+    GeometryBlock* block = m->geometryBlock;
+    VkDeviceSize indexStride = m->indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
 
-    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create descriptor pool!");
-    }
+    releaseGeometryRange(block->freeVertexRanges, block->vertexUsed, static_cast<VkDeviceSize>(m->vertexOffset) * sizeof(Vertex), m->vertexBytes);
+    releaseGeometryRange(block->freeIndexRanges, block->indexUsed, static_cast<VkDeviceSize>(m->firstIndex) * indexStride, m->indexBytes);
+
+    m->geometryBlock = nullptr;
 }
 
-void UI::createDescriptorSets() {
-    std::vector<VkDescriptorSetLayout> layouts(swapChainImages.size(), descriptorSetLayout);
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = descriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(swapChainImages.size());
-    allocInfo.pSetLayouts = layouts.data();
+void GeometryPool::destroy() {
+    for (GeometryBlock* block : blocks) {
+        vkDestroyBuffer(device, block->indexBuffer, nullptr);
+        vkFreeMemory(device, block->indexBufferMemory, nullptr);
 
-    descriptorSets.resize(swapChainImages.size());
-    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate descriptor sets!");
-    }
+        vkDestroyBuffer(device, block->vertexBuffer, nullptr);
+        vkFreeMemory(device, block->vertexBufferMemory, nullptr);
 
-    for (size_t i = 0; i < swapChainImages.size(); i++) {
-        VkDescriptorBufferInfo bufferInfo{};
-        bufferInfo.buffer = uniformBuffers[i];
-        bufferInfo.offset = 0;
-        bufferInfo.range = sizeof(UniformBufferObject);
+        delete(block);
+    }
+    blocks.clear();
+}
 
-        VkDescriptorImageInfo imageInfo{};
-        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        imageInfo.imageView = textureImageView;
-        imageInfo.sampler = textureSampler;
+///////////////////////////////////////////////////
+////////////////   MATRIX KERNEL   ////////////////
+///////////////////////////////////////////////////
 
-        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+// lane 폭만 다른 SIMD 연산 묶음. 같은 커널 템플릿을 SSE / AVX2 로 찍어낸다.
+#ifdef USE_SSE
+struct SimdSSE {
+    typedef __m128 V;
+    typedef __m128i I;
+    enum { width = 4 };
+
+    static V set1(float f)              { return _mm_set1_ps(f); }
+    static V load(const float* p)       { return _mm_loadu_ps(p); }
+    static V add(V a, V b)              { return _mm_add_ps(a, b); }
+    static V sub(V a, V b)              { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b)              { return _mm_mul_ps(a, b); }
+    static V bitAnd(V a, V b)           { return _mm_and_ps(a, b); }
+    static V bitXor(V a, V b)           { return _mm_xor_ps(a, b); }
+    static V select(V mask, V a, V b)   { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    static void store(float* p, V a)    { _mm_storeu_ps(p, a); }
+    static V div(V a, V b)              { return _mm_div_ps(a, b); }
+    static V sqrt(V a)                  { return _mm_sqrt_ps(a); }
+    static V min(V a, V b)              { return _mm_min_ps(a, b); }
+    static V max(V a, V b)              { return _mm_max_ps(a, b); }
+    static V abs(V a)                   { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static V bitOr(V a, V b)            { return _mm_or_ps(a, b); }
+    static V cmpLt(V a, V b)            { return _mm_cmplt_ps(a, b); }
+    static V cmpLe(V a, V b)            { return _mm_cmple_ps(a, b); }
+    static int moveMask(V a)            { return _mm_movemask_ps(a); }
+    static I toInt(V a)                 { return _mm_cvtps_epi32(a); }
+    static V toFloat(I a)               { return _mm_cvtepi32_ps(a); }
+    static I iset1(int i)               { return _mm_set1_epi32(i); }
+    static I iand(I a, I b)             { return _mm_and_si128(a, b); }
+    static V ieq(I a, I b)              { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+
+    // m[열 * 4 + 행]의 각 lane이 한 물체. 4x4 전치로 물체별 열 우선 행렬을 만든다.
+    static void storeMatrices(V m[16], char* dst, size_t stride) {
+        for (int c = 0; c < 4; c++) {
+            V r0 = m[4 * c], r1 = m[4 * c + 1], r2 = m[4 * c + 2], r3 = m[4 * c + 3];
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+            _mm_storeu_ps(reinterpret_cast<float*>(dst) + 4 * c, r0);
+            _mm_storeu_ps(reinterpret_cast<float*>(dst + stride) + 4 * c, r1);
+            _mm_storeu_ps(reinterpret_cast<float*>(dst + 2 * stride) + 4 * c, r2);
+            _mm_storeu_ps(reinterpret_cast<float*>(dst + 3 * stride) + 4 * c, r3);
+        }
+    }
+};
+#endif
+
+#ifdef USE_AVX2
+struct SimdAVX2 {
+    typedef __m256 V;
+    typedef __m256i I;
+    enum { width = 8 };
+
+    static V set1(float f)              { return _mm256_set1_ps(f); }
+    static V load(const float* p)       { return _mm256_loadu_ps(p); }
+    static V add(V a, V b)              { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b)              { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b)              { return _mm256_mul_ps(a, b); }
+    static V bitAnd(V a, V b)           { return _mm256_and_ps(a, b); }
+    static V bitXor(V a, V b)           { return _mm256_xor_ps(a, b); }
+    static V select(V mask, V a, V b)   { return _mm256_blendv_ps(b, a, mask); }
+    static void store(float* p, V a)    { _mm256_storeu_ps(p, a); }
+    static V div(V a, V b)              { return _mm256_div_ps(a, b); }
+    static V sqrt(V a)                  { return _mm256_sqrt_ps(a); }
+    static V min(V a, V b)              { return _mm256_min_ps(a, b); }
+    static V max(V a, V b)              { return _mm256_max_ps(a, b); }
+    static V abs(V a)                   { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static V bitOr(V a, V b)            { return _mm256_or_ps(a, b); }
+    static V cmpLt(V a, V b)            { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static V cmpLe(V a, V b)            { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static int moveMask(V a)            { return _mm256_movemask_ps(a); }
+    static I toInt(V a)                 { return _mm256_cvtps_epi32(a); }
+    static V toFloat(I a)               { return _mm256_cvtepi32_ps(a); }
+    static I iset1(int i)               { return _mm256_set1_epi32(i); }
+    static I iand(I a, I b)             { return _mm256_and_si256(a, b); }
+    static V ieq(I a, I b)              { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+
+    // 아래 / 위 128bit를 각각 SSE 전치로 저장
+    static void storeMatrices(V m[16], char* dst, size_t stride) {
+        __m128 lo[16], hi[16];
+        for (int k = 0; k < 16; k++) {
+            lo[k] = _mm256_castps256_ps128(m[k]);
+            hi[k] = _mm256_extractf128_ps(m[k], 1);
+        }
+        SimdSSE::storeMatrices(lo, dst, stride);
+        SimdSSE::storeMatrices(hi, dst + 4 * stride, stride);
+    }
+};
+#endif
+
+#ifdef USE_SSE
+// Cephes 방식 sin / cos. pi/2 단위로 줄인 뒤 [-pi/4, pi/4] 다항식.
+template <typename S>
+static void simdSinCos(typename S::V x, typename S::V& s, typename S::V& c) {
+    typedef typename S::V V;
+    typedef typename S::I I;
+
+    I j = S::toInt(S::mul(x, S::set1(0.63661977236758134f)));
+    V fj = S::toFloat(j);
+
+    V r = S::sub(x, S::mul(fj, S::set1(1.5703125f)));
+    r = S::sub(r, S::mul(fj, S::set1(4.837512969970703125e-4f)));
+    r = S::sub(r, S::mul(fj, S::set1(7.54978995489188216e-8f)));
+    V r2 = S::mul(r, r);
+
+    V ps = S::add(S::mul(S::set1(-1.9515295891e-4f), r2), S::set1(8.3321608736e-3f));
+    ps = S::add(S::mul(ps, r2), S::set1(-1.6666654611e-1f));
+    ps = S::add(r, S::mul(S::mul(ps, r2), r));
+
+    V pc = S::add(S::mul(S::set1(2.443315711809948e-5f), r2), S::set1(-1.388731625493765e-3f));
+    pc = S::add(S::mul(pc, r2), S::set1(4.166664568298827e-2f));
+    pc = S::add(S::sub(S::set1(1.0f), S::mul(S::set1(0.5f), r2)), S::mul(S::mul(pc, r2), r2));
+
+    // 사분면 : 1, 3은 sin/cos 교환, 2, 3은 sin 부호, 1, 2는 cos 부호
+    V swap = S::ieq(S::iand(j, S::iset1(1)), S::iset1(1));
+    V sinNeg = S::ieq(S::iand(j, S::iset1(2)), S::iset1(2));
+    V cosNeg = S::bitXor(swap, sinNeg);
+    V sign = S::set1(-0.0f);
+
+    s = S::bitXor(S::select(swap, pc, ps), S::bitAnd(sinNeg, sign));
+    c = S::bitXor(S::select(swap, ps, pc), S::bitAnd(cosNeg, sign));
+}
+
+// T * Rx * Ry * Rz * S (오일러, 도)
+template <typename S>
+static void composeEulerBlock(const TransformArrays& in, size_t i, char* dst, size_t stride) {
+    typedef typename S::V V;
+
+    V toRad = S::set1(0.017453292519943295f);
+    V sx, cx, sy, cy, sz, cz;
+    simdSinCos<S>(S::mul(S::load(in.euler[0] + i), toRad), sx, cx);
+    simdSinCos<S>(S::mul(S::load(in.euler[1] + i), toRad), sy, cy);
+    simdSinCos<S>(S::mul(S::load(in.euler[2] + i), toRad), sz, cz);
+
+    V kx = S::load(in.scale[0] + i);
+    V ky = S::load(in.scale[1] + i);
+    V kz = S::load(in.scale[2] + i);
+
+    V zero = S::set1(0.0f);
+    V sxsy = S::mul(sx, sy);
+    V cxsy = S::mul(cx, sy);
+
+    V m[16];
+    m[0]  = S::mul(S::mul(cy, cz), kx);
+    m[1]  = S::mul(S::add(S::mul(sxsy, cz), S::mul(cx, sz)), kx);
+    m[2]  = S::mul(S::sub(S::mul(sx, sz), S::mul(cxsy, cz)), kx);
+    m[3]  = zero;
+
+    m[4]  = S::mul(S::sub(zero, S::mul(cy, sz)), ky);
+    m[5]  = S::mul(S::sub(S::mul(cx, cz), S::mul(sxsy, sz)), ky);
+    m[6]  = S::mul(S::add(S::mul(cxsy, sz), S::mul(sx, cz)), ky);
+    m[7]  = zero;
+
+    m[8]  = S::mul(sy, kz);
+    m[9]  = S::mul(S::sub(zero, S::mul(sx, cy)), kz);
+    m[10] = S::mul(S::mul(cx, cy), kz);
+    m[11] = zero;
+
+    m[12] = S::load(in.position[0] + i);
+    m[13] = S::load(in.position[1] + i);
+    m[14] = S::load(in.position[2] + i);
+    m[15] = S::set1(1.0f);
+
+    S::storeMatrices(m, dst, stride);
+}
+
+// T * R(q) * S
+template <typename S>
+static void composeQuatBlock(const TransformArrays& in, size_t i, char* dst, size_t stride) {
+    typedef typename S::V V;
+
+    V x = S::load(in.quat[0] + i);
+    V y = S::load(in.quat[1] + i);
+    V z = S::load(in.quat[2] + i);
+    V w = S::load(in.quat[3] + i);
+
+    V kx = S::load(in.scale[0] + i);
+    V ky = S::load(in.scale[1] + i);
+    V kz = S::load(in.scale[2] + i);
+
+    V one = S::set1(1.0f);
+    V two = S::set1(2.0f);
+    V zero = S::set1(0.0f);
+
+    V xx = S::mul(x, x), yy = S::mul(y, y), zz = S::mul(z, z);
+    V xy = S::mul(x, y), xz = S::mul(x, z), yz = S::mul(y, z);
+    V wx = S::mul(w, x), wy = S::mul(w, y), wz = S::mul(w, z);
+
+    V m[16];
+    m[0]  = S::mul(S::sub(one, S::mul(two, S::add(yy, zz))), kx);
+    m[1]  = S::mul(S::mul(two, S::add(xy, wz)), kx);
+    m[2]  = S::mul(S::mul(two, S::sub(xz, wy)), kx);
+    m[3]  = zero;
+
+    m[4]  = S::mul(S::mul(two, S::sub(xy, wz)), ky);
+    m[5]  = S::mul(S::sub(one, S::mul(two, S::add(xx, zz))), ky);
+    m[6]  = S::mul(S::mul(two, S::add(yz, wx)), ky);
+    m[7]  = zero;
+
+    m[8]  = S::mul(S::mul(two, S::add(xz, wy)), kz);
+    m[9]  = S::mul(S::mul(two, S::sub(yz, wx)), kz);
+    m[10] = S::mul(S::sub(one, S::mul(two, S::add(xx, yy))), kz);
+    m[11] = zero;
+
+    m[12] = S::load(in.position[0] + i);
+    m[13] = S::load(in.position[1] + i);
+    m[14] = S::load(in.position[2] + i);
+    m[15] = one;
+
+    S::storeMatrices(m, dst, stride);
+}
+#endif
+
+// SIMD 폭에 못 미치는 나머지와 SIMD가 없는 환경
+static void composeScalar(const TransformArrays& in, size_t i, float* m) {
+    float r[9];
+
+    if (in.quat[0]) {
+        float x = in.quat[0][i], y = in.quat[1][i], z = in.quat[2][i], w = in.quat[3][i];
+
+        r[0] = 1.0f - 2.0f * (y * y + z * z);   r[3] = 2.0f * (x * y - w * z);          r[6] = 2.0f * (x * z + w * y);
+        r[1] = 2.0f * (x * y + w * z);          r[4] = 1.0f - 2.0f * (x * x + z * z);   r[7] = 2.0f * (y * z - w * x);
+        r[2] = 2.0f * (x * z - w * y);          r[5] = 2.0f * (y * z + w * x);          r[8] = 1.0f - 2.0f * (x * x + y * y);
+    }
+    else {
+        const float toRad = 0.017453292519943295f;
+        float sx = sinf(in.euler[0][i] * toRad), cx = cosf(in.euler[0][i] * toRad);
+        float sy = sinf(in.euler[1][i] * toRad), cy = cosf(in.euler[1][i] * toRad);
+        float sz = sinf(in.euler[2][i] * toRad), cz = cosf(in.euler[2][i] * toRad);
+
+        r[0] = cy * cz;                         r[3] = -cy * sz;                        r[6] = sy;
+        r[1] = sx * sy * cz + cx * sz;          r[4] = cx * cz - sx * sy * sz;          r[7] = -sx * cy;
+        r[2] = sx * sz - cx * sy * cz;          r[5] = cx * sy * sz + sx * cz;          r[8] = cx * cy;
+    }
+
+    for (int c = 0; c < 3; c++) {
+        float k = in.scale[c][i];
+        m[4 * c]     = r[3 * c] * k;
+        m[4 * c + 1] = r[3 * c + 1] * k;
+        m[4 * c + 2] = r[3 * c + 2] * k;
+        m[4 * c + 3] = 0.0f;
+    }
+
+    m[12] = in.position[0][i];
+    m[13] = in.position[1][i];
+    m[14] = in.position[2][i];
+    m[15] = 1.0f;
+}
+
+void composeModelMatrices(const TransformArrays& in, size_t count, void* dst, size_t stride) {
+    char* out = static_cast<char*>(dst);
+    size_t i = 0;
+
+#ifdef USE_AVX2
+    for (; i + SimdAVX2::width <= count; i += SimdAVX2::width) {
+        if (in.quat[0])
+            composeQuatBlock<SimdAVX2>(in, i, out + i * stride, stride);
+        else
+            composeEulerBlock<SimdAVX2>(in, i, out + i * stride, stride);
+    }
+#endif
+#ifdef USE_SSE
+    for (; i + SimdSSE::width <= count; i += SimdSSE::width) {
+        if (in.quat[0])
+            composeQuatBlock<SimdSSE>(in, i, out + i * stride, stride);
+        else
+            composeEulerBlock<SimdSSE>(in, i, out + i * stride, stride);
+    }
+#endif
+    for (; i < count; i++)
+        composeScalar(in, i, reinterpret_cast<float*>(out + i * stride));
+}
+
+// 물체 count개의 모델 행렬을 기존 방식(glm rotate 3번 + 곱)과 composeModelMatrices로 만들어 비교.
+// 결과는 UniformBufferObject 배열(매핑된 UBO와 같은 배치)의 model 자리에 기록한다.
+void benchmarkMatrixKernel(size_t count, int iterations) {
+    std::vector<float> data[9];
+    for (std::vector<float>& col : data)
+        col.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        data[0][i] = float(i % 100);
+        data[1][i] = float(i % 37);
+        data[2][i] = float(i % 11);
+        data[3][i] = float(i % 360);
+        data[4][i] = float((i * 7) % 360);
+        data[5][i] = float((i * 13) % 360);
+        data[6][i] = 1.0f + float(i % 3);
+        data[7][i] = 1.0f;
+        data[8][i] = 0.5f;
+    }
+
+    TransformArrays in{};
+    for (int c = 0; c < 3; c++) {
+        in.position[c] = data[c].data();
+        in.euler[c] = data[3 + c].data();
+        in.scale[c] = data[6 + c].data();
+    }
+
+    std::vector<UniformBufferObject> legacy(count);
+    std::vector<UniformBufferObject> batched(count);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    for (int it = 0; it < iterations; it++) {
+        for (size_t i = 0; i < count; i++) {
+            glm::mat4 RotX = glm::rotate(glm::mat4(1.0f), glm::radians(data[3][i]), glm::vec3(1, 0, 0));
+            glm::mat4 RotY = glm::rotate(glm::mat4(1.0f), glm::radians(data[4][i]), glm::vec3(0, 1, 0));
+            glm::mat4 RotZ = glm::rotate(glm::mat4(1.0f), glm::radians(data[5][i]), glm::vec3(0, 0, 1));
+
+            legacy[i].model =   glm::translate(glm::mat4(1.0f), glm::vec3(data[0][i], data[1][i], data[2][i]))
+                                * RotX 
+                                * RotY 
+                                * RotZ 
+                                * glm::scale(glm::mat4(1.0f), glm::vec3(data[6][i], data[7][i], data[8][i]));
+        }
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    for (int it = 0; it < iterations; it++)
+        composeModelMatrices(in, count, &batched[0].model, sizeof(UniformBufferObject));
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    float maxError = 0.0f;
+    for (size_t i = 0; i < count; i++)
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < 4; r++)
+                maxError = std::max(maxError, fabsf(legacy[i].model[c][r] - batched[i].model[c][r]));
+
+    float legacyMs = std::chrono::duration<float, std::chrono::milliseconds::period>(t1 - t0).count();
+    float batchedMs = std::chrono::duration<float, std::chrono::milliseconds::period>(t2 - t1).count();
+
+#if defined(USE_AVX2)
+    const char* path = "AVX2";
+#elif defined(USE_SSE)
+    const char* path = "SSE";
+#else
+    const char* path = "scalar";
+#endif
+
+    std::cout << "[MatrixKernel] " << count << " objects x " << iterations << " frames (" << path << ")" << std::endl;
+    std::cout << "  glm per object : " << legacyMs << " ms" << std::endl;
+    std::cout << "  batched        : " << batchedMs << " ms (x" << legacyMs / batchedMs << ")" << std::endl;
+    std::cout << "  max error      : " << maxError << std::endl;
+}
+
+///////////////////////////////////////////////////
+/////////////////   BODY STORE   //////////////////
+///////////////////////////////////////////////////
+
+BodyHandle BodyStore::create(glm::vec3 pos, glm::quat rot, glm::vec3 scale, Transform* transform) {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        slot = static_cast<uint32_t>(slots.size());
+        slots.push_back({ UINT32_MAX, 0 });
+    }
+
+    uint32_t d = static_cast<uint32_t>(size());
+
+    for (std::vector<float>& col : columns)
+        col.push_back(0.0f);
+    dirty.push_back(DIRTY_ALL);
+    transforms.push_back(transform);
+    colliders.push_back(nullptr);
+    denseToSlot.push_back(slot);
+
+    slots[slot].dense = d;
+    if (transform)
+        transformBodies[transform] = d;
+
+    set(d, POSITION, pos);
+    setRotation(d, rot);
+    set(d, SCALE, scale);
+
+    return { slot, slots[slot].generation };
+}
+
+void BodyStore::destroy(BodyHandle handle) {
+    if (!alive(handle))
+        return;
+
+    uint32_t d = slots[handle.index].dense;
+    uint32_t last = static_cast<uint32_t>(size() - 1);
+
+    if (transforms[d])
+        transformBodies.erase(transforms[d]);
+
+    // 마지막 원소를 빈 자리로 옮긴다
+    if (d != last) {
+        for (std::vector<float>& col : columns)
+            col[d] = col[last];
+        dirty[d] = dirty[last];
+        transforms[d] = transforms[last];
+        colliders[d] = colliders[last];
+        denseToSlot[d] = denseToSlot[last];
+
+        slots[denseToSlot[d]].dense = d;
+        if (transforms[d])
+            transformBodies[transforms[d]] = d;
+    }
+
+    for (std::vector<float>& col : columns)
+        col.pop_back();
+    dirty.pop_back();
+    transforms.pop_back();
+    colliders.pop_back();
+    denseToSlot.pop_back();
+
+    slots[handle.index].dense = UINT32_MAX;
+    slots[handle.index].generation++;
+    freeSlots.push_back(handle.index);
+
+    // dense 순서가 바뀌었으니 다음 captureState에서 보간 상태를 새로 잡는다
+    interpolating.clear();
+}
+
+// 한 성분에 대해 v += a * dt, p += v * dt
+static void integrateColumn(float* p, float* v, const float* a, float dt, size_t n) {
+    size_t i = 0;
+#ifdef USE_SSE
+    __m128 vdt = _mm_set1_ps(dt);
+    for (; i + 4 <= n; i += 4) {
+        __m128 vv = _mm_add_ps(_mm_loadu_ps(v + i), _mm_mul_ps(_mm_loadu_ps(a + i), vdt));
+        __m128 vp = _mm_add_ps(_mm_loadu_ps(p + i), _mm_mul_ps(vv, vdt));
+
+        _mm_storeu_ps(v + i, vv);
+        _mm_storeu_ps(p + i, vp);
+    }
+#endif
+    for (; i < n; i++) {
+        v[i] += a[i] * dt;
+        p[i] += v[i] * dt;
+    }
+}
+
+// v += a * dt
+static void accumulateColumn(float* v, const float* a, float dt, size_t n) {
+    size_t i = 0;
+#ifdef USE_SSE
+    __m128 vdt = _mm_set1_ps(dt);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(v + i, _mm_add_ps(_mm_loadu_ps(v + i), _mm_mul_ps(_mm_loadu_ps(a + i), vdt)));
+#endif
+    for (; i < n; i++)
+        v[i] += a[i] * dt;
+}
+
+// q += 0.5 * dt * q * (w, 0) 후 정규화. w는 로컬 축 각속도 (도/초)
+static void integrateRotation(float* q[4], float* const w[3], float dt, size_t n) {
+    const float h = 0.5f * dt * 0.017453292519943295f;
+    size_t i = 0;
+#ifdef USE_SSE
+    __m128 vh = _mm_set1_ps(h);
+    __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(w[0] + i), vh);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(w[1] + i), vh);
+        __m128 c = _mm_mul_ps(_mm_loadu_ps(w[2] + i), vh);
+
+        __m128 x = _mm_loadu_ps(q[0] + i);
+        __m128 y = _mm_loadu_ps(q[1] + i);
+        __m128 z = _mm_loadu_ps(q[2] + i);
+        __m128 s = _mm_loadu_ps(q[3] + i);
+
+        __m128 nx = _mm_add_ps(x, _mm_sub_ps(_mm_add_ps(_mm_mul_ps(s, a), _mm_mul_ps(y, c)), _mm_mul_ps(z, b)));
+        __m128 ny = _mm_add_ps(y, _mm_sub_ps(_mm_add_ps(_mm_mul_ps(s, b), _mm_mul_ps(z, a)), _mm_mul_ps(x, c)));
+        __m128 nz = _mm_add_ps(z, _mm_sub_ps(_mm_add_ps(_mm_mul_ps(s, c), _mm_mul_ps(x, b)), _mm_mul_ps(y, a)));
+        __m128 ns = _mm_sub_ps(s, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, a), _mm_mul_ps(y, b)), _mm_mul_ps(z, c)));
+
+        __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_add_ps(_mm_mul_ps(nz, nz), _mm_mul_ps(ns, ns)));
+        __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(len2));
+
+        _mm_storeu_ps(q[0] + i, _mm_mul_ps(nx, inv));
+        _mm_storeu_ps(q[1] + i, _mm_mul_ps(ny, inv));
+        _mm_storeu_ps(q[2] + i, _mm_mul_ps(nz, inv));
+        _mm_storeu_ps(q[3] + i, _mm_mul_ps(ns, inv));
+    }
+#endif
+    for (; i < n; i++) {
+        float a = w[0][i] * h, b = w[1][i] * h, c = w[2][i] * h;
+        float x = q[0][i], y = q[1][i], z = q[2][i], s = q[3][i];
+
+        float nx = x + (s * a + y * c - z * b);
+        float ny = y + (s * b + z * a - x * c);
+        float nz = z + (s * c + x * b - y * a);
+        float ns = s - (x * a + y * b + z * c);
+
+        float inv = 1.0f / sqrtf(nx * nx + ny * ny + nz * nz + ns * ns);
+        q[0][i] = nx * inv;
+        q[1][i] = ny * inv;
+        q[2][i] = nz * inv;
+        q[3][i] = ns * inv;
+    }
+}
+
+void BodyStore::integrate(float dt) {
+    size_t n = size();
+
+    for (int c = 0; c < 3; c++)
+        stepStart[c].assign(columns[POSITION + c].begin(), columns[POSITION + c].begin() + n);
+
+    if (n == 0)
+        return;
+
+    for (int c = 0; c < 3; c++) {
+        integrateColumn(columns[POSITION + c].data(), columns[VELOCITY + c].data(), columns[ACCEL + c].data(), dt, n);
+        accumulateColumn(columns[TORQUE + c].data(), columns[ACCEL_TORQUE + c].data(), dt, n);
+    }
+
+    float* q[4] = { columns[ROTATION].data(), columns[ROTATION + 1].data(), columns[ROTATION + 2].data(), columns[ROTATION + 3].data() };
+    float* const w[3] = { columns[TORQUE].data(), columns[TORQUE + 1].data(), columns[TORQUE + 2].data() };
+    integrateRotation(q, w, dt, n);
+
+    // 속도나 토크가 남아 있는 body만 dirty (정지한 물체는 동기화하지 않음)
+    const float* motion[6] = {
+        columns[VELOCITY].data(), columns[VELOCITY + 1].data(), columns[VELOCITY + 2].data(),
+        columns[TORQUE].data(), columns[TORQUE + 1].data(), columns[TORQUE + 2].data()
+    };
+
+    size_t i = 0;
+#ifdef USE_SSE
+    __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 moving = _mm_setzero_ps();
+        for (int k = 0; k < 6; k++)
+            moving = _mm_or_ps(moving, _mm_cmpneq_ps(_mm_loadu_ps(motion[k] + i), zero));
+
+        int mask = _mm_movemask_ps(moving);
+        for (int k = 0; mask && k < 4; k++)
+            if (mask & (1 << k))
+                dirty[i + k] = DIRTY_ALL;
+    }
+#endif
+    for (; i < n; i++) {
+        for (int k = 0; k < 6; k++) {
+            if (motion[k][i] != 0.0f) {
+                dirty[i] = DIRTY_ALL;
+                break;
+            }
+        }
+    }
+}
+
+void BodyStore::syncTransforms() {
+    size_t n = size();
+    localMatrices.resize(n);
+
+    size_t d = 0;
+    while (d < n) {
+        if (!dirty[d]) {
+            d++;
+            continue;
+        }
+
+        // 연속한 dirty 구간을 한 번에 계산
+        size_t begin = d;
+        while (d < n && dirty[d])
+            d++;
+
+        composeModelMatrices(arrays(begin), d - begin, &localMatrices[begin], sizeof(glm::mat4));
+
+        for (size_t i = begin; i < d; i++) {
+            dirty[i] = 0;
+
+            glm::vec3 pos = get(i, POSITION);
+            glm::quat rot = getRotation(i);
+
+            if (transforms[i])
+                transforms[i]->setLocal(pos, rot, get(i, SCALE), localMatrices[i]);
+
+            if (colliders[i])
+                placeCollider(colliders[i], transforms[i], pos, rot);
+        }
+    }
+}
+
+void BodyStore::syncColliders() {
+    size_t n = size();
+
+    for (size_t d = 0; d < n; d++) {
+        if (!(dirty[d] & DIRTY_COLLIDER))
+            continue;
+
+        dirty[d] &= ~DIRTY_COLLIDER;
+
+        if (colliders[d])
+            placeCollider(colliders[d], transforms[d], get(d, POSITION), getRotation(d));
+    }
+}
+
+void BodyStore::captureState() {
+    size_t n = size();
+    // 처음이거나 destroy 이후에는 prev = curr 로 시작
+    bool reseed = interpolating.size() != n;
+
+    for (int c = 0; c < STATE_COUNT; c++) {
+        std::swap(prevState[c], currState[c]);
+        currState[c].assign(columns[c].begin(), columns[c].begin() + n);
+
+        if (reseed)
+            prevState[c] = currState[c];
+    }
+
+    interpolating.resize(n, 0);
+    for (size_t d = 0; d < n; d++) {
+        bool moved = false;
+        for (int c = 0; c < STATE_COUNT && !moved; c++)
+            moved = prevState[c][d] != currState[c][d];
+
+        if (moved || reseed)
+            interpolating[d] = 2;
+        else if (interpolating[d])
+            interpolating[d]--;
+
+        // Transform은 보간 경로가 맡는다
+        dirty[d] &= ~DIRTY_TRANSFORM;
+    }
+}
+
+void BodyStore::syncInterpolated(float alpha) {
+    size_t n = size();
+    size_t captured = std::min(interpolating.size(), n);
+    localMatrices.resize(n);
+
+    for (std::vector<float>& col : blendedState)
+        col.resize(n);
+
+    for (size_t d = 0; d < captured; d++) {
+        if (!interpolating[d])
+            continue;
+
+        for (int c = POSITION; c < POSITION + 3; c++)
+            blendedState[c][d] = prevState[c][d] + (currState[c][d] - prevState[c][d]) * alpha;
+        for (int c = SCALE; c < SCALE + 3; c++)
+            blendedState[c][d] = prevState[c][d] + (currState[c][d] - prevState[c][d]) * alpha;
+
+        // nlerp : 짧은 쪽으로 돌도록 부호를 맞춘 뒤 정규화
+        float cosTheta = 0.0f;
+        for (int c = ROTATION; c < ROTATION + 4; c++)
+            cosTheta += prevState[c][d] * currState[c][d];
+        float sign = cosTheta < 0.0f ? -1.0f : 1.0f;
+
+        float len = 0.0f;
+        for (int c = ROTATION; c < ROTATION + 4; c++) {
+            float q = prevState[c][d] + (sign * currState[c][d] - prevState[c][d]) * alpha;
+            blendedState[c][d] = q;
+            len += q * q;
+        }
+
+        float invLen = 1.0f / sqrtf(len);
+        for (int c = ROTATION; c < ROTATION + 4; c++)
+            blendedState[c][d] *= invLen;
+    }
+
+    size_t d = 0;
+    while (d < captured) {
+        if (!interpolating[d]) {
+            d++;
+            continue;
+        }
+
+        size_t begin = d;
+        while (d < captured && interpolating[d])
+            d++;
+
+        composeModelMatrices(arraysOf(blendedState, begin), d - begin, &localMatrices[begin], sizeof(glm::mat4));
+
+        for (size_t i = begin; i < d; i++) {
+            if (!transforms[i])
+                continue;
+
+            glm::vec3 pos(blendedState[POSITION][i], blendedState[POSITION + 1][i], blendedState[POSITION + 2][i]);
+            glm::quat rot(blendedState[ROTATION + 3][i], blendedState[ROTATION][i], blendedState[ROTATION + 1][i], blendedState[ROTATION + 2][i]);
+            glm::vec3 scale(blendedState[SCALE][i], blendedState[SCALE + 1][i], blendedState[SCALE + 2][i]);
+
+            transforms[i]->setLocal(pos, rot, scale, localMatrices[i]);
+        }
+    }
+
+    // 아직 캡처되지 않은 body는 현재 값 그대로
+    if (captured < n) {
+        composeModelMatrices(arrays(captured), n - captured, &localMatrices[captured], sizeof(glm::mat4));
+
+        for (size_t i = captured; i < n; i++)
+            if (transforms[i])
+                transforms[i]->setLocal(get(i, POSITION), getRotation(i), get(i, SCALE), localMatrices[i]);
+    }
+}
+
+glm::mat4 BodyStore::computeWorldMatrix(const Transform* transform) {
+    glm::mat4 world(1.0f);
+
+    // 자기부터 루트까지 올라가며 로컬 행렬을 앞에 곱한다
+    for (const Transform* t = transform; t; t = t->getParent()) {
+        auto it = transformBodies.find(t);
+        if (it == transformBodies.end()) {
+            world = t->computeLocalMatrix() * world;
+            continue;
+        }
+
+        uint32_t d = it->second;
+        world = glm::translate(glm::mat4(1.0f), get(d, POSITION))
+                * glm::mat4_cast(getRotation(d))
+                * glm::scale(glm::mat4(1.0f), get(d, SCALE))
+                * world;
+    }
+
+    return world;
+}
+
+glm::quat BodyStore::computeWorldRotation(const Transform* transform) {
+    glm::quat world(1.0f, 0.0f, 0.0f, 0.0f);
+
+    for (const Transform* t = transform; t; t = t->getParent()) {
+        auto it = transformBodies.find(t);
+        world = (it == transformBodies.end() ? t->getRotation() : getRotation(it->second)) * world;
+    }
+
+    return world;
+}
+
+// 기존 GameObject 배치 : 힙에 하나씩 할당되고 Vulkan 핸들, 문자열, 모델 목록 사이에 물리 값이 끼어 있음
+struct LegacyBody {
+    void* handles[5];
+    std::vector<void*> models;
+    uint32_t index;
+    std::string name;
+
+    glm::vec3 position;
+    glm::vec3 rotation;
+    glm::vec3 scale;
+
+    void* collider;
+
+    glm::vec3 velo;
+    glm::vec3 accel;
+    glm::vec3 torque;
+    glm::vec3 accelTorque;
+};
+
+// count개의 물체를 iterations 번 적분해서 기존 배치와 BodyStore를 비교
+void benchmarkBodyStore(size_t count, int iterations) {
+    const float dt = 1.0f / 60.0f;
+
+    std::vector<LegacyBody*> legacy(count);
+    BodyStore store;
+
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 pos(float(i % 100), float(i % 37), float(i % 11));
+        glm::vec3 vel(float(i % 7) - 3.0f, 1.0f, float(i % 5) - 2.0f);
+        glm::vec3 acc(0.0f, -9.8f, 0.0f);
+
+        legacy[i] = new LegacyBody();
+        legacy[i]->name = "body";
+        legacy[i]->position = pos;
+        legacy[i]->rotation = glm::vec3(0.0f);
+        legacy[i]->scale = glm::vec3(1.0f);
+        legacy[i]->velo = vel;
+        legacy[i]->accel = acc;
+        legacy[i]->torque = vel;
+        legacy[i]->accelTorque = glm::vec3(0.0f);
+
+        BodyHandle h = store.create(pos, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f));
+        store.set(h, BodyStore::VELOCITY, vel);
+        store.set(h, BodyStore::ACCEL, acc);
+        store.set(h, BodyStore::TORQUE, vel);
+    }
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    for (int it = 0; it < iterations; it++) {
+        for (LegacyBody* b : legacy) {
+            b->velo += b->accel * dt;
+            b->position += b->velo * dt;
+            b->torque += b->accelTorque * dt;
+            b->rotation += b->torque * dt;
+        }
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    for (int it = 0; it < iterations; it++)
+        store.integrate(dt);
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    // 두 결과가 같은지 확인 (최적화로 루프가 사라지는 것도 방지)
+    float legacySum = 0.0f, storeSum = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        legacySum += legacy[i]->position.y;
+        storeSum += store.columns[BodyStore::POSITION + 1][i];
+    }
+
+    float legacyMs = std::chrono::duration<float, std::chrono::milliseconds::period>(t1 - t0).count();
+    float storeMs = std::chrono::duration<float, std::chrono::milliseconds::period>(t2 - t1).count();
+
+    std::cout << "[BodyStore] " << count << " bodies x " << iterations << " steps" << std::endl;
+    std::cout << "  legacy AoS : " << legacyMs << " ms" << std::endl;
+    std::cout << "  SoA        : " << storeMs << " ms (x" << legacyMs / storeMs << ")" << std::endl;
+    std::cout << "  checksum   : " << legacySum << " / " << storeSum << std::endl;
+
+    for (LegacyBody* b : legacy)
+        delete(b);
+}
+
+///////////////////////////////////////////////////
+//////////////   PHYSICS SCHEDULER   //////////////
+///////////////////////////////////////////////////
+
+static int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void PhysicsScheduler::start(std::function<void()> step) {
+    if (running)
+        stop();
+
+    this->step = step;
+    accumulator = 0.0f;
+    stepCount = 0;
+    lastAdvanceNs = steadyNowNs();
+
+    // 첫 step 전에도 보간할 상태가 있도록
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bodyStore.captureState();
+    }
+
+    running = true;
+    if (threaded)
+        worker = std::thread(&PhysicsScheduler::threadLoop, this);
+}
+
+void PhysicsScheduler::stop() {
+    running = false;
+    if (worker.joinable())
+        worker.join();
+}
+
+void PhysicsScheduler::advance(float frameTime) {
+    if (!running || threaded)
+        return;
+
+    runSteps(frameTime);
+}
+
+float PhysicsScheduler::getAlpha() {
+    float pending = accumulator;
+
+    // worker가 자는 동안 흐른 시간까지 더한다
+    if (threaded)
+        pending += float(steadyNowNs() - lastAdvanceNs) * 1e-9f;
+
+    return std::min(std::max(pending / getStep(), 0.0f), 1.0f);
+}
+
+void PhysicsScheduler::runSteps(float frameTime) {
+    float dt = getStep();
+    float acc = accumulator + frameTime;
+    int steps = 0;
+
+    while (acc >= dt && steps < maxSubSteps) {
+        {
+            PROFILE_ZONE("physics/step");
+
+            std::lock_guard<std::mutex> lock(mutex);
+            step();
+            bodyStore.captureState();
+        }
+
+        acc -= dt;
+        steps++;
+        stepCount++;
+    }
+
+    // 따라잡지 못한 시간은 버려서 step이 계속 밀리는 것을 막는다
+    if (acc >= dt)
+        acc = fmodf(acc, dt);
+
+    accumulator = acc;
+    lastAdvanceNs = steadyNowNs();
+}
+
+void PhysicsScheduler::threadLoop() {
+    PROFILE_THREAD("physics");
+
+    int64_t previous = steadyNowNs();
+
+    while (running) {
+        int64_t now = steadyNowNs();
+        runSteps(float(now - previous) * 1e-9f);
+        previous = now;
+
+        // 다음 step 시각까지 대기
+        float wait = getStep() - accumulator;
+        if (wait > 0.0f)
+            std::this_thread::sleep_for(std::chrono::duration<float>(wait));
+    }
+}
+
+///////////////////////////////////////////////////
+////////////////   NARROW PHASE   /////////////////
+///////////////////////////////////////////////////
+
+// 축 번호 : 0 ~ 2 a의 면, 3 ~ 5 b의 면, 6 + 3 * i + j 는 a.axes[i] x b.axes[j]
+// 침투가 비슷하면 a의 면 > b의 면 > 모서리 순으로 골라 접촉 기준이 프레임마다 뒤집히지 않게 한다.
+static const float satFaceBWeight = 1.0f / 0.98f;
+static const float satEdgeWeight = 1.0f / 0.95f;
+// 평행한 두 축의 외적이 0이 되어 생기는 오판 방지
+static const float satParallelEpsilon = 1e-5f;
+// 외적 축 길이가 이보다 짧으면 면 축이 이미 같은 방향을 검사한다
+static const float satMinEdgeLength = 1e-3f;
+
+static bool satScalar(const OBB& a, const OBB& b, int& axis, float& depth) {
+    glm::vec3 d = b.center - a.center;
+    float R[3][3], AbsR[3][3], t[3];
+
+    for (int i = 0; i < 3; i++) {
+        t[i] = glm::dot(d, a.axes[i]);
+        for (int j = 0; j < 3; j++) {
+            R[i][j] = glm::dot(a.axes[i], b.axes[j]);
+            AbsR[i][j] = fabsf(R[i][j]) + satParallelEpsilon;
+        }
+    }
+
+    float best = FLT_MAX;
+    axis = -1;
+    depth = 0.0f;
+
+    for (int i = 0; i < 3; i++) {
+        float ra = a.half[i];
+        float rb = b.half[0] * AbsR[i][0] + b.half[1] * AbsR[i][1] + b.half[2] * AbsR[i][2];
+        float pen = ra + rb - fabsf(t[i]);
+        if (pen < 0.0f)
+            return false;
+
+        if (pen < best) {
+            best = pen;
+            axis = i;
+            depth = pen;
+        }
+    }
+
+    for (int j = 0; j < 3; j++) {
+        float ra = a.half[0] * AbsR[0][j] + a.half[1] * AbsR[1][j] + a.half[2] * AbsR[2][j];
+        float rb = b.half[j];
+        float pen = ra + rb - fabsf(t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j]);
+        if (pen < 0.0f)
+            return false;
+
+        if (pen * satFaceBWeight < best) {
+            best = pen * satFaceBWeight;
+            axis = 3 + j;
+            depth = pen;
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+
+        for (int j = 0; j < 3; j++) {
+            int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+
+            float ra = a.half[i1] * AbsR[i2][j] + a.half[i2] * AbsR[i1][j];
+            float rb = b.half[j1] * AbsR[i][j2] + b.half[j2] * AbsR[i][j1];
+            float pen = ra + rb - fabsf(t[i2] * R[i1][j] - t[i1] * R[i2][j]);
+            if (pen < 0.0f)
+                return false;
+
+            // 축 길이로 나눠야 면 축과 같은 단위의 침투 깊이가 된다 (a 좌표계에서 외적의 두 성분)
+            float len = sqrtf(R[i1][j] * R[i1][j] + R[i2][j] * R[i2][j]);
+            if (len < satMinEdgeLength)
+                continue;
+
+            pen /= len;
+            if (pen * satEdgeWeight < best) {
+                best = pen * satEdgeWeight;
+                axis = 6 + 3 * i + j;
+                depth = pen;
+            }
+        }
+    }
+
+    return true;
+}
+
+// dot(p, n) <= offset 인 쪽만 남긴다 (Sutherland-Hodgman)
+static int clipPolygon(const glm::vec3* in, int count, glm::vec3 n, float offset, glm::vec3* out) {
+    int res = 0;
+
+    for (int k = 0; k < count; k++) {
+        glm::vec3 p = in[k];
+        glm::vec3 q = in[(k + 1) % count];
+        float dp = glm::dot(p, n) - offset;
+        float dq = glm::dot(q, n) - offset;
+
+        if (dp <= 0.0f)
+            out[res++] = p;
+        if ((dp < 0.0f) != (dq < 0.0f) && dp != dq)
+            out[res++] = p + (q - p) * (dp / (dp - dq));
+    }
+
+    return res;
+}
+
+// 가장 깊은 점, 그 점에서 가장 먼 점, 그 선분 양쪽으로 가장 넓은 삼각형을 만드는 점
+static int reduceContacts(const glm::vec3* points, const float* seps, int count, glm::vec3 normal, glm::vec3* out) {
+    if (count <= 4) {
+        for (int k = 0; k < count; k++)
+            out[k] = points[k];
+        return count;
+    }
+
+    int picked[4] = { 0, -1, -1, -1 };
+    for (int k = 1; k < count; k++)
+        if (seps[k] < seps[picked[0]])
+            picked[0] = k;
+
+    float farthest = -1.0f;
+    for (int k = 0; k < count; k++) {
+        glm::vec3 e = points[k] - points[picked[0]];
+        if (glm::dot(e, e) > farthest) {
+            farthest = glm::dot(e, e);
+            picked[1] = k;
+        }
+    }
+
+    glm::vec3 edge = points[picked[1]] - points[picked[0]];
+    float maxArea = 0.0f, minArea = 0.0f;
+    for (int k = 0; k < count; k++) {
+        float area = glm::dot(glm::cross(edge, points[k] - points[picked[0]]), normal);
+        if (area > maxArea) {
+            maxArea = area;
+            picked[2] = k;
+        }
+        if (area < minArea) {
+            minArea = area;
+            picked[3] = k;
+        }
+    }
+
+    int res = 0;
+    for (int k : picked)
+        if (k != -1)
+            out[res++] = points[k];
+    return res;
+}
+
+static void buildContacts(const OBB& a, const OBB& b, int axis, float depth, ContactManifold& m) {
+    m.depth = depth;
+    m.pointCount = 0;
+
+    if (axis >= 6) {
+        int i = (axis - 6) / 3, j = (axis - 6) % 3;
+
+        glm::vec3 n = glm::normalize(glm::cross(a.axes[i], b.axes[j]));
+        if (glm::dot(n, b.center - a.center) < 0.0f)
+            n = -n;
+        m.normal = n;
+
+        // a에서 n 쪽으로 가장 나온 모서리, b에서 -n 쪽으로 가장 나온 모서리
+        glm::vec3 pa = a.center, pb = b.center;
+        for (int c = 0; c < 3; c++) {
+            if (c != i)
+                pa += a.axes[c] * (glm::dot(a.axes[c], n) > 0.0f ? a.half[c] : -a.half[c]);
+            if (c != j)
+                pb += b.axes[c] * (glm::dot(b.axes[c], n) > 0.0f ? -b.half[c] : b.half[c]);
+        }
+
+        // 두 선분의 최근접점 (방향은 단위 벡터)
+        glm::vec3 ua = a.axes[i], ub = b.axes[j], r = pa - pb;
+        float k = glm::dot(ua, ub), c = glm::dot(ua, r), f = glm::dot(ub, r);
+        float s = glm::clamp((k * f - c) / (1.0f - k * k), -a.half[i], a.half[i]);
+        float u = k * s + f;
+
+        if (u < -b.half[j] || u > b.half[j]) {
+            u = glm::clamp(u, -b.half[j], b.half[j]);
+            s = glm::clamp(k * u - c, -a.half[i], a.half[i]);
+        }
+
+        m.points[0] = ((pa + ua * s) + (pb + ub * u)) * 0.5f;
+        m.pointCount = 1;
+        return;
+    }
+
+    // 기준 면을 가진 박스(ref)와 그 면에 닿는 박스(inc)
+    bool flip = axis >= 3;
+    const OBB& ref = flip ? b : a;
+    const OBB& inc = flip ? a : b;
+    int r = axis % 3, r1 = (r + 1) % 3, r2 = (r + 2) % 3;
+
+    glm::vec3 refNormal = ref.axes[r];
+    if (glm::dot(refNormal, inc.center - ref.center) < 0.0f)
+        refNormal = -refNormal;
+    m.normal = flip ? -refNormal : refNormal;
+
+    // inc에서 refNormal과 가장 반대를 향하는 면
+    int k = 0;
+    float kd = glm::dot(inc.axes[0], refNormal);
+    for (int c = 1; c < 3; c++) {
+        float cd = glm::dot(inc.axes[c], refNormal);
+        if (fabsf(cd) > fabsf(kd)) {
+            k = c;
+            kd = cd;
+        }
+    }
+
+    glm::vec3 incCenter = inc.center + inc.axes[k] * (kd > 0.0f ? -inc.half[k] : inc.half[k]);
+    glm::vec3 e1 = inc.axes[(k + 1) % 3] * inc.half[(k + 1) % 3];
+    glm::vec3 e2 = inc.axes[(k + 2) % 3] * inc.half[(k + 2) % 3];
+
+    glm::vec3 poly[8] = { incCenter + e1 + e2, incCenter - e1 + e2, incCenter - e1 - e2, incCenter + e1 - e2 };
+    glm::vec3 clipped[8];
+    int count = 4;
+
+    // 기준 면의 옆 네 평면으로 자른다
+    const int sides[2] = { r1, r2 };
+    for (int side : sides) {
+        glm::vec3 n = ref.axes[side];
+        float centerDist = glm::dot(ref.center, n);
+
+        count = clipPolygon(poly, count, n, centerDist + ref.half[side], clipped);
+        count = clipPolygon(clipped, count, -n, -centerDist + ref.half[side], poly);
+    }
+
+    // 기준 면 아래로 들어온 점만 두 면 사이 가운데로 옮겨 쓴다
+    glm::vec3 refFace = ref.center + refNormal * ref.half[r];
+    glm::vec3 inside[8];
+    float seps[8];
+    int insideCount = 0;
+
+    for (int c = 0; c < count; c++) {
+        float sep = glm::dot(poly[c] - refFace, refNormal);
+        if (sep <= 0.0f) {
+            inside[insideCount] = poly[c] - refNormal * (sep * 0.5f);
+            seps[insideCount++] = sep;
+        }
+    }
+
+    if (insideCount == 0) {
+        m.points[0] = incCenter;
+        m.pointCount = 1;
+        return;
+    }
+
+    m.pointCount = reduceContacts(inside, seps, insideCount, refNormal, m.points);
+}
+
+bool collideOBB(const OBB& a, const OBB& b, ContactManifold* contact) {
+    int axis;
+    float depth;
+
+    if (!satScalar(a, b, axis, depth))
+        return false;
+
+    if (contact)
+        buildContacts(a, b, axis, depth, *contact);
+    return true;
+}
+
+#ifdef USE_SSE
+// 성분 하나당 lane 폭만큼 연속 (center 3, axes 9, half 3)
+static void gatherOBB(const OBB& o, float* dst, int lane, int width) {
+    for (int c = 0; c < 3; c++) {
+        dst[c * width + lane] = o.center[c];
+        dst[(12 + c) * width + lane] = o.half[c];
+        for (int r = 0; r < 3; r++)
+            dst[(3 + 3 * c + r) * width + lane] = o.axes[c][r];
+    }
+}
+
+// satScalar와 같은 축 순서. 분리 여부는 모든 축의 OR, 최소 점수 축은 select로 분기 없이 고른다.
+template <typename S>
+static void satKeep(typename S::V pen, typename S::V score, float id,
+                    typename S::V& separated, typename S::V& best, typename S::V& axis, typename S::V& depth) {
+    typedef typename S::V V;
+
+    separated = S::bitOr(separated, S::cmpLt(pen, S::set1(0.0f)));
+
+    V better = S::cmpLt(score, best);
+    best = S::select(better, score, best);
+    axis = S::select(better, S::set1(id), axis);
+    depth = S::select(better, pen, depth);
+}
+
+template <typename S>
+static void satBlock(const OBB* a, const OBB* b, size_t i, uint8_t* hits, ContactManifold* contacts) {
+    typedef typename S::V V;
+    enum { W = S::width };
+
+    alignas(32) float la[15 * W], lb[15 * W];
+    for (int k = 0; k < W; k++) {
+        gatherOBB(a[i + k], la, k, W);
+        gatherOBB(b[i + k], lb, k, W);
+    }
+
+    V aa[3][3], bb[3][3], ah[3], bh[3], d[3];
+    for (int c = 0; c < 3; c++) {
+        d[c] = S::sub(S::load(lb + c * W), S::load(la + c * W));
+        ah[c] = S::load(la + (12 + c) * W);
+        bh[c] = S::load(lb + (12 + c) * W);
+        for (int r = 0; r < 3; r++) {
+            aa[c][r] = S::load(la + (3 + 3 * c + r) * W);
+            bb[c][r] = S::load(lb + (3 + 3 * c + r) * W);
+        }
+    }
+
+    V eps = S::set1(satParallelEpsilon);
+    V t[3], R[3][3], AbsR[3][3];
+    for (int p = 0; p < 3; p++) {
+        t[p] = S::add(S::add(S::mul(d[0], aa[p][0]), S::mul(d[1], aa[p][1])), S::mul(d[2], aa[p][2]));
+        for (int q = 0; q < 3; q++) {
+            R[p][q] = S::add(S::add(S::mul(aa[p][0], bb[q][0]), S::mul(aa[p][1], bb[q][1])), S::mul(aa[p][2], bb[q][2]));
+            AbsR[p][q] = S::add(S::abs(R[p][q]), eps);
+        }
+    }
+
+    V separated = S::set1(0.0f);
+    V best = S::set1(FLT_MAX);
+    V axis = S::set1(-1.0f);
+    V depth = S::set1(0.0f);
+
+    for (int p = 0; p < 3; p++) {
+        V rb = S::add(S::add(S::mul(bh[0], AbsR[p][0]), S::mul(bh[1], AbsR[p][1])), S::mul(bh[2], AbsR[p][2]));
+        V pen = S::sub(S::add(ah[p], rb), S::abs(t[p]));
+        satKeep<S>(pen, pen, float(p), separated, best, axis, depth);
+    }
+
+    V faceB = S::set1(satFaceBWeight);
+    for (int q = 0; q < 3; q++) {
+        V ra = S::add(S::add(S::mul(ah[0], AbsR[0][q]), S::mul(ah[1], AbsR[1][q])), S::mul(ah[2], AbsR[2][q]));
+        V dist = S::add(S::add(S::mul(t[0], R[0][q]), S::mul(t[1], R[1][q])), S::mul(t[2], R[2][q]));
+        V pen = S::sub(S::add(ra, bh[q]), S::abs(dist));
+        satKeep<S>(pen, S::mul(pen, faceB), float(3 + q), separated, best, axis, depth);
+    }
+
+    V edgeW = S::set1(satEdgeWeight);
+    V minLen = S::set1(satMinEdgeLength);
+    V never = S::set1(FLT_MAX);
+
+    for (int p = 0; p < 3; p++) {
+        int p1 = (p + 1) % 3, p2 = (p + 2) % 3;
+
+        for (int q = 0; q < 3; q++) {
+            int q1 = (q + 1) % 3, q2 = (q + 2) % 3;
+
+            V ra = S::add(S::mul(ah[p1], AbsR[p2][q]), S::mul(ah[p2], AbsR[p1][q]));
+            V rb = S::add(S::mul(bh[q1], AbsR[p][q2]), S::mul(bh[q2], AbsR[p][q1]));
+            V dist = S::sub(S::mul(t[p2], R[p1][q]), S::mul(t[p1], R[p2][q]));
+            V pen = S::sub(S::add(ra, rb), S::abs(dist));
+
+            separated = S::bitOr(separated, S::cmpLt(pen, S::set1(0.0f)));
+
+            V len = S::sqrt(S::add(S::mul(R[p1][q], R[p1][q]), S::mul(R[p2][q], R[p2][q])));
+            V penN = S::div(pen, S::max(len, minLen));
+            V score = S::select(S::cmpLt(len, minLen), never, S::mul(penN, edgeW));
+
+            V better = S::cmpLt(score, best);
+            best = S::select(better, score, best);
+            axis = S::select(better, S::set1(float(6 + 3 * p + q)), axis);
+            depth = S::select(better, penN, depth);
+        }
+    }
+
+    int separatedMask = S::moveMask(separated);
+    alignas(32) float axisOut[W], depthOut[W];
+    S::store(axisOut, axis);
+    S::store(depthOut, depth);
+
+    for (int k = 0; k < W; k++) {
+        hits[i + k] = ((separatedMask >> k) & 1) ? 0 : 1;
+        if (hits[i + k] && contacts)
+            buildContacts(a[i + k], b[i + k], int(axisOut[k]), depthOut[k], contacts[i + k]);
+    }
+}
+#endif
+
+void collideOBBBatch(const OBB* a, const OBB* b, size_t count, uint8_t* hits, ContactManifold* contacts) {
+    size_t i = 0;
+
+#ifdef USE_AVX2
+    for (; i + SimdAVX2::width <= count; i += SimdAVX2::width)
+        satBlock<SimdAVX2>(a, b, i, hits, contacts);
+#endif
+#ifdef USE_SSE
+    for (; i + SimdSSE::width <= count; i += SimdSSE::width)
+        satBlock<SimdSSE>(a, b, i, hits, contacts);
+#endif
+    for (; i < count; i++)
+        hits[i] = collideOBB(a[i], b[i], contacts ? &contacts[i] : nullptr);
+}
+
+// 정지한 b를 향해 a를 motion만큼 평행이동할 때 분리축 15개 각각의 겹침 구간 [진입, 이탈]을 구하고
+// 모든 축에서 겹치는 첫 시점을 찾는다 (회전 없는 이동이면 정확).
+bool sweepOBB(const OBB& a, glm::vec3 motion, const OBB& b, float& toi, glm::vec3& normal) {
+    glm::vec3 axes[15];
+    int axisCount = 0;
+
+    for (int i = 0; i < 3; i++) {
+        axes[axisCount++] = a.axes[i];
+        axes[axisCount++] = b.axes[i];
+    }
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            glm::vec3 l = glm::cross(a.axes[i], b.axes[j]);
+            float len = glm::length(l);
+            if (len >= satMinEdgeLength)
+                axes[axisCount++] = l / len;
+        }
+    }
+
+    glm::vec3 d = b.center - a.center;
+    float enter = -FLT_MAX, exit = FLT_MAX;
+
+    for (int k = 0; k < axisCount; k++) {
+        glm::vec3 l = axes[k];
+
+        float r = 0.0f;
+        for (int c = 0; c < 3; c++)
+            r += a.half[c] * fabsf(glm::dot(a.axes[c], l)) + b.half[c] * fabsf(glm::dot(b.axes[c], l));
+
+        // 이 축에서의 중심 거리는 dist - s * speed
+        float dist = glm::dot(d, l);
+        float speed = glm::dot(motion, l);
+
+        if (fabsf(speed) < 1e-9f) {
+            if (fabsf(dist) > r)
+                return false;
+            continue;
+        }
+
+        float s1 = (dist - r) / speed;
+        float s2 = (dist + r) / speed;
+        if (s1 > s2)
+            std::swap(s1, s2);
+
+        if (s1 > enter) {
+            enter = s1;
+            // b의 표면에서 a 쪽을 향하는 법선
+            normal = speed > 0.0f ? -l : l;
+        }
+        exit = std::min(exit, s2);
+
+        if (enter > exit)
+            return false;
+    }
+
+    // 처음부터 겹쳐 있거나 이번 이동 안에 닿지 않음
+    if (enter < 0.0f || enter > 1.0f)
+        return false;
+
+    toi = enter;
+    return true;
+}
+
+// 이전 isCollision3D (this의 꼭짓점이 target의 V[0] ~ V[7] 범위 안에 있는지)
+static bool legacyVertexTest(const ColliderBox& self, const ColliderBox& target) {
+    glm::vec3 vmin(target.V[0]), vmax(target.V[7]);
+
+    for (glm::vec3 v : self.V) {
+        if (v.x > vmin.x && v.y > vmin.y && v.z > vmin.z &&
+            v.x < vmax.x && v.y < vmax.y && v.z < vmax.z)
+            return true;
+    }
+    return false;
+}
+
+void benchmarkNarrowPhase(size_t count, int iterations) {
+    std::vector<ColliderBox> boxes(count * 2);
+    std::vector<OBB> a(count), b(count);
+
+    srand(7);
+    auto frand = [](float lo, float hi) { return lo + (hi - lo) * float(rand()) / float(RAND_MAX); };
+
+    for (size_t i = 0; i < count * 2; i++) {
+        // broad phase를 통과한 쌍처럼 대부분 겹치도록 좁은 범위에 둔다.
+        // V는 (pos + local)까지 회전하므로 회전 후 중심이 그 범위에 오도록 역회전한 위치를 넣는다
+        glm::vec3 euler(frand(0.0f, 360.0f), frand(0.0f, 360.0f), frand(0.0f, 360.0f));
+        glm::vec3 center(frand(-1.0f, 1.0f), frand(-1.0f, 1.0f), frand(-1.0f, 1.0f));
+        glm::vec3 size(frand(0.2f, 1.0f), frand(0.2f, 1.0f), frand(0.2f, 1.0f));
+
+        boxes[i].setSize3D(glm::inverse(eulerToQuat(euler)) * center, glm::vec3(0.0f), euler, size);
+    }
+    for (size_t i = 0; i < count; i++) {
+        a[i] = boxes[2 * i].getOBB();
+        b[i] = boxes[2 * i + 1].getOBB();
+    }
+
+    std::vector<uint8_t> legacyHits(count), scalarHits(count), batchHits(count);
+    std::vector<ContactManifold> contacts(count);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    for (int it = 0; it < iterations; it++)
+        for (size_t i = 0; i < count; i++)
+            legacyHits[i] = legacyVertexTest(boxes[2 * i], boxes[2 * i + 1]);
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    for (int it = 0; it < iterations; it++)
+        for (size_t i = 0; i < count; i++)
+            scalarHits[i] = collideOBB(a[i], b[i]);
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    for (int it = 0; it < iterations; it++)
+        collideOBBBatch(a.data(), b.data(), count, batchHits.data());
+
+    auto t3 = std::chrono::high_resolution_clock::now();
+
+    for (int it = 0; it < iterations; it++)
+        collideOBBBatch(a.data(), b.data(), count, batchHits.data(), contacts.data());
+
+    auto t4 = std::chrono::high_resolution_clock::now();
+
+    size_t hitCount = 0, legacyMissed = 0, legacyFalse = 0, mismatch = 0;
+    for (size_t i = 0; i < count; i++) {
+        hitCount += scalarHits[i];
+        legacyMissed += scalarHits[i] && !legacyHits[i];
+        legacyFalse += !scalarHits[i] && legacyHits[i];
+        mismatch += scalarHits[i] != batchHits[i];
+    }
+
+    auto ms = [](std::chrono::high_resolution_clock::time_point from, std::chrono::high_resolution_clock::time_point to) {
+        return std::chrono::duration<float, std::chrono::milliseconds::period>(to - from).count();
+    };
+
+#if defined(USE_AVX2)
+    const char* path = "AVX2";
+#elif defined(USE_SSE)
+    const char* path = "SSE";
+#else
+    const char* path = "scalar";
+#endif
+
+    std::cout << "[NarrowPhase] " << count << " pairs x " << iterations << " frames (" << path << ")" << std::endl;
+    std::cout << "  legacy vertex test : " << ms(t0, t1) << " ms" << std::endl;
+    std::cout << "  SAT scalar         : " << ms(t1, t2) << " ms" << std::endl;
+    std::cout << "  SAT batch          : " << ms(t2, t3) << " ms" << std::endl;
+    std::cout << "  SAT batch+contacts : " << ms(t3, t4) << " ms" << std::endl;
+    std::cout << "  overlapping pairs  : " << hitCount << " (legacy missed " << legacyMissed
+              << ", legacy false " << legacyFalse << ", batch mismatch " << mismatch << ")" << std::endl;
+}
+
+///////////////////////////////////////////////////
+/////////////////   COLLISION   ///////////////////
+///////////////////////////////////////////////////
+
+void placeCollider(ColliderBox* collider, Transform* transform, glm::vec3 pos, glm::quat rot) {
+    Transform* parent = transform ? transform->getParent() : nullptr;
+
+    if (parent) {
+        pos = glm::vec3(bodyStore.computeWorldMatrix(parent) * glm::vec4(pos, 1.0f));
+        rot = bodyStore.computeWorldRotation(parent) * rot;
+    }
+
+    collider->posX = pos.x;
+    collider->posY = pos.y;
+    collider->posZ = pos.z;
+    collider->rotation = rot;
+}
+
+int DynamicAABBTree::allocateNode() {
+    int id;
+    if (freeList != -1) {
+        id = freeList;
+        freeList = nodes[id].parent;
+    }
+    else {
+        id = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    Node& node = nodes[id];
+    node.userData = nullptr;
+    node.parent = -1;
+    node.child1 = -1;
+    node.child2 = -1;
+    node.height = 0;
+    node.moved = false;
+
+    return id;
+}
+
+void DynamicAABBTree::freeNode(int id) {
+    nodes[id].parent = freeList;
+    nodes[id].height = -1;
+    freeList = id;
+}
+
+int DynamicAABBTree::createProxy(const AABB& aabb, void* userData) {
+    int id = allocateNode();
+
+    glm::vec3 margin(fatMargin);
+    nodes[id].aabb = { aabb.min - margin, aabb.max + margin };
+    nodes[id].userData = userData;
+    nodes[id].moved = true;
+
+    insertLeaf(id);
+    moveBuffer.push_back(id);
+
+    return id;
+}
+
+void DynamicAABBTree::destroyProxy(int proxyId) {
+    for (int& id : moveBuffer)
+        if (id == proxyId)
+            id = -1;
+
+    removeLeaf(proxyId);
+    freeNode(proxyId);
+}
+
+bool BroadPhase::refit(AABB& fatAABB, const AABB& aabb, glm::vec3 displacement) {
+    glm::vec3 margin(fatMargin);
+    AABB fat = { aabb.min - margin, aabb.max + margin };
+
+    // 움직이는 방향으로 더 늘려서 다음 몇 스텝 동안 갱신을 피한다
+    glm::vec3 d = displacement * displacementMultiplier;
+    for (int c = 0; c < 3; c++) {
+        if (d[c] < 0.0f)
+            fat.min[c] += d[c];
+        else
+            fat.max[c] += d[c];
+    }
+
+    if (fatAABB.contains(aabb)) {
+        // 너무 크게 남은 박스만 줄인다
+        glm::vec3 hugeMargin(4.0f * fatMargin);
+        AABB huge = { fat.min - hugeMargin, fat.max + hugeMargin };
+        if (huge.contains(fatAABB))
+            return false;
+    }
+
+    fatAABB = fat;
+    return true;
+}
+
+bool DynamicAABBTree::moveProxy(int proxyId, const AABB& aabb, glm::vec3 displacement) {
+    AABB fat = nodes[proxyId].aabb;
+    if (!refit(fat, aabb, displacement))
+        return false;
+
+    removeLeaf(proxyId);
+    nodes[proxyId].aabb = fat;
+    insertLeaf(proxyId);
+
+    if (!nodes[proxyId].moved) {
+        nodes[proxyId].moved = true;
+        moveBuffer.push_back(proxyId);
+    }
+
+    return true;
+}
+
+void DynamicAABBTree::computePairs(std::vector<std::pair<int, int>>& pairs) {
+    pairs.clear();
+
+    for (int queryId : moveBuffer) {
+        if (queryId == -1)
+            continue;
+
+        AABB fat = nodes[queryId].aabb;
+        query(fat, [&](int proxyId) {
+            if (proxyId == queryId)
+                return true;
+
+            // 둘 다 움직였으면 작은 id 쪽에서 한 번만
+            if (nodes[proxyId].moved && proxyId < queryId)
+                return true;
+
+            pairs.push_back({ std::min(proxyId, queryId), std::max(proxyId, queryId) });
+            return true;
+        });
+    }
+
+    for (int id : moveBuffer)
+        if (id != -1)
+            nodes[id].moved = false;
+    moveBuffer.clear();
+}
+
+void DynamicAABBTree::insertLeaf(int leaf) {
+    if (root == -1) {
+        root = leaf;
+        nodes[root].parent = -1;
+        return;
+    }
+
+    // 표면적 증가가 가장 작은 형제를 찾는다
+    AABB leafAABB = nodes[leaf].aabb;
+    int index = root;
+    while (!nodes[index].isLeaf()) {
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        float area = nodes[index].aabb.surfaceArea();
+        float combinedArea = AABB::merge(nodes[index].aabb, leafAABB).surfaceArea();
+
+        // 여기서 새 부모를 만드는 비용과 아래로 내려갈 때 물려받는 비용
+        float cost = 2.0f * combinedArea;
+        float inheritance = 2.0f * (combinedArea - area);
+
+        float cost1 = AABB::merge(leafAABB, nodes[child1].aabb).surfaceArea() + inheritance;
+        if (!nodes[child1].isLeaf())
+            cost1 -= nodes[child1].aabb.surfaceArea();
+
+        float cost2 = AABB::merge(leafAABB, nodes[child2].aabb).surfaceArea() + inheritance;
+        if (!nodes[child2].isLeaf())
+            cost2 -= nodes[child2].aabb.surfaceArea();
+
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = cost1 < cost2 ? child1 : child2;
+    }
+
+    int sibling = index;
+
+    // allocateNode가 nodes를 늘릴 수 있으므로 참조는 그 뒤에 잡는다
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].aabb = AABB::merge(leafAABB, nodes[sibling].aabb);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+
+    if (oldParent != -1) {
+        if (nodes[oldParent].child1 == sibling)
+            nodes[oldParent].child1 = newParent;
+        else
+            nodes[oldParent].child2 = newParent;
+    }
+    else {
+        root = newParent;
+    }
+
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    // 위로 올라가며 높이와 AABB 갱신
+    index = nodes[leaf].parent;
+    while (index != -1) {
+        index = balance(index);
+
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+        nodes[index].aabb = AABB::merge(nodes[child1].aabb, nodes[child2].aabb);
+
+        index = nodes[index].parent;
+    }
+}
+
+void DynamicAABBTree::removeLeaf(int leaf) {
+    if (leaf == root) {
+        root = -1;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent == -1) {
+        root = sibling;
+        nodes[sibling].parent = -1;
+        freeNode(parent);
+        return;
+    }
+
+    // 부모를 없애고 형제를 조부모에 직접 연결
+    if (nodes[grandParent].child1 == parent)
+        nodes[grandParent].child1 = sibling;
+    else
+        nodes[grandParent].child2 = sibling;
+    nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    int index = grandParent;
+    while (index != -1) {
+        index = balance(index);
+
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        nodes[index].aabb = AABB::merge(nodes[child1].aabb, nodes[child2].aabb);
+        nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+        index = nodes[index].parent;
+    }
+}
+
+// A의 두 자식 높이 차가 1보다 크면 높은 쪽 자식을 A 자리로 올린다. 새 서브트리 루트를 반환.
+int DynamicAABBTree::balance(int iA) {
+    Node* A = &nodes[iA];
+    if (A->isLeaf() || A->height < 2)
+        return iA;
+
+    int iB = A->child1;
+    int iC = A->child2;
+    Node* B = &nodes[iB];
+    Node* C = &nodes[iC];
+
+    int diff = C->height - B->height;
+
+    // C를 올린다
+    if (diff > 1) {
+        int iF = C->child1;
+        int iG = C->child2;
+        Node* F = &nodes[iF];
+        Node* G = &nodes[iG];
+
+        C->child1 = iA;
+        C->parent = A->parent;
+        A->parent = iC;
+
+        if (C->parent != -1) {
+            if (nodes[C->parent].child1 == iA)
+                nodes[C->parent].child1 = iC;
+            else
+                nodes[C->parent].child2 = iC;
+        }
+        else {
+            root = iC;
+        }
+
+        if (F->height > G->height) {
+            C->child2 = iF;
+            A->child2 = iG;
+            G->parent = iA;
+            A->aabb = AABB::merge(B->aabb, G->aabb);
+            C->aabb = AABB::merge(A->aabb, F->aabb);
+
+            A->height = 1 + std::max(B->height, G->height);
+            C->height = 1 + std::max(A->height, F->height);
+        }
+        else {
+            C->child2 = iG;
+            A->child2 = iF;
+            F->parent = iA;
+            A->aabb = AABB::merge(B->aabb, F->aabb);
+            C->aabb = AABB::merge(A->aabb, G->aabb);
+
+            A->height = 1 + std::max(B->height, F->height);
+            C->height = 1 + std::max(A->height, G->height);
+        }
+
+        return iC;
+    }
+
+    // B를 올린다
+    if (diff < -1) {
+        int iD = B->child1;
+        int iE = B->child2;
+        Node* D = &nodes[iD];
+        Node* E = &nodes[iE];
+
+        B->child1 = iA;
+        B->parent = A->parent;
+        A->parent = iB;
+
+        if (B->parent != -1) {
+            if (nodes[B->parent].child1 == iA)
+                nodes[B->parent].child1 = iB;
+            else
+                nodes[B->parent].child2 = iB;
+        }
+        else {
+            root = iB;
+        }
+
+        if (D->height > E->height) {
+            B->child2 = iD;
+            A->child1 = iE;
+            E->parent = iA;
+            A->aabb = AABB::merge(C->aabb, E->aabb);
+            B->aabb = AABB::merge(A->aabb, D->aabb);
+
+            A->height = 1 + std::max(C->height, E->height);
+            B->height = 1 + std::max(A->height, D->height);
+        }
+        else {
+            B->child2 = iE;
+            A->child1 = iD;
+            D->parent = iA;
+            A->aabb = AABB::merge(C->aabb, D->aabb);
+            B->aabb = AABB::merge(A->aabb, E->aabb);
+
+            A->height = 1 + std::max(C->height, D->height);
+            B->height = 1 + std::max(A->height, E->height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+int SweepAndPrune::createProxy(const AABB& aabb, void* userData) {
+    int id;
+    if (!freeList.empty()) {
+        id = freeList.back();
+        freeList.pop_back();
+    }
+    else {
+        id = static_cast<int>(proxies.size());
+        proxies.push_back({});
+    }
+
+    glm::vec3 margin(fatMargin);
+    proxies[id] = { { aabb.min - margin, aabb.max + margin }, userData, true, true };
+    pendingInsert.push_back(id);
+
+    return id;
+}
+
+void SweepAndPrune::destroyProxy(int proxyId) {
+    proxies[proxyId].alive = false;
+    proxies[proxyId].moved = false;
+
+    auto it = std::find(pendingInsert.begin(), pendingInsert.end(), proxyId);
+    if (it != pendingInsert.end()) {
+        pendingInsert.erase(it);
+        freeList.push_back(proxyId);
+    }
+    // order에서 빠지기 전에 id가 재사용되지 않도록 computePairs까지 미룬다
+    else
+        pendingRemove.push_back(proxyId);
+}
+
+bool SweepAndPrune::moveProxy(int proxyId, const AABB& aabb, glm::vec3 displacement) {
+    if (!refit(proxies[proxyId].aabb, aabb, displacement))
+        return false;
+
+    proxies[proxyId].moved = true;
+    return true;
+}
+
+void SweepAndPrune::chooseSortAxis() {
+    size_t n = order.size();
+    if (n < 2)
+        return;
+
+    glm::vec3 sum(0.0f), sum2(0.0f);
+    for (int id : order) {
+        glm::vec3 c = proxies[id].aabb.center();
+        sum += c;
+        sum2 += c * c;
+    }
+
+    glm::vec3 variance = sum2 / float(n) - (sum / float(n)) * (sum / float(n));
+
+    int best = 0;
+    for (int c = 1; c < 3; c++)
+        if (variance[c] > variance[best])
+            best = c;
+
+    // 축이 자주 바뀌면 전체 정렬이 반복되므로 확실히 나을 때만 바꾼다
+    if (best != sortAxis && variance[best] > 1.5f * variance[sortAxis]) {
+        sortAxis = best;
+        sortOrder(true);
+    }
+}
+
+void SweepAndPrune::sortOrder(bool full) {
+    int axis = sortAxis;
+    auto key = [&](int id) { return proxies[id].aabb.min[axis]; };
+
+    if (full) {
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return key(a) < key(b); });
+        return;
+    }
+
+    // 지난 프레임 순서가 거의 맞으므로 삽입 정렬이 O(n + 이동 수)
+    for (size_t i = 1; i < order.size(); i++) {
+        int id = order[i];
+        float k = key(id);
+
+        size_t j = i;
+        while (j > 0 && key(order[j - 1]) > k) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = id;
+    }
+}
+
+void SweepAndPrune::gatherSorted() {
+    size_t n = order.size();
+
+    for (int c = 0; c < 3; c++) {
+        // SIMD로 끝을 넘겨 읽어도 정렬 축 검사에서 떨어지도록 +inf로 채운다
+        sortedMin[c].assign(n + 8, INFINITY);
+        sortedMax[c].assign(n + 8, -FLT_MAX);
+
+        for (size_t i = 0; i < n; i++) {
+            sortedMin[c][i] = proxies[order[i]].aabb.min[c];
+            sortedMax[c][i] = proxies[order[i]].aabb.max[c];
+        }
+    }
+}
+
+#ifdef USE_SSE
+// i 이후 정렬 축에서 겹치는 구간을 lane 폭씩 검사. 정렬 축 min이 오름차순이므로
+// lane 하나라도 정렬 축에서 벗어나면 그 뒤는 볼 필요가 없다.
+template <typename S>
+static void sweepBlock(const std::vector<float>* sortedMin, const std::vector<float>* sortedMax, int axis,
+                            size_t n, size_t i, std::vector<size_t>& hits) {
+    typedef typename S::V V;
+
+    int a1 = (axis + 1) % 3, a2 = (axis + 2) % 3;
+
+    V maxS = S::set1(sortedMax[axis][i]);
+    V min1 = S::set1(sortedMin[a1][i]), max1 = S::set1(sortedMax[a1][i]);
+    V min2 = S::set1(sortedMin[a2][i]), max2 = S::set1(sortedMax[a2][i]);
+    const int full = (1 << S::width) - 1;
+
+    for (size_t j = i + 1;; j += S::width) {
+        V inRange = S::cmpLe(S::load(&sortedMin[axis][j]), maxS);
+
+        V overlap = S::bitAnd(inRange, S::cmpLe(S::load(&sortedMin[a1][j]), max1));
+        overlap = S::bitAnd(overlap, S::cmpLe(min1, S::load(&sortedMax[a1][j])));
+        overlap = S::bitAnd(overlap, S::cmpLe(S::load(&sortedMin[a2][j]), max2));
+        overlap = S::bitAnd(overlap, S::cmpLe(min2, S::load(&sortedMax[a2][j])));
+
+        for (int mask = S::moveMask(overlap), k = 0; mask; mask >>= 1, k++)
+            if (mask & 1)
+                hits.push_back(j + k);
+
+        // 끝의 패딩까지 읽었으면 종료
+        if (S::moveMask(inRange) != full || j + S::width >= n)
+            return;
+    }
+}
+#endif
+
+void SweepAndPrune::computePairs(std::vector<std::pair<int, int>>& pairs) {
+    pairs.clear();
+
+    if (!pendingRemove.empty()) {
+        order.erase(std::remove_if(order.begin(), order.end(), [&](int id) { return !proxies[id].alive; }), order.end());
+        freeList.insert(freeList.end(), pendingRemove.begin(), pendingRemove.end());
+        pendingRemove.clear();
+    }
+
+    // 한꺼번에 많이 들어오면 삽입 정렬보다 전체 정렬이 싸다
+    bool full = pendingInsert.size() > order.size() / 4;
+    order.insert(order.end(), pendingInsert.begin(), pendingInsert.end());
+    pendingInsert.clear();
+
+    sortOrder(full);
+    chooseSortAxis();
+    gatherSorted();
+
+    size_t n = order.size();
+    std::vector<size_t> hits;
+
+    for (size_t i = 0; i < n; i++) {
+        hits.clear();
+
+#if defined(USE_AVX2)
+        sweepBlock<SimdAVX2>(sortedMin, sortedMax, sortAxis, n, i, hits);
+#elif defined(USE_SSE)
+        sweepBlock<SimdSSE>(sortedMin, sortedMax, sortAxis, n, i, hits);
+#else
+        int a1 = (sortAxis + 1) % 3, a2 = (sortAxis + 2) % 3;
+        for (size_t j = i + 1; j < n && sortedMin[sortAxis][j] <= sortedMax[sortAxis][i]; j++) {
+            if (sortedMin[a1][j] <= sortedMax[a1][i] && sortedMin[a1][i] <= sortedMax[a1][j] &&
+                sortedMin[a2][j] <= sortedMax[a2][i] && sortedMin[a2][i] <= sortedMax[a2][j])
+                hits.push_back(j);
+        }
+#endif
+
+        int idA = order[i];
+        for (size_t h : hits) {
+            int idB = order[h];
+
+            // 둘 다 가만히 있던 쌍은 이미 보고됨
+            if (!proxies[idA].moved && !proxies[idB].moved)
+                continue;
+
+            pairs.push_back({ std::min(idA, idB), std::max(idA, idB) });
+        }
+    }
+
+    for (int id : order)
+        proxies[id].moved = false;
+}
+
+void SweepAndPrune::queryProxies(const AABB& aabb, std::vector<int>& result) {
+    for (size_t id = 0; id < proxies.size(); id++)
+        if (proxies[id].alive && proxies[id].aabb.overlaps(aabb))
+            result.push_back(static_cast<int>(id));
+}
+
+int SweepAndPrune::raycastProxies(  glm::vec3 origin, glm::vec3 dir, float maxT,
+                                    std::function<float(int, float)> callback, float* hitT) {
+    glm::vec3 invDir(   dir.x != 0.0f ? 1.0f / dir.x : FLT_MAX,
+                        dir.y != 0.0f ? 1.0f / dir.y : FLT_MAX,
+                        dir.z != 0.0f ? 1.0f / dir.z : FLT_MAX);
+
+    int hit = -1;
+    for (size_t id = 0; id < proxies.size(); id++) {
+        float t;
+        if (!proxies[id].alive || !proxies[id].aabb.raycast(origin, invDir, maxT, t))
+            continue;
+
+        float leafT = callback(static_cast<int>(id), maxT);
+        if (leafT >= 0.0f && leafT < maxT) {
+            maxT = leafT;
+            hit = static_cast<int>(id);
+        }
+    }
+
+    if (hitT && hit != -1)
+        *hitT = maxT;
+    return hit;
+}
+
+void SpatialHashGrid::build(const std::vector<AABB>& items) {
+    bounds = items;
+    size_t n = bounds.size();
+
+    visitStamp.assign(n, 0);
+    stamp = 0;
+    largeItems.clear();
+
+    worldBounds = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+    for (const AABB& b : bounds)
+        worldBounds = AABB::merge(worldBounds, b);
+
+    // 항목별 칸 수를 세고 prefix sum으로 entries 내 자리를 정해 둔다
+    std::vector<uint32_t> offsets(n + 1, 0);
+    parallelFor(n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            Cell lo = cellOf(bounds[i].min), hi = cellOf(bounds[i].max);
+            size_t cells = size_t(hi.x - lo.x + 1) * size_t(hi.y - lo.y + 1) * size_t(hi.z - lo.z + 1);
+            offsets[i + 1] = cells > maxCellsPerItem ? 0 : uint32_t(cells);
+        }
+    });
+
+    for (size_t i = 0; i < n; i++) {
+        if (offsets[i + 1] == 0)
+            largeItems.push_back(int(i));
+        offsets[i + 1] += offsets[i];
+    }
+
+    size_t entryCount = offsets[n];
+    entries.resize(entryCount);
+
+    // 버킷 수는 항목 수의 두 배 이상인 2의 거듭제곱
+    size_t wanted = 64;
+    while (wanted < entryCount * 2)
+        wanted <<= 1;
+    if (wanted != tableSize) {
+        heads.reset(new std::atomic<int>[wanted]);
+        tableSize = wanted;
+    }
+    parallelFor(tableSize, [&](size_t begin, size_t end) {
+        for (size_t h = begin; h < end; h++)
+            heads[h].store(-1, std::memory_order_relaxed);
+    });
+
+    const size_t insertPerThread = 1024;
+    parallelFor(n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            uint32_t e = offsets[i];
+            if (e == offsets[i + 1])
+                continue;
+
+            Cell lo = cellOf(bounds[i].min), hi = cellOf(bounds[i].max);
+            for (int x = lo.x; x <= hi.x; x++) {
+                for (int y = lo.y; y <= hi.y; y++) {
+                    for (int z = lo.z; z <= hi.z; z++, e++) {
+                        std::atomic<int>& head = heads[hashCell(x, y, z)];
+
+                        entries[e].item = int(i);
+                        int old = head.load(std::memory_order_relaxed);
+                        do {
+                            entries[e].next = old;
+                        } while (!head.compare_exchange_weak(old, int(e), std::memory_order_release, std::memory_order_relaxed));
+                    }
+                }
+            }
+        }
+    }, insertPerThread);
+
+    // 여러 스레드로 넣었으면 칸마다 순서가 실행마다 달라지므로, 한 스레드로 넣었을 때처럼
+    // entry 번호 내림차순으로 다시 이어 질의 결과(순회 순서)를 재현 가능하게 한다
+    if (n < insertPerThread * 2)
+        return;
+
+    parallelFor(tableSize, [&](size_t begin, size_t end) {
+        std::vector<int> chain;
+        for (size_t h = begin; h < end; h++) {
+            int first = heads[h].load(std::memory_order_relaxed);
+            if (first == -1 || entries[first].next == -1)
+                continue;
+
+            chain.clear();
+            for (int e = first; e != -1; e = entries[e].next)
+                chain.push_back(e);
+            if (std::is_sorted(chain.begin(), chain.end(), std::greater<int>()))
+                continue;
+
+            std::sort(chain.begin(), chain.end(), std::greater<int>());
+            for (size_t i = 0; i + 1 < chain.size(); i++)
+                entries[chain[i]].next = chain[i + 1];
+            entries[chain.back()].next = -1;
+            heads[h].store(chain.front(), std::memory_order_relaxed);
+        }
+    });
+}
+
+bool SpatialHashGrid::clampCells(const AABB& aabb, Cell& lo, Cell& hi) {
+    if (bounds.empty() || !aabb.overlaps(worldBounds))
+        return false;
+
+    lo = cellOf(glm::max(aabb.min, worldBounds.min));
+    hi = cellOf(glm::min(aabb.max, worldBounds.max));
+    return true;
+}
+
+void SpatialHashGrid::queryAABB(const AABB& aabb, std::vector<int>& result) {
+    Cell lo, hi;
+    if (!clampCells(aabb, lo, hi))
+        return;
+
+    forEachInCells(lo, hi, [&](int item) {
+        if (bounds[item].overlaps(aabb))
+            result.push_back(item);
+    });
+}
+
+// 점에서 AABB까지 거리의 제곱 (안이면 0)
+static float distanceSquared(const AABB& aabb, glm::vec3 p) {
+    glm::vec3 d = glm::max(glm::max(aabb.min - p, p - aabb.max), glm::vec3(0.0f));
+    return glm::dot(d, d);
+}
+
+void SpatialHashGrid::queryRadius(glm::vec3 center, float radius, std::vector<int>& result) {
+    Cell lo, hi;
+    if (!clampCells({ center - glm::vec3(radius), center + glm::vec3(radius) }, lo, hi))
+        return;
+
+    float r2 = radius * radius;
+    forEachInCells(lo, hi, [&](int item) {
+        if (distanceSquared(bounds[item], center) <= r2)
+            result.push_back(item);
+    });
+}
+
+void SpatialHashGrid::queryNearest(glm::vec3 point, size_t k, std::vector<int>& result) {
+    if (bounds.empty() || k == 0)
+        return;
+
+    k = std::min(k, bounds.size());
+
+    // 점을 둘러싼 정육면체를 두 배씩 키운다. 반지름 안의 항목은 모두 정육면체 안 칸에 있으므로
+    // k번째 거리가 반지름 이하가 되면 더 볼 필요가 없다.
+    std::vector<std::pair<float, int>> found;
+    for (float radius = cellSize;; radius *= 2.0f) {
+        found.clear();
+
+        AABB cube = { point - glm::vec3(radius), point + glm::vec3(radius) };
+        Cell lo, hi;
+        if (clampCells(cube, lo, hi)) {
+            forEachInCells(lo, hi, [&](int item) {
+                found.push_back({ distanceSquared(bounds[item], point), item });
+            });
+        }
+
+        bool coversWorld = cube.contains(worldBounds);
+        if (found.size() >= k) {
+            std::partial_sort(found.begin(), found.begin() + k, found.end());
+            if (coversWorld || found[k - 1].first <= radius * radius)
+                break;
+        }
+        else if (coversWorld) {
+            std::sort(found.begin(), found.end());
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < std::min(k, found.size()); i++)
+        result.push_back(found[i].second);
+}
+
+// broad phase에서 한 번이라도 겹친 (a < b) proxy 쌍. 부풀린 AABB가 떨어지면 빠진다.
+std::set<std::pair<int, int>> colliderPairCache;
+
+void registerCollider(GameObject* go) {
+    if (go->proxyId != -1)
+        unregisterCollider(go);
+
+    go->proxyId = broadPhase->createProxy(go->collider->getAABB(), go);
+}
+
+void unregisterCollider(GameObject* go) {
+    if (go->proxyId == -1)
+        return;
+
+    for (auto it = colliderPairCache.begin(); it != colliderPairCache.end();) {
+        if (it->first == go->proxyId || it->second == go->proxyId)
+            it = colliderPairCache.erase(it);
+        else
+            ++it;
+    }
+
+    collisionPairs.erase(   std::remove_if(collisionPairs.begin(), collisionPairs.end(), 
+                                [go](const CollisionPair& p) { return p.a == go || p.b == go; }),
+                            collisionPairs.end());
+    continuousPairs.erase(  std::remove_if(continuousPairs.begin(), continuousPairs.end(), 
+                                [go](const CollisionPair& p) { return p.a == go || p.b == go; }),
+                            continuousPairs.end());
+
+    broadPhase->destroyProxy(go->proxyId);
+    go->proxyId = -1;
+
+    // 다음 rebuildProximityGrid 전까지는 질의 결과에서 빠지도록
+    std::replace(proximityObjects.begin(), proximityObjects.end(), go, static_cast<GameObject*>(NULL));
+}
+
+void setBroadPhase(BroadPhaseType type) {
+    BroadPhase* next = type == BROAD_PHASE_SAP ? static_cast<BroadPhase*>(&colliderSAP) : &colliderTree;
+    if (next == broadPhase)
+        return;
+
+    std::vector<GameObject*> registered;
+    for (GameObject* go : gameObjectList) {
+        if (go->proxyId == -1)
+            continue;
+
+        registered.push_back(go);
+        unregisterCollider(go);
+    }
+
+    broadPhase = next;
+    for (GameObject* go : registered)
+        registerCollider(go);
+}
+
+void updateCollisions(float dt) {
+    for (GameObject* go : gameObjectList) {
+        if (go->proxyId == -1)
+            continue;
+
+        broadPhase->moveProxy(go->proxyId, go->collider->getAABB(), go->getVelocity() * dt);
+    }
+
+    std::vector<std::pair<int, int>> newPairs;
+    broadPhase->computePairs(newPairs);
+    colliderPairCache.insert(newPairs.begin(), newPairs.end());
+
+    std::vector<CollisionPair> candidates;
+    std::vector<OBB> boxA, boxB;
+
+    for (auto it = colliderPairCache.begin(); it != colliderPairCache.end();) {
+        if (!broadPhase->getFatAABB(it->first).overlaps(broadPhase->getFatAABB(it->second))) {
+            it = colliderPairCache.erase(it);
+            continue;
+        }
+
+        GameObject* a = static_cast<GameObject*>(broadPhase->getUserData(it->first));
+        GameObject* b = static_cast<GameObject*>(broadPhase->getUserData(it->second));
+
+        if (a->collider->getAABB().overlaps(b->collider->getAABB())) {
+            candidates.push_back({ a, b });
+            boxA.push_back(a->collider->getOBB());
+            boxB.push_back(b->collider->getOBB());
+        }
+
+        ++it;
+    }
+
+    // 타이트한 AABB까지 겹친 쌍만 모아 OBB narrow phase를 한 번에 돌린다
+    std::vector<uint8_t> hits(candidates.size());
+    std::vector<ContactManifold> contacts(candidates.size());
+    collideOBBBatch(boxA.data(), boxB.data(), candidates.size(), hits.data(), contacts.data());
+
+    collisionPairs.clear();
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (!hits[i])
+            continue;
+
+        candidates[i].contact = contacts[i];
+        collisionPairs.push_back(candidates[i]);
+    }
+
+    // CCD로 접촉 직전에 멈춘 쌍
+    for (const CollisionPair& p : continuousPairs) {
+        bool found = std::any_of(collisionPairs.begin(), collisionPairs.end(), [&p](const CollisionPair& q) {
+            return (q.a == p.a && q.b == p.b) || (q.a == p.b && q.b == p.a);
+        });
+
+        if (!found)
+            collisionPairs.push_back(p);
+    }
+    continuousPairs.clear();
+}
+
+std::vector<GameObject*> queryColliders(const AABB& aabb) {
+    std::vector<GameObject*> res;
+    std::vector<int> proxies;
+    broadPhase->queryProxies(aabb, proxies);
+
+    for (int proxyId : proxies) {
+        GameObject* go = static_cast<GameObject*>(broadPhase->getUserData(proxyId));
+        if (go->collider->getAABB().overlaps(aabb))
+            res.push_back(go);
+    }
+
+    return res;
+}
+
+GameObject* raycastColliders(glm::vec3 origin, glm::vec3 dir, float maxDistance, float* hitDistance) {
+    glm::vec3 invDir(   dir.x != 0.0f ? 1.0f / dir.x : FLT_MAX,
+                        dir.y != 0.0f ? 1.0f / dir.y : FLT_MAX,
+                        dir.z != 0.0f ? 1.0f / dir.z : FLT_MAX);
+
+    int hit = broadPhase->raycastProxies(origin, dir, maxDistance, [&](int proxyId, float maxT) {
+        GameObject* go = static_cast<GameObject*>(broadPhase->getUserData(proxyId));
+
+        float t;
+        return go->collider->getAABB().raycast(origin, invDir, maxT, t) ? t : -1.0f;
+    }, hitDistance);
+
+    return hit == -1 ? NULL : static_cast<GameObject*>(broadPhase->getUserData(hit));
+}
+
+float sweepCollider(GameObject* go, glm::vec3 motion, GameObject** hitObject, glm::vec3* hitNormal) {
+    if (hitObject)
+        *hitObject = NULL;
+    if (go->proxyId == -1 || motion == glm::vec3(0.0f))
+        return 1.0f;
+
+    // getOBB의 중심은 rotation * (pos + local)이므로 이동도 회전시킨다 (step 중 회전 변화는 무시)
+    OBB box = go->collider->getOBB();
+    glm::vec3 centerMotion = box.axes * motion;
+
+    AABB start = go->collider->getAABB();
+    AABB swept = AABB::merge(start, { start.min + centerMotion, start.max + centerMotion });
+
+    std::vector<int> proxies;
+    broadPhase->queryProxies(swept, proxies);
+
+    float minToi = 1.0f;
+    for (int proxyId : proxies) {
+        GameObject* other = static_cast<GameObject*>(broadPhase->getUserData(proxyId));
+        if (other == go || !other->collider->getAABB().overlaps(swept))
+            continue;
+
+        float toi;
+        glm::vec3 normal;
+        if (!sweepOBB(box, centerMotion, other->collider->getOBB(), toi, normal) || toi >= minToi)
+            continue;
+
+        minToi = toi;
+        if (hitObject)
+            *hitObject = other;
+        if (hitNormal)
+            *hitNormal = normal;
+    }
+
+    return minToi;
+}
+
+glm::vec3 clampContinuousMotion(GameObject* go, glm::vec3 motion) {
+    GameObject* hit;
+    glm::vec3 normal;
+    float toi = sweepCollider(go, motion, &hit, &normal);
+
+    if (!hit)
+        return motion;
+
+    float t = std::max(toi - continuousSkin / glm::length(motion), 0.0f);
+
+    // 멈춘 자리에서 상대 쪽으로 가장 튀어나온 꼭짓점을 접촉점으로 쓴다
+    OBB box = go->collider->getOBB();
+    box.center += box.axes * (motion * t);
+
+    ContactManifold contact;
+    contact.normal = -normal;
+    contact.depth = 0.0f;
+    contact.pointCount = 1;
+    contact.points[0] = box.center;
+    for (int i = 0; i < 3; i++)
+        contact.points[0] += box.axes[i] * (glm::dot(box.axes[i], contact.normal) >= 0.0f ? box.half[i] : -box.half[i]);
+
+    continuousPairs.push_back({ go, hit, contact });
+    return motion * t;
+}
+
+void applyContinuousCollision() {
+    for (GameObject* go : gameObjectList) {
+        if (!go->continuousCollision || go->proxyId == -1)
+            continue;
+
+        // 이동 구간의 양 끝은 둘 다 로컬(bodyStore) 값으로 잡고, collider와 같은 world 기준으로 옮겨 sweep
+        // (collider는 syncColliders 전이라 아직 시작 위치에 있다)
+        Transform* parent = go->transform.getParent();
+        glm::mat4 parentWorld = parent ? bodyStore.computeWorldMatrix(parent) : glm::mat4(1.0f);
+
+        glm::vec3 from = glm::vec3(parentWorld * glm::vec4(bodyStore.getStepStart(go->body), 1.0f));
+        glm::vec3 to = glm::vec3(parentWorld * glm::vec4(go->getPosition(), 1.0f));
+
+        glm::vec3 motion = to - from;
+        glm::vec3 clamped = clampContinuousMotion(go, motion);
+
+        // 속도는 그대로 두고 위치만 자른다. 반응은 onCollider에서. 결과는 다시 부모 기준 로컬로
+        if (clamped != motion)
+            go->setPosition(glm::vec3(glm::inverse(parentWorld) * glm::vec4(from + clamped, 1.0f)));
+    }
+}
+
+void rebuildProximityGrid() {
+    proximityObjects.clear();
+    std::vector<AABB> bounds;
+
+    for (GameObject* go : gameObjectList) {
+        if (go->proxyId == -1)
+            continue;
+
+        proximityObjects.push_back(go);
+        bounds.push_back(go->collider->getAABB());
+    }
+
+    proximityGrid.build(bounds);
+}
+
+std::vector<GameObject*> overlapBox(const AABB& aabb) {
+    std::vector<int> items;
+    proximityGrid.queryAABB(aabb, items);
+
+    std::vector<GameObject*> res;
+    for (int item : items)
+        if (proximityObjects[item])
+            res.push_back(proximityObjects[item]);
+    return res;
+}
+
+std::vector<GameObject*> overlapSphere(glm::vec3 center, float radius) {
+    std::vector<int> items;
+    proximityGrid.queryRadius(center, radius, items);
+
+    std::vector<GameObject*> res;
+    for (int item : items)
+        if (proximityObjects[item])
+            res.push_back(proximityObjects[item]);
+    return res;
+}
+
+std::vector<GameObject*> nearestObjects(glm::vec3 point, size_t k) {
+    std::vector<int> items;
+    proximityGrid.queryNearest(point, k, items);
+
+    std::vector<GameObject*> res;
+    for (int item : items)
+        if (proximityObjects[item])
+            res.push_back(proximityObjects[item]);
+    return res;
+}
+
+void benchmarkBroadPhase(std::vector<size_t> counts, int frames) {
+    srand(11);
+    auto frand = [](float lo, float hi) { return lo + (hi - lo) * float(rand()) / float(RAND_MAX); };
+    auto ms = [](std::chrono::high_resolution_clock::time_point from, std::chrono::high_resolution_clock::time_point to) {
+        return std::chrono::duration<float, std::chrono::milliseconds::period>(to - from).count();
+    };
+
+#if defined(USE_AVX2)
+    const char* path = "AVX2";
+#elif defined(USE_SSE)
+    const char* path = "SSE";
+#else
+    const char* path = "scalar";
+#endif
+
+    std::cout << "[BroadPhase] ground plane, " << frames << " frames (" << path << ")" << std::endl;
+
+    for (size_t count : counts) {
+        // 밀도가 일정하도록 바닥 넓이를 count에 비례시킨다
+        float side = sqrtf(float(count)) * 2.0f;
+
+        std::vector<AABB> boxes(count);
+        std::vector<glm::vec3> velocity(count);
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 center(frand(0.0f, side), frand(0.0f, 1.0f), frand(0.0f, side));
+            glm::vec3 half(frand(0.3f, 0.8f), frand(0.3f, 0.8f), frand(0.3f, 0.8f));
+            boxes[i] = { center - half, center + half };
+            velocity[i] = glm::vec3(frand(-1.0f, 1.0f), 0.0f, frand(-1.0f, 1.0f));
+        }
+
+        SweepAndPrune sap;
+        DynamicAABBTree tree;
+        std::vector<int> sapIds(count), treeIds(count);
+        for (size_t i = 0; i < count; i++) {
+            sapIds[i] = sap.createProxy(boxes[i], nullptr);
+            treeIds[i] = tree.createProxy(boxes[i], nullptr);
+        }
+
+        std::vector<std::pair<int, int>> sapPairs, treePairs;
+        sap.computePairs(sapPairs);
+        tree.computePairs(treePairs);
+
+        const float dt = 1.0f / 60.0f;
+        float sapMs = 0.0f, treeMs = 0.0f, bruteMs = 0.0f;
+        size_t brutePairs = 0;
+        // brute force는 O(n^2)라 큰 수에서는 한 프레임만 잰다
+        int bruteFrames = count > 10000 ? 1 : frames;
+
+        for (int f = 0; f < frames; f++) {
+            for (size_t i = 0; i < count; i++) {
+                glm::vec3 d = velocity[i] * dt;
+                boxes[i] = { boxes[i].min + d, boxes[i].max + d };
+            }
+
+            auto t0 = std::chrono::high_resolution_clock::now();
+
+            for (size_t i = 0; i < count; i++)
+                sap.moveProxy(sapIds[i], boxes[i], velocity[i] * dt);
+            sap.computePairs(sapPairs);
+
+            auto t1 = std::chrono::high_resolution_clock::now();
+
+            for (size_t i = 0; i < count; i++)
+                tree.moveProxy(treeIds[i], boxes[i], velocity[i] * dt);
+            tree.computePairs(treePairs);
+
+            auto t2 = std::chrono::high_resolution_clock::now();
+
+            sapMs += ms(t0, t1);
+            treeMs += ms(t1, t2);
+
+            if (f < bruteFrames) {
+                brutePairs = 0;
+                for (size_t i = 0; i < count; i++)
+                    for (size_t j = i + 1; j < count; j++)
+                        brutePairs += boxes[i].overlaps(boxes[j]);
+
+                bruteMs += ms(t2, std::chrono::high_resolution_clock::now());
+            }
+        }
+
+        // 부풀린 AABB끼리 전체 쌍을 다시 세어 SAP / 트리가 같은 쌍 집합을 보는지 확인
+        SweepAndPrune fresh;
+        fresh.fatMargin = 0.0f;
+        for (size_t i = 0; i < count; i++)
+            fresh.createProxy(sap.getFatAABB(sapIds[i]), nullptr);
+        fresh.computePairs(sapPairs);
+        size_t sapAll = sapPairs.size();
+
+        size_t treeAll = 0;
+        std::vector<int> hits;
+        for (size_t i = 0; i < count; i++) {
+            hits.clear();
+            tree.queryProxies(tree.getFatAABB(treeIds[i]), hits);
+            treeAll += hits.size() - 1;
+        }
+        treeAll /= 2;
+
+        std::cout << "  " << count << " bodies" << std::endl;
+        std::cout << "    brute force : " << bruteMs / bruteFrames << " ms/frame (" << brutePairs << " tight pairs)" << std::endl;
+        std::cout << "    SAP         : " << sapMs / frames << " ms/frame (" << sapAll << " fat pairs, axis " << sap.getSortAxis() << ")" << std::endl;
+        std::cout << "    tree        : " << treeMs / frames << " ms/frame (" << treeAll << " fat pairs)" << std::endl;
+    }
+}
+
+///////////////////////////////////////////////////
+/////////////////    CAPTURE    ///////////////////
+///////////////////////////////////////////////////
+
+// host가 읽을 버퍼. CPU 읽기가 빠른 HOST_CACHED를 먼저 찾고 없으면 HOST_COHERENT. coherent인지 돌려준다
+static bool createReadbackBuffer(VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+        throw std::runtime_error("readback buffer 생성 오류");
+
+    VkMemoryRequirements memReq;
+    vkGetBufferMemoryRequirements(device, buffer, &memReq);
+
+    VkPhysicalDeviceMemoryProperties memProp;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProp);
+
+    const VkMemoryPropertyFlags candidates[] = {
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
+
+    int memTypeIdx = -1;
+    for (VkMemoryPropertyFlags properties : candidates) {
+        for (uint32_t i = 0; i < memProp.memoryTypeCount && memTypeIdx == -1; i++)
+            if ((memReq.memoryTypeBits & (1u << i)) && (memProp.memoryTypes[i].propertyFlags & properties) == properties)
+                memTypeIdx = static_cast<int>(i);
 
-        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrites[0].dstSet = descriptorSets[i];
-        descriptorWrites[0].dstBinding = 0;
-        descriptorWrites[0].dstArrayElement = 0;
-        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        descriptorWrites[0].descriptorCount = 1;
-        descriptorWrites[0].pBufferInfo = &bufferInfo;
+        if (memTypeIdx != -1)
+            break;
+    }
+    if (memTypeIdx == -1)
+        throw std::runtime_error("readback buffer가 요구하는 메모리 유형을 찾을 수 없음.");
 
-        descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrites[1].dstSet = descriptorSets[i];
-        descriptorWrites[1].dstBinding = 1;
-        descriptorWrites[1].dstArrayElement = 0;
-        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        descriptorWrites[1].descriptorCount = 1;
-        descriptorWrites[1].pImageInfo = &imageInfo;
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memReq.size;
+    allocInfo.memoryTypeIndex = memTypeIdx;
+
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+        throw std::runtime_error("readback buffer 메모리 할당 오류");
+
+    vkBindBufferMemory(device, buffer, memory, 0);
+
+    return memProp.memoryTypes[memTypeIdx].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+}
+
+// GPU가 쓴 내용을 매핑된 포인터로 볼 수 있게 (coherent면 할 일 없음)
+static void invalidateReadback(VkDeviceMemory memory, bool coherent) {
+    if (coherent)
+        return;
+
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = memory;
+    range.offset = 0;
+    range.size = VK_WHOLE_SIZE;
+
+    vkInvalidateMappedMemoryRanges(device, 1, &range);
+}
+
+// 복사가 끝난 readback buffer를 host가 읽을 수 있게
+static void hostReadBarrier(VkCommandBuffer recordBuffer, VkBuffer buffer) {
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(recordBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+// image(layout)를 빽빽한 4바이트 픽셀로 buffer에 복사하고 layout으로 되돌린다.
+// srcStage / srcAccess: 이 복사보다 먼저 끝나야 하는 image 쓰기
+static void recordImageReadback(    VkCommandBuffer recordBuffer, VkImage image, VkImageLayout layout, VkExtent2D extent, VkBuffer buffer,
+                                    VkPipelineStageFlags srcStage, VkAccessFlags srcAccess) {
+    // layout이 이미 TRANSFER_SRC여도 실행 / 메모리 의존성은 필요하다
+    colorImageBarrier(  recordBuffer, image, layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                        srcAccess, VK_ACCESS_TRANSFER_READ_BIT, srcStage, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageOffset = { 0, 0, 0 };
+    region.imageExtent = { extent.width, extent.height, 1 };
+
+    vkCmdCopyImageToBuffer(recordBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region);
+
+    // 다음 프레임이 같은 image에 그리기 전에 복사가 끝나도록 (write-after-read)
+    colorImageBarrier(  recordBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, layout,
+                        0, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+    hostReadBarrier(recordBuffer, buffer);
+}
+
+// 매핑해서 꺼내고 readback buffer는 정리
+static std::vector<unsigned char> takeReadback(VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize size, bool coherent) {
+    std::vector<unsigned char> result(static_cast<size_t>(size));
+
+    void* data;
+    vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data);
+    invalidateReadback(memory, coherent);
+    memcpy(result.data(), data, result.size());
+    vkUnmapMemory(device, memory);
+
+    vkFreeMemory(device, memory, nullptr);
+    vkDestroyBuffer(device, buffer, nullptr);
+
+    return result;
+}
+
+static bool isCaptureFormat(VkFormat format) {
+    return  format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB ||
+            format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB;
+}
+
+std::vector<unsigned char> getBufferData(VkBuffer buffer, VkDeviceSize deviceSize) {
+    VkBuffer stagingBuf;
+    VkDeviceMemory stagingMem;
+    bool coherent = createReadbackBuffer(deviceSize, stagingBuf, stagingMem);
+
+    VkCommandBuffer recordBuffer = beginUploadCommands();
+
+    // 앞서 submit된 어떤 쓰기든 복사 전에 끝나도록
+    VkMemoryBarrier writeBarrier{};
+    writeBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    writeBarrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    writeBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(recordBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &writeBarrier, 0, nullptr, 0, nullptr);
+
+    VkBufferCopy bufferCopy{};
+    bufferCopy.srcOffset = 0;
+    bufferCopy.dstOffset = 0;
+    bufferCopy.size = deviceSize;
+
+    vkCmdCopyBuffer(recordBuffer, buffer, stagingBuf, 1, &bufferCopy);
+    hostReadBarrier(recordBuffer, stagingBuf);
+
+    endUploadCommands(recordBuffer);
+
+    return takeReadback(stagingBuf, stagingMem, deviceSize, coherent);
+}
+
+std::vector<unsigned char> getImageData(VkImage src, VkImageLayout layout, VkExtent2D extent) {
+    VkDeviceSize imageSize = VkDeviceSize(extent.width) * extent.height * 4;
+
+    VkBuffer stagingBuf;
+    VkDeviceMemory stagingMem;
+    bool coherent = createReadbackBuffer(imageSize, stagingBuf, stagingMem);
+
+    VkCommandBuffer recordBuffer = beginUploadCommands();
+    recordImageReadback(recordBuffer, src, layout, extent, stagingBuf, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_WRITE_BIT);
+    endUploadCommands(recordBuffer);
+
+    return takeReadback(stagingBuf, stagingMem, imageSize, coherent);
+}
+
+void FrameCapture::start(Consumer consumer) {
+    if (active)
+        stop();
+
+    if (!headless) {
+        VkSurfaceCapabilitiesKHR capabilities;
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &capabilities);
+
+        if (!(capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT))
+            throw std::runtime_error("swapchain 이미지를 복사할 수 없는 surface");
+    }
+    if (!isCaptureFormat(swapChainImageFormat))
+        throw std::runtime_error("캡처할 수 없는 이미지 형식");
+    if (ringSize == 0)
+        throw std::runtime_error("frameCapture ringSize가 0");
+
+    this->consumer = consumer;
+    extent = swapChainExtent;
+    format = swapChainImageFormat;
+    frameSize = VkDeviceSize(extent.width) * extent.height * 4;
+
+    createSlots();
+
+    stopping = false;
+    worker = std::thread(&FrameCapture::consumeLoop, this);
+
+    active = true;
+}
+
+void FrameCapture::stop() {
+    if (!active)
+        return;
+
+    // 복사 중인 프레임도 버리지 않고 소비시킨다
+    std::vector<VkFence> fences;
+    for (uint32_t i = 0; i < slotCount; i++)
+        if (slots[i].state.load(std::memory_order_acquire) == InFlight)
+            fences.push_back(slots[i].fence);
+
+    if (!fences.empty())
+        vkWaitForFences(device, static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, UINT64_MAX);
+    collect();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    readyCondition.notify_one();
+    worker.join();
+
+    destroySlots();
+    active = false;
+}
+
+void FrameCapture::refresh() {
+    if (!active)
+        return;
+
+    Consumer current = consumer;
+    stop();
+    start(current);
+}
+
+VkSemaphore FrameCapture::capture(VkImage image, VkImageLayout layout, VkSemaphore wait) {
+    collect();
+
+    // 가장 오래된 슬롯이 아직 복사 / 소비 중이면 이번 프레임은 버린다 (렌더링은 기다리지 않는다)
+    Slot& slot = slots[next];
+    if (slot.state.load(std::memory_order_acquire) != Free) {
+        droppedCount++;
+        return VK_NULL_HANDLE;
+    }
+
+    vkResetFences(device, 1, &slot.fence);
+    vkResetCommandBuffer(slot.commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(slot.commandBuffer, &beginInfo);
+    // 그리기와의 순서는 wait semaphore (창 모드) / render pass의 readback 의존성 (headless)이 TRANSFER 단계까지 잇는다
+    recordImageReadback(slot.commandBuffer, image, layout, extent, slot.buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, 0);
+    vkEndCommandBuffer(slot.commandBuffer);
+
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &slot.commandBuffer;
+
+    if (wait != VK_NULL_HANDLE) {
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &wait;
+        submitInfo.pWaitDstStageMask = &waitStage;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &slot.semaphore;
+    }
+
+    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, slot.fence) != VK_SUCCESS)
+        throw std::runtime_error("frame capture submit 오류");
+
+    slot.index = frameIndex++;
+    slot.state.store(InFlight, std::memory_order_release);
+    next = (next + 1) % slotCount;
+
+    return wait != VK_NULL_HANDLE ? slot.semaphore : VK_NULL_HANDLE;
+}
+
+void FrameCapture::savePPM(const Frame& frame, const std::string& path) {
+    bool bgra;
+    switch (frame.format) {
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        bgra = true;
+        break;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        bgra = false;
+        break;
+    default:
+        throw std::runtime_error("PPM으로 저장할 수 없는 형식");
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("캡처 파일을 열 수 없음: " + path);
+
+    file << "P6\n" << frame.width << " " << frame.height << "\n255\n";
+
+    std::vector<unsigned char> row(size_t(frame.width) * 3);
+    for (uint32_t y = 0; y < frame.height; y++) {
+        const unsigned char* src = frame.pixels + size_t(y) * frame.width * 4;
+
+        for (uint32_t x = 0; x < frame.width; x++) {
+            row[x * 3 + 0] = src[x * 4 + (bgra ? 2 : 0)];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + (bgra ? 0 : 2)];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+}
+
+void FrameCapture::createSlots() {
+    slotCount = ringSize;
+    slots.reset(new Slot[slotCount]);
+    next = 0;
+
+    std::vector<VkCommandBuffer> recordBuffers(slotCount);
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = slotCount;
+
+    if (vkAllocateCommandBuffers(device, &allocInfo, recordBuffers.data()) != VK_SUCCESS)
+        throw std::runtime_error("frame capture 커맨드 버퍼 할당 오류");
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (uint32_t i = 0; i < slotCount; i++) {
+        Slot& slot = slots[i];
+
+        // 모든 슬롯이 같은 메모리 유형을 고른다
+        coherent = createReadbackBuffer(frameSize, slot.buffer, slot.memory);
+        // 영구 매핑: 소비 스레드가 그대로 읽는다
+        vkMapMemory(device, slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.data);
+
+        slot.commandBuffer = recordBuffers[i];
+        slot.index = 0;
+
+        if (vkCreateFence(device, &fenceInfo, nullptr, &slot.fence) != VK_SUCCESS ||
+            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &slot.semaphore) != VK_SUCCESS)
+            throw std::runtime_error("frame capture 동기화 객체 생성 오류");
+    }
+}
+
+void FrameCapture::destroySlots() {
+    for (uint32_t i = 0; i < slotCount; i++) {
+        Slot& slot = slots[i];
+
+        vkUnmapMemory(device, slot.memory);
+        vkFreeMemory(device, slot.memory, nullptr);
+        vkDestroyBuffer(device, slot.buffer, nullptr);
+
+        vkFreeCommandBuffers(device, commandPool, 1, &slot.commandBuffer);
+        vkDestroyFence(device, slot.fence, nullptr);
+        vkDestroySemaphore(device, slot.semaphore, nullptr);
+    }
+
+    slots.reset();
+    slotCount = 0;
+}
+
+void FrameCapture::collect() {
+    // next부터가 오래된 순서. 한 큐에서 순서대로 끝나므로 아직인 슬롯을 만나면 그 뒤도 아직이다
+    for (uint32_t k = 0; k < slotCount; k++) {
+        uint32_t i = (next + k) % slotCount;
+        Slot& slot = slots[i];
+
+        if (slot.state.load(std::memory_order_acquire) != InFlight)
+            continue;
+        if (vkGetFenceStatus(device, slot.fence) != VK_SUCCESS)
+            break;
+
+        invalidateReadback(slot.memory, coherent);
+        slot.state.store(Consuming, std::memory_order_release);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(i);
+        }
+        readyCondition.notify_one();
+    }
+}
+
+void FrameCapture::consumeLoop() {
+    PROFILE_THREAD("frame capture");
+
+    for (;;) {
+        uint32_t i;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            readyCondition.wait(lock, [this]() { return stopping || !ready.empty(); });
+
+            // stop은 남은 슬롯을 다 넘긴 뒤 stopping을 세운다
+            if (ready.empty())
+                return;
+
+            i = ready.front();
+            ready.pop_front();
+        }
+
+        Slot& slot = slots[i];
+
+        Frame frame{ slot.index, extent.width, extent.height, format, static_cast<const unsigned char*>(slot.data) };
+        PROFILE_ZONE("frame capture/consume");
+        // 소비 스레드에서 던진 예외는 프로세스를 끝내 버리므로 여기서 알리고 다음 프레임으로
+        try {
+            consumer(frame);
+        } catch (const std::exception& e) {
+            std::cerr << "frame capture: " << e.what() << std::endl;
+        }
+
+        capturedCount++;
+        slot.state.store(Free, std::memory_order_release);
+    }
+}
+
+///////////////////////////////////////////////////
+////////////////   GPU PROFILER   /////////////////
+///////////////////////////////////////////////////
+
+void GpuProfiler::requestFeatures(VkPhysicalDeviceFeatures& features) {
+    if (!enabled)
+        return;
+
+    VkPhysicalDeviceFeatures supported;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supported);
+
+    statisticsSupported = supported.pipelineStatisticsQuery;
+    if (statisticsSupported)
+        features.pipelineStatisticsQuery = VK_TRUE;
+}
+
+void GpuProfiler::init(uint32_t queueFamily) {
+    if (!enabled)
+        return;
+
+    uint32_t qFamilyNum;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &qFamilyNum, nullptr);
+    std::vector<VkQueueFamilyProperties> qFamilyProp(qFamilyNum);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &qFamilyNum, qFamilyProp.data());
+
+    uint32_t validBits = qFamilyProp[queueFamily].timestampValidBits;
+    if (validBits == 0) {
+        std::cerr << "timestamp를 지원하지 않는 큐. GPU 프로파일러 비활성화." << std::endl;
+        return;
+    }
+    timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    timestampPeriod = properties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo timestampInfo{};
+    timestampInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    timestampInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    timestampInfo.queryCount = maxScopes * 2;
+
+    VkQueryPoolCreateInfo statisticsInfo{};
+    statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    statisticsInfo.queryCount = maxScopes;
+    // 결과는 비트 순서대로 나온다 (statisticCount와 맞출 것)
+    statisticsInfo.pipelineStatistics =     VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+                                            VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                                            VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                                            VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+                                            VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (vkCreateQueryPool(device, &timestampInfo, nullptr, &timestampPools[i]) != VK_SUCCESS)
+            throw std::runtime_error("timestamp query pool 생성 오류");
+
+        if (statisticsSupported && vkCreateQueryPool(device, &statisticsInfo, nullptr, &statisticsPools[i]) != VK_SUCCESS)
+            throw std::runtime_error("pipeline statistics query pool 생성 오류");
+
+        records[i].clear();
+        statisticsCount[i] = 0;
+    }
+
+    active = true;
+}
+
+void GpuProfiler::destroy() {
+    if (!active)
+        return;
+
+    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        vkDestroyQueryPool(device, timestampPools[i], nullptr);
+        if (statisticsSupported)
+            vkDestroyQueryPool(device, statisticsPools[i], nullptr);
+    }
+
+    active = false;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frame) {
+    if (!active)
+        return;
+
+    // drawFrame이 이 frame의 fence를 기다린 뒤라 지난 결과는 이미 나와 있다
+    collect(frame);
+
+    this->frame = frame;
+    records[frame].clear();
+    statisticsCount[frame] = 0;
+    statisticsOpen = false;
+
+    vkCmdResetQueryPool(commandBuffer, timestampPools[frame], 0, maxScopes * 2);
+    if (statisticsSupported)
+        vkCmdResetQueryPool(commandBuffer, statisticsPools[frame], 0, maxScopes);
+}
+
+uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const std::string& name, bool statistics) {
+    std::vector<Record>& frameRecords = records[frame];
+    if (!active || frameRecords.size() >= maxScopes)
+        return noScope;
+
+    auto it = scopeIds.find(name);
+    uint32_t scope;
+    if (it == scopeIds.end()) {
+        scope = static_cast<uint32_t>(scopes.size());
+        scopeIds.emplace(name, scope);
+
+        scopes.emplace_back();
+        scopes.back().name = name;
+        scopes.back().history.resize(historySize);
+    }
+    else
+        scope = it->second;
+
+    Record record{ scope, noScope };
+
+    // 같은 종류의 query는 동시에 하나만 열 수 있다
+    if (statistics && statisticsSupported && !statisticsOpen) {
+        record.statisticsQuery = statisticsCount[frame]++;
+        statisticsOpen = true;
+        vkCmdBeginQuery(commandBuffer, statisticsPools[frame], record.statisticsQuery, 0);
+    }
+
+    uint32_t index = static_cast<uint32_t>(frameRecords.size());
+    frameRecords.push_back(record);
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPools[frame], index * 2);
+    return index;
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+    if (!active || scope == noScope)
+        return;
+
+    Record& record = records[frame][scope];
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPools[frame], scope * 2 + 1);
+
+    if (record.statisticsQuery != noScope) {
+        vkCmdEndQuery(commandBuffer, statisticsPools[frame], record.statisticsQuery);
+        statisticsOpen = false;
+    }
+}
+
+void GpuProfiler::collect(uint32_t frame) {
+    std::vector<Record>& frameRecords = records[frame];
+    if (frameRecords.empty())
+        return;
+
+    // WAIT 없이 읽는다. 아직이면 (VK_NOT_READY) 이번 샘플은 버린다
+    std::vector<uint64_t> timestamps(frameRecords.size() * 2);
+    VkResult result = vkGetQueryPoolResults(    device, timestampPools[frame], 0, static_cast<uint32_t>(timestamps.size()),
+                                                timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t),
+                                                VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS)
+        return;
+
+    std::vector<uint64_t> statistics(size_t(statisticsCount[frame]) * statisticCount);
+    bool hasStatistics = !statistics.empty() &&
+                        vkGetQueryPoolResults(  device, statisticsPools[frame], 0, statisticsCount[frame],
+                                                statistics.size() * sizeof(uint64_t), statistics.data(), statisticCount * sizeof(uint64_t),
+                                                VK_QUERY_RESULT_64_BIT) == VK_SUCCESS;
+
+    for (size_t i = 0; i < frameRecords.size(); i++) {
+        Scope& scope = scopes[frameRecords[i].scope];
+
+        uint64_t ticks = (timestamps[i * 2 + 1] - timestamps[i * 2]) & timestampMask;
+        addSample(scope, float(double(ticks) * timestampPeriod * 1e-6));
+
+        uint32_t query = frameRecords[i].statisticsQuery;
+        if (hasStatistics && query != noScope) {
+            memcpy(scope.statistics, &statistics[size_t(query) * statisticCount], sizeof(scope.statistics));
+            scope.hasStatistics = true;
+        }
+    }
+
+    // 같은 결과를 두 번 더하지 않도록
+    frameRecords.clear();
+}
+
+void GpuProfiler::addSample(Scope& scope, float ms) {
+    // 한 프레임에 여러 번 나온 구간 (perObject의 같은 이름 등)은 따로 샘플이 된다
+    scope.history[scope.cursor] = ms;
+    scope.cursor = (scope.cursor + 1) % historySize;
+    scope.count = std::min(scope.count + 1, historySize);
+
+    scope.last = ms;
+    scope.min = FLT_MAX;
+    scope.max = 0.0f;
+
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < scope.count; i++) {
+        float sample = scope.history[i];
+        scope.min = std::min(scope.min, sample);
+        scope.max = std::max(scope.max, sample);
+        sum += sample;
+    }
+    scope.avg = sum / scope.count;
+}
+
+void GpuProfiler::report(std::ostream& out) {
+    static const char* statisticNames[statisticCount] = { "ia vertices", "ia primitives", "vs", "clip primitives", "fs", "cs" };
+
+    // 아직 읽지 않은 프레임까지 (GPU가 멈춘 뒤라 기다리지 않는다)
+    if (active)
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+            collect(i);
+
+    out << "GPU scopes (ms, last " << historySize << " samples)" << std::endl;
+    for (const Scope& scope : scopes) {
+        if (scope.count == 0)
+            continue;
+
+        out << "  " << scope.name << " : avg " << scope.avg << " min " << scope.min << " max " << scope.max << std::endl;
+
+        if (scope.hasStatistics) {
+            out << "   ";
+            for (uint32_t i = 0; i < statisticCount; i++)
+                out << " " << statisticNames[i] << " " << scope.statistics[i];
+            out << std::endl;
+        }
+    }
+}
+
+///////////////////////////////////////////////////
+//////////////////   PROFILER   ///////////////////
+///////////////////////////////////////////////////
+
+namespace profiler {
+    // 끝난 스레드의 버퍼도 덤프할 수 있도록 프로세스가 끝날 때까지 둔다
+    static std::mutex registryMutex;
+    static std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+    ThreadBuffer* registerThread() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+
+        registry.emplace_back(new ThreadBuffer());
+        ThreadBuffer* buffer = registry.back().get();
+        buffer->id = static_cast<uint32_t>(registry.size());
+        buffer->name = "thread " + std::to_string(buffer->id);
+
+        return buffer;
+    }
+
+    void setThreadName(const char* name) {
+        ThreadBuffer* buffer = threadBuffer();
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->name = name;
+    }
+
+    void frameMark() {
+        thread_local uint64_t previous = 0;
+
+        uint64_t current = now();
+        if (previous != 0 && enabled.load(std::memory_order_relaxed))
+            record("frame", previous, current);
+        previous = current;
+    }
+
+    static void writeJsonString(std::ostream& out, const char* text) {
+        out << '"';
+        for (const char* c = text; *c; c++) {
+            if (*c == '"' || *c == '\\')
+                out << '\\';
+            out << *c;
+        }
+        out << '"';
+    }
+
+    void writeChromeTrace(const std::string& path) {
+        std::ofstream file(path);
+        if (!file.is_open())
+            throw std::runtime_error("프로파일 파일을 열 수 없음: " + path);
+
+        struct Sample {
+            const char* name;
+            uint64_t begin, end;
+        };
+
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        file << std::fixed;
+        file.precision(3);
+
+        bool first = true;
+        std::lock_guard<std::mutex> lock(registryMutex);
+
+        for (const std::unique_ptr<ThreadBuffer>& buffer : registry) {
+            file << (first ? "\n" : ",\n");
+            first = false;
+
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":";
+            writeJsonString(file, buffer->name.c_str());
+            file << "}}";
+
+            // 쓰는 중인 스레드를 멈추지 않고 읽은 뒤, 그동안 덮어쓰였을 수 있는 칸은 버린다
+            uint64_t written = buffer->written.load(std::memory_order_acquire);
+            uint64_t from = written > ringSize ? written - ringSize : 0;
+
+            std::vector<Sample> samples;
+            samples.reserve(static_cast<size_t>(written - from));
+            for (uint64_t i = from; i < written; i++) {
+                const Event& event = buffer->events[i & (ringSize - 1)];
+                samples.push_back({ event.name.load(std::memory_order_relaxed),
+                                    event.begin.load(std::memory_order_relaxed),
+                                    event.end.load(std::memory_order_relaxed) });
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t started = buffer->started.load(std::memory_order_relaxed);
+            uint64_t valid = started > ringSize ? started - ringSize : 0;
 
-        vkUpdateDescriptorSets(device, descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+            for (uint64_t i = std::max(from, valid); i < written; i++) {
+                const Sample& sample = samples[static_cast<size_t>(i - from)];
+
+                file << ",\n{\"name\":";
+                writeJsonString(file, sample.name);
+                file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                     << ",\"ts\":" << sample.begin * 1e-3 << ",\"dur\":" << (sample.end - sample.begin) * 1e-3 << "}";
+            }
+        }
+
+        file << "\n]}\n";
     }
 }
 
@@ -2645,7 +6792,7 @@ void UI::createDescriptorSets() {
 /////////////////      ETC      ///////////////////
 ///////////////////////////////////////////////////
 
-void copyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize size) {
+void copyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize size, VkDeviceSize dstOffset) {
         // texelUniformBuffer -> texelVertexBuffer
     VkCommandBuffer recordBuffer;
 
@@ -2669,7 +6816,7 @@ void copyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize size) {
     VkBufferCopy bufferCopy{};
     bufferCopy.srcOffset = 0;
     bufferCopy.size = size;
-    bufferCopy.dstOffset = 0;
+    bufferCopy.dstOffset = dstOffset;
 
     vkCmdCopyBuffer(recordBuffer, src, dst, 1, &bufferCopy);
 
@@ -2727,7 +6874,7 @@ void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyF
 }
 
 void createCommandBuffers() {
-    commandBuffers.resize(swapChainFramebuffers.size());
+    commandBuffers.resize(headless ? MAX_FRAMES_IN_FLIGHT : swapChainFramebuffers.size());
 
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -2801,43 +6948,6 @@ glm::mat4 getTranslate(glm::vec3 position) {
     return glm::translate(glm::mat4(1.0f), position);
 }
 
-glm::mat4 getQuart(glm::vec3 rotationAxis, float rotationAngle) {
-    glm::vec4 res(0.0f);
-    float n;
-
-    res.x = rotationAxis.x * sin(rotationAngle / 2);
-    res.y = rotationAxis.y * sin(rotationAngle / 2);
-    res.z = rotationAxis.z * sin(rotationAngle / 2);
-    res.w = cos(rotationAngle / 2);
-
-    n = 1.0f / sqrt(res.x*res.x + res.y*res.y + res.z*res.z + res.w*res.w);
-    res *= n;
-
-    glm::mat4 res2Mat (
-        1.0f - 2.0f*res.y*res.y - 2.0f*res.z*res.z,
-        2.0f*res.x*res.y - 2.0f*res.z*res.w,
-        2.0f*res.x*res.z + 2.0f*res.y*res.w, 
-        0.0f,
-
-        2.0f*res.x*res.y + 2.0f*res.z*res.w,
-        1.0f - 2.0f*res.x*res.x - 2.0f*res.z*res.z, 
-        2.0f*res.y*res.z - 2.0f*res.x*res.w, 
-        0.0f,
-
-        2.0f*res.x*res.z - 2.0f*res.y*res.w, 
-        2.0f*res.y*res.z + 2.0f*res.x*res.w, 
-        1.0f - 2.0f*res.x*res.x - 2.0f*res.y*res.y, 
-        0.0f,
-
-        0.0f, 
-        0.0f, 
-        0.0f, 
-        1.0f
-    );
-
-    return res2Mat;
-}
-
 glm::mat4 lookAt(glm::vec3 camPos, glm::vec3 target) {
     glm::vec3 normUp (0.0f, 1.0f, 0.0f);
 
@@ -2860,178 +6970,94 @@ glm::mat4 lookAt(glm::vec3 camPos, glm::vec3 target) {
     return res;
 }
 
-void updateUniformBuffer(uint32_t currentImage, GameObject* gameObject, Models* m) {
+// 카메라 view / 투영은 물체와 무관하므로 프레임마다 한 번만 계산
+static void computeViewProj(glm::mat4& view, glm::mat4& proj) {
     Camera* cam = cameraObejctList[0];
-    Light* light = lightObjectList[0];
-
-    glm::vec3 totPos(       gameObject->Position.x + m->Position.x,
-                            gameObject->Position.y + m->Position.y,
-                            gameObject->Position.z + m->Position.z
-                    );
-
-    glm::vec3 totRot(       gameObject->Rotation.x + m->Rotate.x,
-                            gameObject->Rotation.y + m->Rotate.y,
-                            gameObject->Rotation.z + m->Rotate.z
-                    );
-
-    glm::vec3 totScale(     gameObject->Scale.x * m->Scale.x,
-                            gameObject->Scale.y * m->Scale.y,
-                            gameObject->Scale.z * m->Scale.z
-                    );
-
-    glm::mat4 RotX = glm::rotate(glm::mat4(1.0f), glm::radians(totRot.x), glm::vec3(1, 0, 0));
-    glm::mat4 RotY = glm::rotate(glm::mat4(1.0f), glm::radians(totRot.y), glm::vec3(0, 1, 0));
-    glm::mat4 RotZ = glm::rotate(glm::mat4(1.0f), glm::radians(totRot.z), glm::vec3(0, 0, 1));
-
-    UniformBufferObject ubo{};
-    ubo.model   =   glm::translate(glm::mat4(1.0f), totPos) 
-                    * RotX 
-                    * RotY 
-                    * RotZ 
-                    * glm::scale(glm::mat4(1.0f), totScale);
-
-    ubo.pitch   = glm::rotate(glm::mat4(1.0f), glm::radians(cam->getRotate().x), glm::vec3(1.0f, 0.0f, 0.0f));
-    ubo.yaw     = glm::rotate(glm::mat4(1.0f), glm::radians(cam->getRotate().y), glm::vec3(0.0f, 1.0f, 0.0f));
-    ubo.roll    = glm::rotate(glm::mat4(1.0f), glm::radians(cam->getRotate().z), glm::vec3(0.0f, 0.0f, 1.0f));
 
+    // 카메라 회전(pitch * yaw * roll)을 view 앞에 미리 곱한다
     if (!cam->target)
-        ubo.view = glm::lookAt(cam->getPosition(), cam->getPosition() + cam->getFront(), glm::vec3(0, 1, 0));
+        view = cam->getRotationMatrix() * glm::lookAt(cam->getPosition(), cam->getPosition() + cam->getFront(), glm::vec3(0, 1, 0));
     else
-        ubo.view = lookAt(cam->getPosition(), cam->target->Position); 
-    ubo.proj    = getPersp();
-
-    lightVec = light->getPosition() - gameObject->getPosition();
-    lightVec.z *= -1.0f;
-
-    void* data;
-
-    vkMapMemory(device, m->uniformBuffersMemory[currentImage], 0, sizeof(ubo), 0, &data);
-    memcpy(data, &ubo, sizeof(ubo));
-    vkUnmapMemory(device, m->uniformBuffersMemory[currentImage]);
+        view = cam->getRotationMatrix() * lookAt(cam->getPosition(), cam->target->transform.getWorldPosition()); 
+    proj = getPersp();
 }
 
-void getBufferData(VkBuffer buffer, VkDeviceSize deviceSize) {
-    VkBuffer stagingBuf;
-    VkDeviceMemory stagingMem;
-
-    VkBufferCreateInfo bufCreateInfo{};
-    bufCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufCreateInfo.pNext = 0;
-    bufCreateInfo.flags = 0;
-    bufCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-    bufCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    bufCreateInfo.size = deviceSize;
-
-    vkCreateBuffer(device, &bufCreateInfo, 0, &stagingBuf);
-
-    VkPhysicalDeviceMemoryProperties memProp;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProp);
-
-    VkMemoryRequirements memReq;
-    vkGetBufferMemoryRequirements(device, stagingBuf, &memReq);
-
-    int memTypeIdx = -1;
-    for (int i = 0; i < memProp.memoryTypeCount; i++) {
-        if (memReq.memoryTypeBits & (1 << i) && memProp.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT == VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
-            memTypeIdx = i;
-        }
-    }
-
-    if (memTypeIdx == -1) 
-        throw std::runtime_error("staging buffer에서 원하는 메모리 유형을 찾을 수 없음.");
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.pNext = 0;
-    allocInfo.memoryTypeIndex = memTypeIdx;
-    allocInfo.allocationSize = memReq.size;
-
-    vkAllocateMemory(device, &allocInfo, 0, &stagingMem);
-
-    vkBindBufferMemory(device, stagingBuf, stagingMem, 0);
-
-    void* data;
-    vkMapMemory(device, stagingMem, 0, deviceSize, 0, &data);
-
-    VkCommandBuffer recordBuffer;
-
-    VkCommandBufferAllocateInfo cmdbufallocInfo{};
-    cmdbufallocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    cmdbufallocInfo.pNext = 0;
-    cmdbufallocInfo.commandPool = commandPool;
-    cmdbufallocInfo.commandBufferCount = 1;
-    cmdbufallocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-
-    vkAllocateCommandBuffers(device, &cmdbufallocInfo, &recordBuffer);
-
-    VkCommandBufferBeginInfo cmdbufBeginInfo{};
-    cmdbufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    cmdbufBeginInfo.pNext = 0;
-    cmdbufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    cmdbufBeginInfo.pInheritanceInfo = 0;
-
-    vkBeginCommandBuffer(recordBuffer, &cmdbufBeginInfo);
-
-    VkBufferCopy bufferCopy{};
-    bufferCopy.srcOffset = 0;
-    bufferCopy.size = deviceSize;
-    bufferCopy.dstOffset = 0;
-
-    vkCmdCopyBuffer(recordBuffer, buffer, stagingBuf, 1, &bufferCopy);
-
-    vkEndCommandBuffer(recordBuffer);
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.pNext = 0;
-    submitInfo.commandBufferCount = 0;
-    submitInfo.pCommandBuffers = &recordBuffer;
-
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, 0);
-
-    std::vector<float> res(8);
-    memcpy(res.data(), &data, deviceSize);
+void updateUniformBuffer(uint32_t frame, GameObject* gameObject, Models* m, const glm::mat4& view, const glm::mat4& proj) {
+    Light* light = lightObjectList[0];
 
-    for (int i = 0; i < 8; i++)
-        std::cout << res[i] << ", ";
-    std::cout << std::endl;
+    // bodyStore는 물리 스레드가 쓰는 중일 수 있으므로 렌더링 쪽 transform 값을 읽는다
+    lightVec = light->getPosition() - gameObject->transform.getPosition();
+    lightVec.z *= -1.0f;
 
-    vkQueueWaitIdle(graphicsQueue);
+    // bindless는 draw 버퍼, 아니면 모델의 프레임별 UBO. 둘 다 영구 매핑이라 map / unmap 없이 바로 쓴다
+    UniformBufferObject* ubo = enableBindless
+                                ? static_cast<UniformBufferObject*>(bindlessDrawDataPoint[frame]) + m->drawIndex
+                                : static_cast<UniformBufferObject*>(m->uniformBuffersMapped[frame]);
 
-    vkUnmapMemory(device, stagingMem);
-    vkFreeMemory(device, stagingMem, 0);
-    vkDestroyBuffer(device, stagingBuf, 0);
+    // 바뀐 노드만 다시 계산되고, 정적인 물체는 캐시된 행렬을 그대로 쓴다.
+    // GameObject 루트의 로컬 행렬은 bodyStore가 composeModelMatrices로 한꺼번에 만들어 둔 값
+    ubo->model  = m->transform.getWorldMatrix();
+    ubo->view   = view;
+    ubo->proj   = proj;
 }
 
 void drawFrame() {
+    PROFILE_ZONE("drawFrame");
+
     Camera* mainCam = cameraObejctList.at(0);
 
     // Begin
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    {
+        PROFILE_ZONE("drawFrame/wait fence");
+        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    }
 
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(    device, 
-                                                swapChain, 
-                                                UINT64_MAX, 
-                                                imageAvailableSemaphores[currentFrame], 
-                                                VK_NULL_HANDLE, 
-                                                &imageIndex);
-
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        recreateSwapChain();
-        return;
-    } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        throw std::runtime_error("failed to acquire swap chain image!");
+    // 이 프레임에서 쓰던 임시 디스크립터 셋 반환
+    frameDescriptorAllocators[currentFrame].reset();
+
+    // 바뀐 물체의 위치 / 회전 / 크기를 transform에 반영.
+    // 고정 step이 돌고 있으면 마지막 두 step 사이를 보간한다.
+    if (physicsScheduler.isRunning()) {
+        std::lock_guard<std::mutex> lock(physicsScheduler.mutex);
+        bodyStore.syncInterpolated(physicsScheduler.getAlpha());
     }
+    else
+        bodyStore.syncTransforms();
+
+    uint32_t imageIndex;
+    VkResult result;
+
+    // headless는 acquire / present 없이 screenImage 하나에 그리고, 이미지마다 두는 자원은 프레임 번호로 고른다
+    if (headless)
+        imageIndex = currentFrame;
+    else {
+        PROFILE_ZONE("drawFrame/acquire");
+
+        result = vkAcquireNextImageKHR(     device, 
+                                            swapChain, 
+                                            UINT64_MAX, 
+                                            imageAvailableSemaphores[currentFrame], 
+                                            VK_NULL_HANDLE, 
+                                            &imageIndex);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreateSwapChain();
+            return;
+        } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            throw std::runtime_error("failed to acquire swap chain image!");
+        }
 
-    // 이전의 사진이 그려지는 중이나 프레젠테이션 중이면 대기
-    if (imagesInFlight[imageIndex] != VK_NULL_HANDLE) {
-        vkWaitForFences(device, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+        // 이전의 사진이 그려지는 중이나 프레젠테이션 중이면 대기
+        if (imagesInFlight[imageIndex] != VK_NULL_HANDLE) {
+            vkWaitForFences(device, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+        }
+        imagesInFlight[imageIndex] = inFlightFences[currentFrame];
     }
-    imagesInFlight[imageIndex] = inFlightFences[currentFrame];
 
     VkCommandBuffer commandBuffer;
 
+    PROFILE_BEGIN(recordZone, "drawFrame/record");
+
     // begin
     commandBuffer = commandBuffers[currentFrame];
 
@@ -3042,11 +7068,14 @@ void drawFrame() {
 
     vkBeginCommandBuffer(commandBuffers[currentFrame], &cmdbufbeginInfo);
 
+    gpuProfiler.beginFrame(commandBuffer, currentFrame);
+    uint32_t frameScope = gpuProfiler.beginScope(commandBuffer, "frame");
+
     // GameObject
     VkRenderPassBeginInfo renderPassBeginInfo{};
     renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassBeginInfo.pNext = nullptr;
-    renderPassBeginInfo.framebuffer = swapChainFramebuffers[imageIndex];
+    renderPassBeginInfo.framebuffer = headless ? screenFramebuffers[0] : swapChainFramebuffers[imageIndex];
     renderPassBeginInfo.renderArea.offset = {0, 0};
     renderPassBeginInfo.renderArea.extent = swapChainExtent;
     renderPassBeginInfo.renderPass = renderPass;
@@ -3064,7 +7093,54 @@ void drawFrame() {
     }
 
     VkDeviceSize deviceOffset = {0};
+
+    // 이번 프레임의 set 0 (UBO / texel buffer)
+    if (!enableBindless) {
+        PROFILE_ZONE("drawFrame/frame sets");
+        for (GameObject* obj : gameObjectList)
+            obj->allocateFrameSets();
+    }
+
+    // 프레임이 겹치므로 이전 프레임이 compute 결과를 다 읽은 뒤에 다시 쓴다
+    VkMemoryBarrier computeBarrier{};
+    computeBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    computeBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    computeBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(   commandBuffer, 
+                            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+                            0, 1, &computeBarrier, 0, nullptr, 0, nullptr);
+
+    uint32_t computeScope = gpuProfiler.beginScope(commandBuffer, "compute", true);
+
+    // bindless : 프레임당 한 번만 셋을 바인딩
+    if (enableBindless) {
+        vkCmdBindDescriptorSets(    commandBuffer, 
+                                    VK_PIPELINE_BIND_POINT_COMPUTE, 
+                                    bindlessComputePipelineLayout, 
+                                    0, 
+                                    1, 
+                                    &bindlessDescriptorSets[currentFrame], 
+                                    0, 
+                                    nullptr);
+
+        vkCmdPushConstants( commandBuffer, 
+                            bindlessComputePipelineLayout, 
+                            VK_SHADER_STAGE_COMPUTE_BIT, 
+                            0, 
+                            sizeof(ComputeConstantLayouts), 
+                            &ComputeConstantLayouts 
+                        );
+    }
+
     for (GameObject* obj : gameObjectList) {
+        if (enableBindless) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, obj->computesPipeline);
+            vkCmdDispatch( commandBuffer, 2, 1, 1);
+            continue;
+        }
+
         for (Models* m : obj->models) {
             // compute pipeline
             vkCmdBindDescriptorSets(    commandBuffer, 
@@ -3072,7 +7148,7 @@ void drawFrame() {
                                         obj->computePipelineLayout, 
                                         0, 
                                         1, 
-                                        &m->descriptorSets[currentFrame], 
+                                        &m->frameSet, 
                                         0, 
                                         nullptr);
         }
@@ -3093,50 +7169,119 @@ void drawFrame() {
         vkCmdDispatch( commandBuffer, 2, 1, 1);
     }
 
+    gpuProfiler.endScope(commandBuffer, computeScope);
+
+    // compute 결과를 이번 프레임의 draw가 읽도록
+    computeBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(   commandBuffer, 
+                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+                            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
+                            0, 1, &computeBarrier, 0, nullptr, 0, nullptr);
+
     vkCmdBeginRenderPass(   commandBuffer, 
                             &renderPassBeginInfo, 
                             VK_SUBPASS_CONTENTS_INLINE);
 
-    for (GameObject* obj : gameObjectList) {
-        for (Models* m : obj->models) {
-            // update UBO
-            updateUniformBuffer(imageIndex, obj, m);
+    // statistics는 같은 subpass 안에서 열고 닫는다
+    uint32_t opaqueScope = gpuProfiler.beginScope(commandBuffer, "opaque", true);
+
+    glm::mat4 view, proj;
+    computeViewProj(view, proj);
+
+    // 같은 블록, 같은 인덱스 타입을 쓰는 연속된 draw는 vertex / index 버퍼를 다시 바인딩하지 않음
+    GeometryBlock* boundBlock = nullptr;
+    VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+
+    if (enableBindless) {
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bindlessPipelineLayout, 0, 1, &bindlessDescriptorSets[currentFrame], 0, nullptr);
+        vkCmdPushConstants(commandBuffer, bindlessPipelineLayout, VK_SHADER_STAGE_ALL_GRAPHICS, 0, sizeof(GraphicsConstantLayouts), &GraphicsConstantLayouts);
+
+        for (GameObject* obj : gameObjectList) {
+            uint32_t objectScope = gpuProfiler.perObject ? gpuProfiler.beginScope(commandBuffer, obj->Name) : GpuProfiler::noScope;
+
+            for (Models* m : obj->models) {
+                updateUniformBuffer(static_cast<uint32_t>(currentFrame), obj, m, view, proj);
+
+                BindlessDrawConstants drawConstants{ m->drawIndex, m->textureIndex, m->alphaIndex };
 
-            // graphcis pipeline
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m->graphicsPipeline);
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m->graphicsPipeline);
 
-            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m->vertexBuffer, &deviceOffset);
-            vkCmdBindIndexBuffer(commandBuffer, m->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+                if (m->geometryBlock != boundBlock) {
+                    boundBlock = m->geometryBlock;
+                    boundIndexType = m->indexType;
+                    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &boundBlock->vertexBuffer, &deviceOffset);
+                    vkCmdBindIndexBuffer(commandBuffer, boundBlock->indexBuffer, 0, boundIndexType);
+                }
+                else if (m->indexType != boundIndexType) {
+                    boundIndexType = m->indexType;
+                    vkCmdBindIndexBuffer(commandBuffer, boundBlock->indexBuffer, 0, boundIndexType);
+                }
 
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, obj->pipelineLayout, 0, 1, &m->descriptorSets[currentFrame], 0, nullptr);
-            vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(m->indices.size()), 1, 0, 0, 0);
+                vkCmdPushConstants(commandBuffer, bindlessPipelineLayout, VK_SHADER_STAGE_ALL_GRAPHICS, sizeof(GraphicsConstantLayouts), sizeof(BindlessDrawConstants), &drawConstants);
+                vkCmdDrawIndexed(commandBuffer, m->indexCount, 1, m->firstIndex, m->vertexOffset, 0);
+            }
 
-            vkCmdPushConstants(commandBuffer, obj->pipelineLayout, VK_SHADER_STAGE_ALL_GRAPHICS, 0, sizeof(GraphicsConstantLayouts), &GraphicsConstantLayouts);
+            gpuProfiler.endScope(commandBuffer, objectScope);
         }
     }
+    else {
+        for (GameObject* obj : gameObjectList) {
+            uint32_t objectScope = gpuProfiler.perObject ? gpuProfiler.beginScope(commandBuffer, obj->Name) : GpuProfiler::noScope;
+
+            for (Models* m : obj->models) {
+                // update UBO
+                updateUniformBuffer(static_cast<uint32_t>(currentFrame), obj, m, view, proj);
+
+                // graphcis pipeline
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m->graphicsPipeline);
+
+                if (m->geometryBlock != boundBlock) {
+                    boundBlock = m->geometryBlock;
+                    boundIndexType = m->indexType;
+                    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &boundBlock->vertexBuffer, &deviceOffset);
+                    vkCmdBindIndexBuffer(commandBuffer, boundBlock->indexBuffer, 0, boundIndexType);
+                }
+                else if (m->indexType != boundIndexType) {
+                    boundIndexType = m->indexType;
+                    vkCmdBindIndexBuffer(commandBuffer, boundBlock->indexBuffer, 0, boundIndexType);
+                }
+
+                VkDescriptorSet sets[] = { m->frameSet, m->materialSet };
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, obj->pipelineLayout, 0, 2, sets, 0, nullptr);
+                vkCmdDrawIndexed(commandBuffer, m->indexCount, 1, m->firstIndex, m->vertexOffset, 0);
 
-    for (UI* obj : UIList) {
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, obj->graphicsPipeline);
+                vkCmdPushConstants(commandBuffer, obj->pipelineLayout, VK_SHADER_STAGE_ALL_GRAPHICS, 0, sizeof(GraphicsConstantLayouts), &GraphicsConstantLayouts);
+            }
 
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &obj->vertexBuffer, &deviceOffset);
-        vkCmdBindIndexBuffer(commandBuffer, obj->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, obj->pipelineLayout, 0, 1, &obj->descriptorSets[currentFrame], 0, nullptr);
-        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(obj->indices.size()), 1, 0, 0, 0);
+            gpuProfiler.endScope(commandBuffer, objectScope);
+        }
     }
 
+    gpuProfiler.endScope(commandBuffer, opaqueScope);
+
+    // 모든 UI를 한 정점 버퍼에 모아 한 번에
+    uint32_t uiScope = gpuProfiler.beginScope(commandBuffer, "ui", true);
+    uiBatcher.record(commandBuffer, currentFrame);
+    gpuProfiler.endScope(commandBuffer, uiScope);
+
     vkCmdEndRenderPass(commandBuffer);
 
+    gpuProfiler.endScope(commandBuffer, frameScope);
+
     // CommandBuffer의 레코딩을 끝낸다
     if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
         throw std::runtime_error("커맨드 버퍼의 레코딩에 실패하였습니다!");
     }
 
+    PROFILE_END(recordZone);
+
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
     VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
     VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = headless ? 0 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
 
@@ -3144,37 +7289,54 @@ void drawFrame() {
     submitInfo.pCommandBuffers = &commandBuffer;
     
     VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = headless ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
+    PROFILE_BEGIN(submitZone, "drawFrame/submit");
+
     vkResetFences(device, 1, &inFlightFences[currentFrame]);
 
     if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
         throw std::runtime_error("failed to submit draw command buffer!");
     }
 
-    VkPresentInfoKHR presentInfo{};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    // 그린 이미지를 readback ring으로 복사. 창 모드는 present가 복사 뒤에 오도록 semaphore를 바꿔 끼운다
+    VkSemaphore presentWait = signalSemaphores[0];
+    if (frameCapture.isActive()) {
+        VkSemaphore captured = frameCapture.capture(    headless ? screenImage : swapChainImages[imageIndex],
+                                                        headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                                                        headless ? VK_NULL_HANDLE : signalSemaphores[0]);
+        if (captured != VK_NULL_HANDLE)
+            presentWait = captured;
+    }
+
+    PROFILE_END(submitZone);
+
+    if (!headless) {
+        PROFILE_ZONE("drawFrame/present");
 
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
-    VkSwapchainKHR swapChains[] = {swapChain};
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = swapChains;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &presentWait;
 
-    presentInfo.pImageIndices = &imageIndex;
+        VkSwapchainKHR swapChains[] = {swapChain};
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = swapChains;
 
-    result = vkQueuePresentKHR(presentQueue, &presentInfo);
+        presentInfo.pImageIndices = &imageIndex;
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized) {
-        framebufferResized = false;
-        recreateSwapChain();
-    } else if (result != VK_SUCCESS) {
-        throw std::runtime_error("failed to present swap chain image!");
+        result = vkQueuePresentKHR(presentQueue, &presentInfo);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized) {
+            framebufferResized = false;
+            recreateSwapChain();
+        } else if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to present swap chain image!");
+        }
     }
 
-    vkQueueWaitIdle(presentQueue);
     currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
 
@@ -3219,9 +7381,29 @@ UI* createUI(   std::string Name,
     UIList.push_back(newUIObject);
     newUIObject->setIndex(UIList.size());
 
+    if (clickable)
+        uiHitIndex.insert(newUIObject);
+
     return UIList[newUIObject->getIndex() - 1];
 } 
 
+// uiBatcher.init 이후 (initVulkan 뒤, Start 등에서)
+Font* createFont(std::string path, float pixelHeight = 32.0f) {
+    Font* newFont = new Font(path, pixelHeight);
+    fontList.push_back(newFont);
+
+    return newFont;
+}
+
+Text* createText(Font* font, std::string text, glm::vec2 position = glm::vec2(0.0f), int zOrder = 0) {
+    Text* newText = new Text(font, text, position);
+    newText->setZOrder(zOrder);
+    textList.push_back(newText);
+    uiBatcher.touchLayout();
+
+    return newText;
+}
+
 Camera* createCamera(glm::vec3 position = glm::vec3(0.0f), glm::vec3 rotation = glm::vec3(0.0f)) {
     Camera* newCamObject = new Camera(position, rotation);
 
@@ -3240,81 +7422,330 @@ Light* createLight(glm::vec3 position = glm::vec3(0.0f), glm::vec3 rotation = gl
     return lightObjectList[newLightObject->getIndex()];
 } 
 
-bool input::getKeyDown(int key) {
-    if (!keyLock && glfwGetKey(window, key)){
-        keyLock = true;
-        return true;
+static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (key < 0)
+        return;
+    input::push({ InputEvent::Key, key, action, 0.0, 0.0, glfwGetTime() });
+}
+
+static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+    input::push({ InputEvent::MouseButton, button, action, 0.0, 0.0, glfwGetTime() });
+}
+
+static void cursorPosCallback(GLFWwindow* window, double x, double y) {
+    input::push({ InputEvent::MouseMove, 0, 0, x, y, glfwGetTime() });
+}
+
+static void scrollCallback(GLFWwindow* window, double x, double y) {
+    input::push({ InputEvent::Scroll, 0, 0, x, y, glfwGetTime() });
+}
+
+// held / pressed / released 비트를 action에 맞춰 바꾼다. REPEAT은 상태를 바꾸지 않는다.
+static void applyTransition(uint8_t& state, double& time, const InputEvent& e) {
+    if (e.action == GLFW_PRESS) {
+        state |= InputSnapshot::held | InputSnapshot::pressed;
+        time = e.time;
     }
-    else if (!glfwGetKey(window, key)) {
-        keyLock = false;
+    else if (e.action == GLFW_RELEASE) {
+        state = (state & ~InputSnapshot::held) | InputSnapshot::released;
+        time = e.time;
     }
-    return false;
 }
-bool input::getKey(int key) {
-    if (glfwGetKey(window, key)){
-        return true;
+
+void input::init(GLFWwindow* window) {
+    glfwSetKeyCallback(window, keyCallback);
+    glfwSetMouseButtonCallback(window, mouseButtonCallback);
+    glfwSetCursorPosCallback(window, cursorPosCallback);
+    glfwSetScrollCallback(window, scrollCallback);
+
+    // 첫 이동 전에도 getMousePos가 맞도록
+    double x, y;
+    glfwGetCursorPos(window, &x, &y);
+    push({ InputEvent::MouseMove, 1, 0, x, y, glfwGetTime() });
+}
+
+void input::push(const InputEvent& e) {
+    events.push(e);
+}
+
+void input::update() {
+    for (uint8_t& k : snapshot.keys)
+        k &= InputSnapshot::held;
+    for (uint8_t& b : snapshot.buttons)
+        b &= InputSnapshot::held;
+
+    snapshot.mouseDelta = glm::dvec2(0.0);
+    snapshot.scroll = glm::dvec2(0.0);
+    snapshot.eventCount = 0;
+
+    InputEvent e;
+    while (events.pop(e)) {
+        switch (e.type) {
+        case InputEvent::Key:
+            // GLFW_KEY_UNKNOWN(-1)도 들어온다
+            if (e.code >= 0 && e.code < InputSnapshot::keyCount)
+                applyTransition(snapshot.keys[e.code], snapshot.keyTime[e.code], e);
+            break;
+        case InputEvent::MouseButton:
+            if (e.code >= 0 && e.code < InputSnapshot::buttonCount)
+                applyTransition(snapshot.buttons[e.code], snapshot.buttonTime[e.code], e);
+            break;
+        case InputEvent::MouseMove:
+            // raw 모드에서는 이벤트가 매우 잦으므로 이동량만 더한다
+            if (snapshot.hasMousePos && e.code == 0)
+                snapshot.mouseDelta += glm::dvec2(e.x, e.y) - snapshot.mousePos;
+            snapshot.mousePos = glm::dvec2(e.x, e.y);
+            snapshot.hasMousePos = true;
+            break;
+        case InputEvent::Scroll:
+            snapshot.scroll += glm::dvec2(e.x, e.y);
+            break;
+        }
+
+        snapshot.eventCount++;
     }
-    return false;
+
+    snapshot.time = glfwGetTime();
+}
+
+bool input::setRawMouse(bool enable) {
+    if (enable && !glfwRawMouseMotionSupported())
+        return false;
+
+    glfwSetInputMode(window, GLFW_CURSOR, enable ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL);
+    glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, enable ? GLFW_TRUE : GLFW_FALSE);
+
+    // 모드가 바뀌면 커서 좌표계가 바뀌므로 다음 위치는 delta 없이 기준만 잡는다
+    double x, y;
+    glfwGetCursorPos(window, &x, &y);
+    push({ InputEvent::MouseMove, 1, 0, x, y, glfwGetTime() });
+    return true;
+}
+
+const InputSnapshot& input::getSnapshot() {
+    return snapshot;
+}
+
+// 범위를 벗어난 key / button은 눌리지 않은 것으로 본다
+static uint8_t keyBits(int key) {
+    return (key >= 0 && key < InputSnapshot::keyCount) ? input::snapshot.keys[key] : 0;
+}
+static uint8_t buttonBits(int button) {
+    return (button >= 0 && button < InputSnapshot::buttonCount) ? input::snapshot.buttons[button] : 0;
+}
+
+bool input::getKeyDown(int key) {
+    return keyBits(key) & InputSnapshot::pressed;
+}
+bool input::getKey(int key) {
+    return keyBits(key) & InputSnapshot::held;
 }
 bool input::getKeyUp(int key) {
-    if (keyLock && !glfwGetKey(window, key)){
-        keyLock = false;
-        return true;
-    }
-    return false;
+    return keyBits(key) & InputSnapshot::released;
+}
+double input::getKeyTime(int key) {
+    return (key >= 0 && key < InputSnapshot::keyCount) ? snapshot.keyTime[key] : 0.0;
 }
 
 bool input::getMouseButtonDown(int key) {
-    if (!mouseLock && glfwGetMouseButton(window, key)){
-        mouseLock = true;
-        return true;
-    }
-    else if (!glfwGetMouseButton(window, key)) {
-        mouseLock = false;
-    }
-    return false;
+    return buttonBits(key) & InputSnapshot::pressed;
 }
-
 bool input::getMouseButton(int key) {
-    if (glfwGetMouseButton(window, key))
-        return true;
-    return false;
+    return buttonBits(key) & InputSnapshot::held;
 }
-
 bool input::getMouseButtonUp(int key) {
-    if (mouseLock && !glfwGetMouseButton(window, key)){
-        mouseLock = false;
-        return true;
-    }
-    return false;
+    return buttonBits(key) & InputSnapshot::released;
 }
 
 void input::getMousePos(double& w, double& h) {
-    glfwGetCursorPos(window, &w, &h);
+    w = snapshot.mousePos.x;
+    h = snapshot.mousePos.y;
+}
+void input::getMouseDelta(double& dx, double& dy) {
+    dx = snapshot.mouseDelta.x;
+    dy = snapshot.mouseDelta.y;
 }
 int input::getMouseVAxis() {
-    _vpX = _vX;
-    _vpY = _vY;
-    glfwGetCursorPos(window, &_vX, &_vY);
-
-    if ((_vY - _vpY) > 0.0f) {
-        return 1;
-    } else if ((_vY - _vpY) < 0.0f) {
-        return -1;
-    } else {
-        return 0;
-    }
+    return (snapshot.mouseDelta.y > 0.0) - (snapshot.mouseDelta.y < 0.0);
 }
 int input::getMouseHAxis() {
-    _hpX = _hX;
-    _hpY = _hY;
-    glfwGetCursorPos(window, &_hX, &_hY);
-    
-    if ((_hX - _hpX) > 0.0f) {
-        return 1;
-    } else if ((_hX - _hpX) < 0.0f) {
-        return -1;
-    } else {
-        return 0;
+    return (snapshot.mouseDelta.x > 0.0) - (snapshot.mouseDelta.x < 0.0);
+}
+
+template <typename T>
+static void writePod(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool readPod(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+// 프레임 안의 마우스 / 휠 필드
+enum : uint8_t { replayMousePos = 1, replayMouseDelta = 2, replayScroll = 4 };
+
+void InputReplay::startRecording(const std::string& path) {
+    stop();
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("입력 기록 파일을 열 수 없음: " + path);
+    }
+
+    out.write("VKIR", 4);
+    writePod(out, version);
+
+    state = InputSnapshot();
+    frameCount = 0;
+    mode = Recording;
+}
+
+void InputReplay::startReplay(const std::string& path) {
+    stop();
+
+    in.open(path, std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("입력 재생 파일을 열 수 없음: " + path);
+    }
+
+    char magic[4];
+    uint32_t fileVersion;
+    if (!in.read(magic, 4) || memcmp(magic, "VKIR", 4) != 0 || !readPod(in, fileVersion) || fileVersion != version) {
+        throw std::runtime_error("입력 재생 파일 형식이 다름: " + path);
+    }
+
+    state = InputSnapshot();
+    frameCount = 0;
+    time = 0.0;
+    wallStart = std::chrono::steady_clock::now();
+    mode = Replaying;
+}
+
+void InputReplay::stop() {
+    if (mode == Replaying && frameCount > 0) {
+        double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+        std::cout << "replay: " << frameCount << " frames, " << wall / frameCount << " ms/frame" << std::endl;
+    }
+
+    if (out.is_open())
+        out.close();
+    if (in.is_open())
+        in.close();
+
+    mode = Off;
+}
+
+void InputReplay::writeFrame(float frameTime) {
+    const InputSnapshot& s = input::getSnapshot();
+
+    // key는 0 ~ keyCount-1, button은 keyCount부터
+    std::vector<std::pair<uint16_t, uint8_t>> changes;
+    for (int k = 0; k < InputSnapshot::keyCount; k++)
+        if (s.keys[k] != state.keys[k])
+            changes.push_back({ static_cast<uint16_t>(k), s.keys[k] });
+    for (int b = 0; b < InputSnapshot::buttonCount; b++)
+        if (s.buttons[b] != state.buttons[b])
+            changes.push_back({ static_cast<uint16_t>(InputSnapshot::keyCount + b), s.buttons[b] });
+
+    uint8_t flags = 0;
+    if (s.mousePos != state.mousePos)
+        flags |= replayMousePos;
+    if (s.mouseDelta != glm::dvec2(0.0))
+        flags |= replayMouseDelta;
+    if (s.scroll != glm::dvec2(0.0))
+        flags |= replayScroll;
+
+    writePod(out, frameTime);
+    writePod(out, static_cast<uint16_t>(changes.size()));
+    for (const auto& change : changes) {
+        writePod(out, change.first);
+        writePod(out, change.second);
+    }
+
+    writePod(out, flags);
+    if (flags & replayMousePos)
+        writePod(out, s.mousePos);
+    if (flags & replayMouseDelta)
+        writePod(out, s.mouseDelta);
+    if (flags & replayScroll)
+        writePod(out, s.scroll);
+
+    state = s;
+}
+
+bool InputReplay::readFrame(float& frameTime) {
+    uint16_t count;
+    if (!readPod(in, frameTime) || !readPod(in, count))
+        return false;
+
+    time += frameTime;
+
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t code;
+        uint8_t bits;
+        if (!readPod(in, code) || !readPod(in, bits))
+            return false;
+
+        bool transition = bits & (InputSnapshot::pressed | InputSnapshot::released);
+        if (code < InputSnapshot::keyCount) {
+            state.keys[code] = bits;
+            if (transition)
+                state.keyTime[code] = time;
+        }
+        else if (code < InputSnapshot::keyCount + InputSnapshot::buttonCount) {
+            state.buttons[code - InputSnapshot::keyCount] = bits;
+            if (transition)
+                state.buttonTime[code - InputSnapshot::keyCount] = time;
+        }
+    }
+
+    uint8_t flags;
+    if (!readPod(in, flags))
+        return false;
+
+    state.mouseDelta = glm::dvec2(0.0);
+    state.scroll = glm::dvec2(0.0);
+
+    if ((flags & replayMousePos) && !readPod(in, state.mousePos))
+        return false;
+    if ((flags & replayMouseDelta) && !readPod(in, state.mouseDelta))
+        return false;
+    if ((flags & replayScroll) && !readPod(in, state.scroll))
+        return false;
+
+    state.hasMousePos = state.hasMousePos || (flags & replayMousePos);
+    state.time = time;
+    state.eventCount = 0;
+    return true;
+}
+
+bool InputReplay::frame(float& frameTime, float& totalTime) {
+    if (mode == Recording) {
+        writeFrame(frameTime);
+        frameCount++;
+        return false;
+    }
+
+    if (mode != Replaying)
+        return false;
+
+    float recorded;
+    if (!readFrame(recorded)) {
+        stop();
+        requestClose();
+        return false;
     }
+
+    // 실제 입력은 버리고 기록된 snapshot으로
+    input::snapshot = state;
+
+    frameTime = recorded;
+    totalTime = static_cast<float>(time);
+    frameCount++;
+    return true;
+}
+
+bool replayInputFrame(float& frameTime, float& time) {
+    return inputReplay.frame(frameTime, time);
 }
@@ -6,11 +6,15 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/hash.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <stb_truetype.h>
+
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
 
@@ -24,13 +28,141 @@
 #include <cstring>
 #include <cstdlib>
 #include <cstdint>
+#include <cfloat>
 #include <array>
 #include <optional>
 #include <set>
 #include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define USE_SSE
+#endif
+
+// -mavx2 (또는 -march=native)로 빌드할 때만
+#if defined(USE_SSE) && defined(__AVX2__)
+#define USE_AVX2
+#endif
+
+// CPU 구간 프로파일러. 스레드마다 고정 크기 링에 (이름, 시작, 끝)을 남기고 profiler::writeChromeTrace가
+// chrome://tracing / Perfetto에서 여는 JSON으로 쓴다. -DUSE_TRACY로 빌드하면 같은 매크로가 Tracy로 간다.
+// 이름은 문자열 리터럴만 (포인터를 그대로 저장한다)
+#define PROFILE_CONCAT_(a, b)       a##b
+#define PROFILE_CONCAT(a, b)        PROFILE_CONCAT_(a, b)
+
+#ifdef USE_TRACY
+#include <tracy/Tracy.hpp>
+#include <tracy/TracyC.h>
+
+// ZoneScopedN은 변수 이름이 고정이라 한 스코프에 두 번 쓸 수 없다
+#define PROFILE_ZONE(name)          ZoneNamedN(PROFILE_CONCAT(profileZone, __LINE__), name, true)
+#define PROFILE_BEGIN(zone, name)   TracyCZoneN(zone, name, 1)
+#define PROFILE_END(zone)           TracyCZoneEnd(zone)
+#define PROFILE_FRAME()             FrameMark
+#define PROFILE_THREAD(name)        tracy::SetThreadName(name)
+#else
+#define PROFILE_ZONE(name)          profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_BEGIN(zone, name)   profiler::Zone zone(name)
+#define PROFILE_END(zone)           zone.end()
+#define PROFILE_FRAME()             profiler::frameMark()
+#define PROFILE_THREAD(name)        profiler::setThreadName(name)
+#endif
+
+namespace profiler {
+    // 스레드당 남기는 구간 수. 넘으면 오래된 것부터 덮어쓴다 (2의 거듭제곱)
+    const uint64_t ringSize = 1 << 16;
+
+    // 꺼져 있으면 Zone은 시계도 읽지 않는다
+    std::atomic<bool> enabled{ false };
+
+    // 덤프가 다른 스레드에서 읽으므로 relaxed atomic (x86에서는 일반 load / store)
+    struct Event {
+        std::atomic<const char*> name;
+        std::atomic<uint64_t> begin;
+        std::atomic<uint64_t> end;
+    };
+
+    // 소유 스레드만 쓴다. started를 먼저 올리고 채운 뒤 written을 올린다 (seqlock)
+    struct ThreadBuffer {
+        uint32_t id;
+        std::string name;
+        std::unique_ptr<Event[]> events{ new Event[ringSize] };
+        std::atomic<uint64_t> started{ 0 };
+        std::atomic<uint64_t> written{ 0 };
+    };
+
+    ThreadBuffer* registerThread();
+    void setThreadName(const char* name);
+    // 메인 루프 한 바퀴의 끝. 지난 mark부터를 "frame" 구간으로 남긴다
+    void frameMark();
+    // 지금 링에 남아 있는 구간을 모든 스레드에 대해 쓴다 (기록은 멈추지 않는다)
+    void writeChromeTrace(const std::string& path);
+
+    inline ThreadBuffer* threadBuffer() {
+        thread_local ThreadBuffer* buffer = registerThread();
+        return buffer;
+    }
+
+    // 프로세스 기준 시각 (ns)
+    inline uint64_t now() {
+        static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    inline void record(const char* name, uint64_t begin, uint64_t end) {
+        ThreadBuffer* buffer = threadBuffer();
+
+        uint64_t n = buffer->written.load(std::memory_order_relaxed);
+        buffer->started.store(n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Event& event = buffer->events[n & (ringSize - 1)];
+        event.name.store(name, std::memory_order_relaxed);
+        event.begin.store(begin, std::memory_order_relaxed);
+        event.end.store(end, std::memory_order_relaxed);
+
+        buffer->written.store(n + 1, std::memory_order_release);
+    }
+
+    class Zone {
+    public:
+        explicit Zone(const char* name) : name(nullptr), begin(0) {
+            if (enabled.load(std::memory_order_relaxed)) {
+                this->name = name;
+                begin = now();
+            }
+        }
+
+        ~Zone()                             { end(); }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+        // 스코프보다 먼저 끝낼 때
+        void end() {
+            if (!name)
+                return;
+
+            record(name, begin, now());
+            name = nullptr;
+        }
+
+    private:
+        const char* name;
+        uint64_t begin;
+    };
+}
 
 class GameObject;
 class UI;
+class Text;
 class ColliderBox;
 class Models;
 
@@ -52,6 +184,13 @@ glm::vec3 lightVec = glm::vec3(0.0f);
 uint32_t WIDTH = 2048;
 uint32_t HEIGHT = 860;
 
+// --headless: 창 / surface / swapchain 없이 screenImage에 그린다 (디스플레이 없는 CI, lavapipe 등).
+// UI 배치는 그대로 WIDTH x HEIGHT 기준이고 렌더 해상도만 headlessExtent를 따른다.
+bool headless = false;
+VkExtent2D headlessExtent = { 2048, 860 };
+// headless에서 requestClose가 불림
+bool closeRequested = false;
+
 const int MAX_FRAMES_IN_FLIGHT = 2;
 
 const std::vector<const char*> instanceLayers = {
@@ -80,6 +219,11 @@ const std::vector<const char*> deviceExtensions = {
     // "VK_KHR_pipeline_library",
     // "VK_KHR_maintenance3"
 };
+// bindless 모드에서만 활성화 (createLogicalDevice에서 지원 여부 확인)
+const std::vector<const char*> bindlessDeviceExtensions = {
+    "VK_KHR_maintenance3",
+    "VK_EXT_descriptor_indexing"
+};
 
 #ifdef NDEBUG
 const bool enableValidationLayers = false;
@@ -152,17 +296,35 @@ namespace std {
     };
 }
 
+// 카메라 회전은 view에 미리 곱해서 보낸다
 struct UniformBufferObject {
     alignas(16) glm::mat4 model;
-
-    alignas(16) glm::mat4 pitch;
-    alignas(16) glm::mat4 yaw;
-    alignas(16) glm::mat4 roll;
-
     alignas(16) glm::mat4 view;
     alignas(16) glm::mat4 proj;
 };
 
+// 오일러(도) <-> 쿼터니언. 회전 순서는 기존 행렬과 같은 Rx * Ry * Rz
+glm::quat eulerToQuat(glm::vec3 degrees) {
+    return  glm::angleAxis(glm::radians(degrees.x), glm::vec3(1.0f, 0.0f, 0.0f)) *
+            glm::angleAxis(glm::radians(degrees.y), glm::vec3(0.0f, 1.0f, 0.0f)) *
+            glm::angleAxis(glm::radians(degrees.z), glm::vec3(0.0f, 0.0f, 1.0f));
+}
+
+glm::vec3 quatToEuler(glm::quat q) {
+    glm::mat3 m = glm::mat3_cast(q);
+
+    return glm::degrees(glm::vec3(  atan2f(-m[2][1], m[2][2]),
+                                    asinf(glm::clamp(m[2][0], -1.0f, 1.0f)),
+                                    atan2f(-m[1][0], m[0][0])));
+}
+
+// bindless 모드의 draw 당 상수 (GraphicsConstantLayouts 바로 뒤, offset 64)
+struct BindlessDrawConstants {
+    uint32_t drawIndex;
+    uint32_t textureIndex;
+    uint32_t alphaIndex;
+};
+
 std::vector<float> TexelBufferObject;
 
 GLFWwindow* window;
@@ -185,6 +347,11 @@ VkExtent2D swapChainExtent;
 std::vector<VkImageView> swapChainImageViews;
 std::vector<VkFramebuffer> swapChainFramebuffers;
 
+// 이미지마다 하나씩 두는 자원 (uniform buffer 등)의 수. headless는 swapchain이 없으므로 프레임마다 하나
+size_t swapChainImageCount() {
+    return headless ? MAX_FRAMES_IN_FLIGHT : swapChainImages.size();
+}
+
 VkRenderPass renderPass;
 VkCommandPool commandPool;
 std::vector<VkCommandBuffer> commandBuffers;
@@ -205,6 +372,42 @@ VkImageView depthImageView;
 uint32_t mipLevels;
 VkSampler textureSampler;
 
+// Bindless
+// 전역 텍스처 배열 하나 + 프레임당 디스크립터 셋 하나. Models는 인덱스로만 텍스처를 참조한다.
+// --bindless로 켜고, 장치가 descriptor indexing을 지원하지 않으면 createLogicalDevice에서 false로 되돌린다.
+bool enableBindless = false;
+
+const uint32_t MAX_BINDLESS_TEXTURES = 4096;
+const uint32_t MAX_BINDLESS_DRAWS = 4096;
+uint32_t bindlessTextureCapacity = MAX_BINDLESS_TEXTURES;
+
+VkDescriptorSetLayout bindlessSetLayout;
+VkDescriptorPool bindlessDescriptorPool;
+std::vector<VkDescriptorSet> bindlessDescriptorSets;
+VkPipelineLayout bindlessPipelineLayout;
+VkPipelineLayout bindlessComputePipelineLayout;
+
+// binding 0 : draw 당 UniformBufferObject (프레임마다 하나, 영구 매핑)
+std::vector<VkBuffer> bindlessDrawBuffers;
+std::vector<VkDeviceMemory> bindlessDrawBuffersMemory;
+std::vector<void*> bindlessDrawDataPoint;
+
+// binding 3 : compute 용 texel buffer (모든 Models가 공유)
+VkBuffer bindlessTexelBuffer;
+VkDeviceMemory bindlessTexelBufferMemory;
+VkBufferView bindlessTexelBufferView;
+
+uint32_t bindlessTextureCount = 0;
+uint32_t bindlessDrawCount = 0;
+std::vector<uint32_t> bindlessFreeTextures;
+std::vector<uint32_t> bindlessFreeDraws;
+
+uint32_t registerBindlessTexture(VkImageView imageView);
+void releaseBindlessTexture(uint32_t index);
+uint32_t acquireBindlessDraw();
+void releaseBindlessDraw(uint32_t index);
+std::string getBindlessShaderPath(const std::string& path);
+
 std::vector<VkSemaphore> imageAvailableSemaphores;
 std::vector<VkSemaphore> renderFinishedSemaphores;
 std::vector<VkFence> inFlightFences;
@@ -213,6 +416,348 @@ size_t currentFrame = 0;
 
 bool framebufferResized = false;
 
+// 공유 풀에서 디스크립터 셋을 잘라 쓰는 할당기
+// 현재 풀이 가득 차면(OUT_OF_POOL / FRAGMENTED) 새 풀을 받아 다시 시도한다.
+// 풀은 FREE_DESCRIPTOR_SET_BIT로 만들어 셋을 하나씩 돌려줄 수 있다.
+class DescriptorAllocator {
+public:
+    uint32_t setsPerPool = 256;
+
+    std::vector<VkDescriptorPool> usedPools;
+    std::vector<VkDescriptorPool> freePools;
+    VkDescriptorPool currentPool = VK_NULL_HANDLE;
+
+    // 셋이 잘려 나온 풀 (free 용)
+    std::unordered_map<VkDescriptorSet, VkDescriptorPool> setPools;
+
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout) {
+        if (currentPool == VK_NULL_HANDLE) {
+            currentPool = grabPool();
+            usedPools.push_back(currentPool);
+        }
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = currentPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &layout;
+
+        VkDescriptorSet set;
+        VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &set);
+
+        if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+            currentPool = grabPool();
+            usedPools.push_back(currentPool);
+
+            allocInfo.descriptorPool = currentPool;
+            result = vkAllocateDescriptorSets(device, &allocInfo, &set);
+        }
+
+        if (result != VK_SUCCESS)
+            throw std::runtime_error("failed to allocate descriptor sets!");
+
+        setPools.emplace(set, currentPool);
+        return set;
+    }
+
+    // 셋 하나를 원래 풀로 반환
+    void free(VkDescriptorSet set) {
+        auto it = setPools.find(set);
+        if (it == setPools.end())
+            return;
+
+        vkFreeDescriptorSets(device, it->second, 1, &set);
+        setPools.erase(it);
+    }
+
+    // 풀 안의 셋을 모두 되돌림 (풀 자체는 재사용)
+    void reset() {
+        for (VkDescriptorPool pool : usedPools) {
+            vkResetDescriptorPool(device, pool, 0);
+            freePools.push_back(pool);
+        }
+        usedPools.clear();
+        setPools.clear();
+        currentPool = VK_NULL_HANDLE;
+    }
+
+    void destroy() {
+        for (VkDescriptorPool pool : usedPools)
+            vkDestroyDescriptorPool(device, pool, nullptr);
+        for (VkDescriptorPool pool : freePools)
+            vkDestroyDescriptorPool(device, pool, nullptr);
+
+        usedPools.clear();
+        freePools.clear();
+        setPools.clear();
+        currentPool = VK_NULL_HANDLE;
+    }
+
+private:
+    VkDescriptorPool grabPool() {
+        if (!freePools.empty()) {
+            VkDescriptorPool pool = freePools.back();
+            freePools.pop_back();
+            return pool;
+        }
+
+        // 셋 하나당 평균 디스크립터 수 (GameObject 레이아웃 기준)
+        std::array<VkDescriptorPoolSize, 4> poolSizes{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        poolSizes[0].descriptorCount = 2 * setsPerPool;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[1].descriptorCount = 2 * setsPerPool;
+        poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+        poolSizes[2].descriptorCount = setsPerPool;
+        poolSizes[3].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[3].descriptorCount = setsPerPool;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = setsPerPool;
+
+        VkDescriptorPool pool;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create descriptor pool!");
+        }
+
+        return pool;
+    }
+};
+
+// 디스크립터 셋에 기록될 내용 (레이아웃 + 바인딩별 리소스)
+struct DescriptorBindingKey {
+    uint32_t binding;
+    VkDescriptorType type;
+
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    VkDeviceSize range;
+
+    VkImageView imageView;
+    VkSampler sampler;
+    VkImageLayout imageLayout;
+
+    VkBufferView texelBufferView;
+
+    bool operator==(const DescriptorBindingKey& other) const {
+        return  binding == other.binding && type == other.type &&
+                buffer == other.buffer && offset == other.offset && range == other.range &&
+                imageView == other.imageView && sampler == other.sampler && imageLayout == other.imageLayout &&
+                texelBufferView == other.texelBufferView;
+    }
+};
+
+struct DescriptorSetKey {
+    VkDescriptorSetLayout layout;
+    std::vector<DescriptorBindingKey> bindings;
+
+    DescriptorSetKey(VkDescriptorSetLayout layout) : layout(layout) {}
+
+    DescriptorSetKey& addBuffer(uint32_t binding, VkDescriptorType type, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+        DescriptorBindingKey key{};
+        key.binding = binding;
+        key.type = type;
+        key.buffer = buffer;
+        key.offset = offset;
+        key.range = range;
+        bindings.push_back(key);
+        return *this;
+    }
+
+    DescriptorSetKey& addImage(uint32_t binding, VkDescriptorType type, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout) {
+        DescriptorBindingKey key{};
+        key.binding = binding;
+        key.type = type;
+        key.imageView = imageView;
+        key.sampler = sampler;
+        key.imageLayout = imageLayout;
+        bindings.push_back(key);
+        return *this;
+    }
+
+    DescriptorSetKey& addTexelBuffer(uint32_t binding, VkDescriptorType type, VkBufferView texelBufferView) {
+        DescriptorBindingKey key{};
+        key.binding = binding;
+        key.type = type;
+        key.texelBufferView = texelBufferView;
+        bindings.push_back(key);
+        return *this;
+    }
+
+    bool operator==(const DescriptorSetKey& other) const {
+        return layout == other.layout && bindings == other.bindings;
+    }
+};
+
+namespace std {
+    template<> struct hash<DescriptorSetKey> {
+        size_t operator()(DescriptorSetKey const& key) const {
+            size_t res = hash<uint64_t>()((uint64_t) key.layout);
+
+            auto combine = [&res](uint64_t v) {
+                res ^= hash<uint64_t>()(v) + 0x9e3779b97f4a7c15ULL + (res << 6) + (res >> 2);
+            };
+
+            for (const DescriptorBindingKey& b : key.bindings) {
+                combine(b.binding);
+                combine(b.type);
+                combine((uint64_t) b.buffer);
+                combine(b.offset);
+                combine(b.range);
+                combine((uint64_t) b.imageView);
+                combine((uint64_t) b.sampler);
+                combine(b.imageLayout);
+                combine((uint64_t) b.texelBufferView);
+            }
+            return res;
+        }
+    };
+}
+
+// key 내용대로 셋을 기록
+void writeDescriptorSet(VkDescriptorSet set, const DescriptorSetKey& key) {
+    std::vector<VkDescriptorBufferInfo> bufferInfos(key.bindings.size());
+    std::vector<VkDescriptorImageInfo> imageInfos(key.bindings.size());
+    std::vector<VkWriteDescriptorSet> descriptorWrites(key.bindings.size());
+
+    for (size_t i = 0; i < key.bindings.size(); i++) {
+        const DescriptorBindingKey& b = key.bindings[i];
+
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = set;
+        descriptorWrites[i].dstBinding = b.binding;
+        descriptorWrites[i].dstArrayElement = 0;
+        descriptorWrites[i].descriptorType = b.type;
+        descriptorWrites[i].descriptorCount = 1;
+
+        if (b.texelBufferView != VK_NULL_HANDLE) {
+            descriptorWrites[i].pTexelBufferView = &b.texelBufferView;
+        }
+        else if (b.imageView != VK_NULL_HANDLE) {
+            imageInfos[i].imageView = b.imageView;
+            imageInfos[i].sampler = b.sampler;
+            imageInfos[i].imageLayout = b.imageLayout;
+            descriptorWrites[i].pImageInfo = &imageInfos[i];
+        }
+        else {
+            bufferInfos[i].buffer = b.buffer;
+            bufferInfos[i].offset = b.offset;
+            bufferInfos[i].range = b.range;
+            descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+        }
+    }
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+// 바인딩 내용이 같은 셋은 하나를 공유 (참조 카운트)
+// 참조가 0이 된 셋은 레이아웃별 free list로 돌아가 다음 요청 때 다시 기록되어 쓰인다.
+class DescriptorCache {
+public:
+    DescriptorAllocator* allocator;
+
+    struct Entry {
+        VkDescriptorSet set;
+        uint32_t refCount;
+    };
+
+    std::unordered_map<DescriptorSetKey, Entry> cache;
+    std::unordered_map<VkDescriptorSet, DescriptorSetKey> setKeys;
+    std::unordered_map<VkDescriptorSetLayout, std::vector<VkDescriptorSet>> freeSets;
+
+    DescriptorCache(DescriptorAllocator* allocator) : allocator(allocator) {}
+
+    VkDescriptorSet acquire(const DescriptorSetKey& key) {
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            it->second.refCount++;
+            return it->second.set;
+        }
+
+        VkDescriptorSet set;
+        std::vector<VkDescriptorSet>& freeList = freeSets[key.layout];
+        if (!freeList.empty()) {
+            set = freeList.back();
+            freeList.pop_back();
+        }
+        else {
+            set = allocator->allocate(key.layout);
+        }
+
+        writeDescriptorSet(set, key);
+
+        cache.emplace(key, Entry{ set, 1 });
+        setKeys.emplace(set, key);
+
+        return set;
+    }
+
+    void release(VkDescriptorSet set) {
+        auto keyIt = setKeys.find(set);
+        if (keyIt == setKeys.end())
+            return;
+
+        auto it = cache.find(keyIt->second);
+        if (--it->second.refCount > 0)
+            return;
+
+        freeSets[keyIt->second.layout].push_back(set);
+        cache.erase(it);
+        setKeys.erase(keyIt);
+    }
+
+    // 레이아웃을 파괴하기 전에 호출. 해당 레이아웃의 빈 셋은 풀로 반환.
+    void dropLayout(VkDescriptorSetLayout layout) {
+        auto it = freeSets.find(layout);
+        if (it == freeSets.end())
+            return;
+
+        for (VkDescriptorSet set : it->second)
+            allocator->free(set);
+        freeSets.erase(it);
+    }
+
+    void destroy() {
+        cache.clear();
+        setKeys.clear();
+        freeSets.clear();
+    }
+};
+
+DescriptorAllocator descriptorAllocator;
+DescriptorCache descriptorCache(&descriptorAllocator);
+
+// 프레임 단위 임시 셋. 해당 프레임의 펜스 대기 후 drawFrame에서 통째로 reset.
+DescriptorAllocator frameDescriptorAllocators[MAX_FRAMES_IN_FLIGHT];
+
+VkDescriptorSet allocateFrameDescriptorSet(VkDescriptorSetLayout layout) {
+    return frameDescriptorAllocators[currentFrame].allocate(layout);
+}
+
+// set 1 : 재질 텍스처. 모든 GameObject가 같은 레이아웃을 써야 캐시에서 셋이 공유된다.
+VkDescriptorSetLayout materialSetLayout = VK_NULL_HANDLE;
+void createMaterialSetLayout();
+
+// 경로가 같은 텍스처는 이미지 / 뷰를 하나만 만들어 공유 (참조 카운트)
+struct SharedTexture {
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    uint32_t mipLevels = 1;
+    uint32_t refCount = 0;
+};
+
+std::unordered_map<std::string, SharedTexture> textureCache;
+
+// 처음 요청된 경로면 파일을 읽어 이미지를 만든다
+SharedTexture& acquireTexture(const std::string& path);
+// 마지막 참조가 사라지면 이미지 / 뷰를 파괴
+void releaseTexture(const std::string& path);
+
 VkShaderModule createShaderModule(const std::vector<char>& code) {
     VkShaderModuleCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -229,6 +774,146 @@ VkShaderModule createShaderModule(const std::vector<char>& code) {
     return shaderModule;
 }
 
+// parallelFor가 쓰는 상주 작업 스레드. 처음 쓸 때 한 번만 띄우고 프로그램 종료 시 join.
+// 호출마다 스레드를 만들던 비용을 없애 물리 step마다의 재구축을 싸게 한다.
+class WorkerPool {
+public:
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers)
+            t.join();
+    }
+
+    // 호출한 스레드까지 포함한 동시 실행 수
+    size_t size() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // task(0) ~ task(taskCount - 1)을 작업 스레드와 호출한 스레드가 나눠 실행하고 모두 끝나면 반환.
+    // 다른 스레드가 이미 쓰는 중이거나 작업 스레드 안에서 다시 부르면 그 자리에서 순서대로 실행.
+    void run(size_t taskCount, const std::function<void(size_t)>& task) {
+        std::unique_lock<std::mutex> dispatch(dispatchMutex, std::try_to_lock);
+        if (!dispatch.owns_lock() || insideWorker()) {
+            for (size_t i = 0; i < taskCount; i++)
+                task(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (workers.empty()) {
+                for (size_t i = 1; i < size(); i++)
+                    workers.emplace_back(&WorkerPool::workerLoop, this);
+            }
+            job = &task;
+            jobCount = taskCount;
+            nextTask.store(0, std::memory_order_relaxed);
+            pending = taskCount;
+            generation++;
+        }
+        wake.notify_all();
+
+        size_t finished = runTasks(&task, taskCount);
+
+        // 늦게 깨어난 작업 스레드가 task를 붙잡은 채 다음 run()으로 넘어가지 않도록 active도 기다린다
+        std::unique_lock<std::mutex> lock(mutex);
+        pending -= finished;
+        done.wait(lock, [this] { return pending == 0 && active == 0; });
+        job = nullptr;
+        jobCount = 0;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    // run() 한 번에 하나의 호출자만 작업을 나눠 준다
+    std::mutex dispatchMutex;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool stopping = false;
+    uint64_t generation = 0;
+
+    const std::function<void(size_t)>* job = nullptr;
+    size_t jobCount = 0;
+    std::atomic<size_t> nextTask{ 0 };
+    size_t pending = 0;
+    // 지금 task를 실행 중인 작업 스레드 수
+    size_t active = 0;
+
+    static bool& insideWorker() {
+        thread_local bool inside = false;
+        return inside;
+    }
+
+    // 남은 task를 하나씩 가져가 실행하고 실행한 개수를 돌려준다
+    size_t runTasks(const std::function<void(size_t)>* task, size_t count) {
+        size_t finished = 0;
+        for (size_t i = nextTask.fetch_add(1, std::memory_order_relaxed); i < count; i = nextTask.fetch_add(1, std::memory_order_relaxed)) {
+            (*task)(i);
+            finished++;
+        }
+        return finished;
+    }
+
+    void workerLoop() {
+        insideWorker() = true;
+        uint64_t seen = 0;
+        for (;;) {
+            const std::function<void(size_t)>* task;
+            size_t count;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+                if (job == nullptr)
+                    continue;
+                task = job;
+                count = jobCount;
+                active++;
+            }
+
+            size_t finished = runTasks(task, count);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            pending -= finished;
+            active--;
+            if (pending == 0 && active == 0)
+                done.notify_one();
+        }
+    }
+};
+
+WorkerPool workerPool;
+
+// [0, count) 구간을 작업 스레드 수만큼 나눠 func(begin, end) 실행
+// 작업량이 적으면 호출한 스레드에서 그대로 실행
+template <typename Func>
+void parallelFor(size_t count, Func func, size_t minPerThread = 4096) {
+    size_t threadCount = workerPool.size();
+    threadCount = std::min(threadCount, std::max<size_t>(1, count / minPerThread));
+
+    if (threadCount <= 1) {
+        func(0, count);
+        return;
+    }
+
+    size_t chunk = (count + threadCount - 1) / threadCount;
+
+    workerPool.run(threadCount, [&](size_t i) {
+        size_t begin = i * chunk;
+        size_t end = std::min(count, begin + chunk);
+        if (begin < end)
+            func(begin, end);
+    });
+}
+
 static std::vector<char> readFile(const std::string& filename) {
     std::ifstream file(filename, std::ios::ate | std::ios::binary);
 
@@ -276,155 +961,83 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(    VkDebugUtilsMessageSever
     return VK_FALSE;
 }
 
-void getImageData(VkImage& src, VkDeviceSize& imageSize, VkCommandBuffer& commandbuffer) {
-    // 스테깅 버퍼, 스테깅 버퍼 메모리 생성
-    // 커맨드 버퍼 할당
-    // 커맨드 버퍼 비긴 인포
-    // Image2Buffer
-    // memcpy
-
-    // Staging buffer 생성
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-
-    VkBufferCreateInfo bufferCreateInfo{};
-    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferCreateInfo.pNext = NULL;
-    bufferCreateInfo.flags = 0;
-    bufferCreateInfo.size = imageSize;
-    // Image에서 값을 받아온다.
-    bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    if (vkCreateBuffer(device, &bufferCreateInfo, nullptr, &stagingBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("staging Buffer 생성 오류");
-    }
-
-    // staging buffer Memory 생성
-    VkMemoryRequirements memReq;
-    vkGetBufferMemoryRequirements(device, stagingBuffer, &memReq);
-
-    VkPhysicalDeviceMemoryProperties memProp;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProp);
-
-    int memoryTypeIdx = -1;
-    for (int i = 0; i < memProp.memoryTypeCount; i++) {
-        if (memReq.memoryTypeBits & (1 << i) && memProp.memoryTypes[i].propertyFlags  & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT == VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
-            memoryTypeIdx = i;
-            break;
-        }
+// 축 정렬 바운딩 박스 (월드 좌표)
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    glm::vec3 center() const                { return (min + max) * 0.5f; }
+    glm::vec3 extent() const                { return (max - min) * 0.5f; }
+
+    float surfaceArea() const {
+        glm::vec3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
     }
-    if (memoryTypeIdx == -1)
-        throw std::runtime_error("stagingBuffer가 요구하는 메모리 유형을 찾을 수 없음.");
-
-    VkMemoryAllocateInfo memAllocInfo{};
-    memAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    memAllocInfo.allocationSize = memReq.size;
-    memAllocInfo.memoryTypeIndex = memoryTypeIdx;
-
-    if (vkAllocateMemory(device, &memAllocInfo, nullptr, &stagingBufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("stagingBufferMemory생성 오류");
-    }
-
-    vkBindBufferMemory(device, stagingBuffer, stagingBufferMemory, 0);
-
-    // begin commandBuffer
-    VkCommandBufferBeginInfo cmdbufBeginInfo{};
-    cmdbufBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    cmdbufBeginInfo.pNext = nullptr;
-    cmdbufBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    cmdbufBeginInfo.pInheritanceInfo = nullptr;
-
-    vkBeginCommandBuffer(commandbuffer, &cmdbufBeginInfo);
-
-    // convert Image layout
-    VkImageMemoryBarrier imageMemBarrier{};
-    imageMemBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    imageMemBarrier.pNext = nullptr;
-    imageMemBarrier.image = src;
-    imageMemBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    imageMemBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    imageMemBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    imageMemBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    imageMemBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    imageMemBarrier.subresourceRange.baseArrayLayer = 0;
-    imageMemBarrier.subresourceRange.baseMipLevel = 0;
-    imageMemBarrier.subresourceRange.layerCount = 1;
-    imageMemBarrier.subresourceRange.levelCount = 1;
-
-    vkCmdPipelineBarrier(   commandbuffer,
-                            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                            VK_PIPELINE_STAGE_TRANSFER_BIT,
-                            0,
-                            0, nullptr,
-                            0, nullptr,
-                            1, &imageMemBarrier);
-
-    VkBufferImageCopy bufferImageCopy{};
-
-    bufferImageCopy.bufferOffset = 0;
-    bufferImageCopy.bufferRowLength = 0;
-    bufferImageCopy.bufferImageHeight = 0;
-    bufferImageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    bufferImageCopy.imageSubresource.mipLevel = 0;
-    bufferImageCopy.imageSubresource.baseArrayLayer = 0;
-    bufferImageCopy.imageSubresource.layerCount = 1;
-    bufferImageCopy.imageOffset = { 0,
-                                    0,
-                                    0};
-    bufferImageCopy.imageExtent = { static_cast<unsigned int>(swapChainExtent.width), 
-                                    static_cast<unsigned int>(swapChainExtent.height), 
-                                    1 };
-
-    vkCmdCopyImageToBuffer(commandbuffer, src, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer, 1, &bufferImageCopy);
-
-    vkEndCommandBuffer(commandbuffer);
-
-    VkSemaphore transSemaphore;
-
-    VkSemaphoreCreateInfo semaphoreCreateInfo{};
-    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-    if (vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &transSemaphore) != VK_SUCCESS) {
-        throw std::runtime_error("transSemaphore 생성 실패");
-    }
-
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_TRANSFER_BIT};
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.pNext = nullptr;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandbuffer;
-    // Graphics Pipeline 내 waitStages에 도달하였을 때 까지 대기
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = &transSemaphore;
-    submitInfo.pWaitDstStageMask = waitStages;
-    
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, nullptr) != VK_SUCCESS) {
-        throw std::runtime_error("commandBuffer를 제출하는데 실패.");
+
+    bool overlaps(const AABB& o) const {
+        return  min.x <= o.max.x && max.x >= o.min.x &&
+                min.y <= o.max.y && max.y >= o.min.y &&
+                min.z <= o.max.z && max.z >= o.min.z;
     }
 
-    vkQueueWaitIdle(graphicsQueue);
-    vkFreeCommandBuffers(device, commandPool, 1, &commandbuffer);
+    bool contains(const AABB& o) const {
+        return  min.x <= o.min.x && min.y <= o.min.y && min.z <= o.min.z &&
+                max.x >= o.max.x && max.y >= o.max.y && max.z >= o.max.z;
+    }
 
-    int* res;
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-    // memcpy(res, data, imageSize);
-    vkUnmapMemory(device, stagingBufferMemory);
+    // 교차하면 진입 거리 t (origin + dir * t), 아니면 false
+    bool raycast(glm::vec3 origin, glm::vec3 invDir, float maxT, float& t) const {
+        glm::vec3 t0 = (min - origin) * invDir;
+        glm::vec3 t1 = (max - origin) * invDir;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
 
-    vkDestroySemaphore(device, transSemaphore, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-}
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+
+        t = enter;
+        return enter <= exit;
+    }
+
+    static AABB merge(const AABB& a, const AABB& b) {
+        return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+    }
+};
+
+// 회전된 박스. axes의 각 열이 단위 축, half는 축 방향 반 길이
+struct OBB {
+    glm::vec3 center;
+    glm::mat3 axes;
+    glm::vec3 half;
+};
+
+// 충돌 결과. normal은 a에서 b로 향하고, depth만큼 b를 normal 방향으로 밀면 떨어진다.
+struct ContactManifold {
+    glm::vec3 normal;
+    float depth;
+    int pointCount;
+    glm::vec3 points[4];
+};
+
+// 분리축(면 3 + 3, 모서리 9) 검사. 겹치면 contact에 최소 침투 축 기준 접촉을 채운다.
+bool collideOBB(const OBB& a, const OBB& b, ContactManifold* contact = nullptr);
+
+// a[i], b[i] 쌍 count개를 SIMD lane 단위로 묶어 검사. hits[i]가 1인 쌍만 contacts[i]가 유효하다.
+void collideOBBBatch(const OBB* a, const OBB* b, size_t count, uint8_t* hits, ContactManifold* contacts = nullptr);
+
+// a를 motion만큼 평행이동할 때 정지한 b와 처음 닿는 비율 toi (0 ~ 1)와 a 쪽을 향하는 b의 표면 법선.
+// 처음부터 겹쳐 있거나 닿지 않으면 false
+bool sweepOBB(const OBB& a, glm::vec3 motion, const OBB& b, float& toi, glm::vec3& normal);
+
+// 무작위 박스 쌍으로 기존 꼭짓점 검사 / collideOBB / collideOBBBatch 비교
+void benchmarkNarrowPhase(size_t count = 100000, int iterations = 10);
 
 class ColliderBox {
 public: 
     // centor
     float posX, posY, posZ;
     float localPosX, localPosY, localPosZ;
-    float rotX, rotY, rotZ;
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
     float sizeX, sizeY, sizeZ;
 
     glm::vec3 V[8];
@@ -466,10 +1079,7 @@ public:
     }
 
     void setSize3D() {
-        glm::mat4 mat(1.0f), rotMat;
-        rotMat =    glm::rotate(mat, glm::radians(rotX), glm::vec3(1.0, 0.0, 0.0)) *
-                    glm::rotate(mat, glm::radians(rotY), glm::vec3(0.0, 1.0, 0.0)) *
-                    glm::rotate(mat, glm::radians(rotZ), glm::vec3(0.0, 0.0, 1.0));
+        glm::mat4 rotMat = glm::mat4_cast(rotation);
 
         V[0] = rotMat * glm::vec4(posX + localPosX - sizeX, posY + localPosY - sizeY, posZ + localPosZ - sizeZ, 1.0f);
         V[1] = rotMat * glm::vec4(posX + localPosX + sizeX, posY + localPosY - sizeY, posZ + localPosZ - sizeZ, 1.0f);
@@ -491,17 +1101,12 @@ public:
         this->localPosX = localX;
         this->localPosY = localY;
         this->localPosZ = localZ;
-        this->rotX = rotX;
-        this->rotY = rotY;
-        this->rotZ = rotZ;
+        this->rotation = eulerToQuat(glm::vec3(rotX, rotY, rotZ));
         this->sizeX = sizeX;
         this->sizeY = sizeY;
         this->sizeZ = sizeZ;
 
-        glm::mat4 mat(1.0f), rotMat;
-        rotMat =    glm::rotate(mat, glm::radians(rotX), glm::vec3(1.0, 0.0, 0.0)) *
-                    glm::rotate(mat, glm::radians(rotY), glm::vec3(0.0, 1.0, 0.0)) *
-                    glm::rotate(mat, glm::radians(rotZ), glm::vec3(0.0, 0.0, 1.0));
+        glm::mat4 rotMat = glm::mat4_cast(rotation);
 
         V[0] = rotMat * glm::vec4(posX + localPosX - sizeX, posY + localPosY - sizeY, posZ + localPosZ - sizeZ, 1.0f);
         V[1] = rotMat * glm::vec4(posX + localPosX + sizeX, posY + localPosY - sizeY, posZ + localPosZ - sizeZ, 1.0f);
@@ -520,17 +1125,12 @@ public:
         this->localPosX = local.x;
         this->localPosY = local.y;
         this->localPosZ = local.z;
-        this->rotX = rot.x;
-        this->rotY = rot.y;
-        this->rotZ = rot.z;
+        this->rotation = eulerToQuat(rot);
         this->sizeX = scale.x;
         this->sizeY = scale.y;
         this->sizeZ = scale.z;
 
-        glm::mat4 mat(1.0f), rotMat;
-        rotMat =    glm::rotate(mat, glm::radians(rotX), glm::vec3(1.0, 0.0, 0.0)) *
-                    glm::rotate(mat, glm::radians(rotY), glm::vec3(0.0, 1.0, 0.0)) *
-                    glm::rotate(mat, glm::radians(rotZ), glm::vec3(0.0, 0.0, 1.0));
+        glm::mat4 rotMat = glm::mat4_cast(rotation);
 
         V[0] = rotMat * glm::vec4(posX + localPosX - sizeX, posY + localPosY - sizeY, posZ + localPosZ - sizeZ, 1.0f);
         V[1] = rotMat * glm::vec4(posX + localPosX + sizeX, posY + localPosY - sizeY, posZ + localPosZ - sizeZ, 1.0f);
@@ -542,6 +1142,26 @@ public:
         V[7] = rotMat * glm::vec4(posX + localPosX + sizeX, posY + localPosY + sizeY, posZ + localPosZ + sizeZ, 1.0f);
     }
 
+    // V와 같은 기준 (rotation * (pos + local ± size))의 월드 AABB
+    AABB getAABB() {
+        glm::mat3 rotMat = glm::mat3_cast(rotation);
+        glm::vec3 center = rotMat * glm::vec3(posX + localPosX, posY + localPosY, posZ + localPosZ);
+
+        glm::vec3 half(0.0f);
+        for (int c = 0; c < 3; c++)
+            half += glm::abs(rotMat[c]) * glm::vec3(sizeX, sizeY, sizeZ)[c];
+
+        return { center - half, center + half };
+    }
+
+    // V와 같은 기준의 OBB. 중심만 rotation으로 돌고 축은 rotation의 열
+    OBB getOBB() {
+        glm::mat3 rotMat = glm::mat3_cast(rotation);
+        return {    rotMat * glm::vec3(posX + localPosX, posY + localPosY, posZ + localPosZ),
+                    rotMat,
+                    glm::vec3(sizeX, sizeY, sizeZ) };
+    }
+
     bool isCollision2D(ColliderBox* target) {
         bool x, y;
 
@@ -554,14 +1174,10 @@ public:
     bool isColliderVal = false;
 
     bool isCollisionEnter3D(ColliderBox* target) {
-        bool a (false), b(false), res(false);
-        glm::vec3 vmin(target->V[0]), vmax(target->V[7]);
+        bool res(false);
         float vx(posX + localPosX), vy(posY + localPosY), vz(posZ + localPosZ);
 
-        glm::mat4 mat(1.0f), rotMat;
-        rotMat =    glm::rotate(mat, glm::radians(rotX), glm::vec3(1.0, 0.0, 0.0)) *
-                    glm::rotate(mat, glm::radians(rotY), glm::vec3(0.0, 1.0, 0.0)) *
-                    glm::rotate(mat, glm::radians(rotZ), glm::vec3(0.0, 0.0, 1.0));
+        glm::mat4 rotMat = glm::mat4_cast(rotation);
 
         V[0] = rotMat * glm::vec4(vx - sizeX, vy - sizeY, vz - sizeZ, 1.0f);
         V[1] = rotMat * glm::vec4(vx + sizeX, vy - sizeY, vz - sizeZ, 1.0f);
@@ -572,15 +1188,7 @@ public:
         V[6] = rotMat * glm::vec4(vx - sizeX, vy + sizeY, vz + sizeZ, 1.0f);
         V[7] = rotMat * glm::vec4(vx + sizeX, vy + sizeY, vz + sizeZ, 1.0f);
 
-        for (glm::vec3 v : this->V) {
-            a = (v.x > vmin.x && v.y > vmin.y && v.z > vmin.z);
-            b = (v.x < vmax.x && v.y < vmax.y && v.z < vmax.z);
-
-            if (a && b) {
-                res = true;
-                break;
-            }
-        }
+        res = collideOBB(getOBB(), target->getOBB());
 
         if (res == false || isColliderVal == res) {
             isColliderVal = res;
@@ -590,84 +1198,636 @@ public:
         return true;
     }
 
-    bool isCollision3D(ColliderBox* target) {
-        // 제일 작은 점과 제일 큰 점의 사이에 있는지 여부 ()
-        bool a (false), b (false);
-        // x, y, z가 최소인 V와 최대인 V
-        glm::vec3 vmin(target->V[0]), vmax(target->V[7]);
-        float vx(posX + localPosX), vy(posY + localPosY), vz(posZ + localPosZ);
-
-        for (glm::vec3 v : this->V) {
-            a = (v.x > vmin.x && v.y > vmin.y && v.z > vmin.z);
-            b = (v.x < vmax.x && v.y < vmax.y && v.z < vmax.z);
-
-            if (a && b)
-                return true;
-
-        }
-        return false;
+    bool isCollision3D(ColliderBox* target, ContactManifold* contact = nullptr) {
+        return collideOBB(getOBB(), target->getOBB(), contact);
     }
 };
 
-// 그래픽스파이프라인 초기 속성 (per GameObject)
-struct initParam {
+// broad phase 공통 인터페이스. proxy는 fatMargin만큼 부풀린 AABB를 가지므로
+// 조금 움직인 물체는 자료구조를 건드리지 않는다.
+class BroadPhase {
 public:
-    std::string vertPath;
-    std::string fragPath;
+    float fatMargin = 0.1f;
+    float displacementMultiplier = 2.0f;
 
-    // VK_PRIMITIVE_TOPOLOGY_
-    VkPrimitiveTopology topologyMode;
-    // VK_POLYGON_
-    VkPolygonMode polygonMode;
-    // VK_CULL_MODE_
-    VkCullModeFlagBits cullMode;
-}; // _initParam
+    virtual ~BroadPhase() {}
 
-class Models {
-public:
-    VkImage textureImage;
-    VkDeviceMemory textureImageMemory;
-    VkImageView textureImageView;
+    virtual int createProxy(const AABB& aabb, void* userData) = 0;
+    virtual void destroyProxy(int proxyId) = 0;
 
-    VkImage alphaTextureImage;
-    VkDeviceMemory alphaTextureImageMemory;
-    VkImageView alphaTextureImageView;
+    // 부풀린 AABB를 벗어나면 갱신하고 true
+    virtual bool moveProxy(int proxyId, const AABB& aabb, glm::vec3 displacement) = 0;
 
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
-    VkBuffer vertexBuffer;
-    VkDeviceMemory vertexBufferMemory;
-    VkBuffer indexBuffer;
-    VkDeviceMemory indexBufferMemory;
+    virtual void* getUserData(int proxyId) = 0;
+    virtual const AABB& getFatAABB(int proxyId) = 0;
 
-    std::vector<VkBuffer> uniformBuffers;
-    std::vector<VkDeviceMemory> uniformBuffersMemory;
+    // 지난 호출 이후 움직인 proxy와 겹치는 (a < b) 쌍
+    virtual void computePairs(std::vector<std::pair<int, int>>& pairs) = 0;
 
-    VkBuffer texelUniformBuffer;
-    VkDeviceMemory texelUniformBuffersMemory;
-    VkBufferView texelUniformBuffersView;
-    VkDeviceSize texelDeviceSize;
-    void* texelDataPoint;
+    // 부풀린 AABB가 겹치는 proxy
+    virtual void queryProxies(const AABB& aabb, std::vector<int>& result) = 0;
 
-    VkBuffer texelVertexBuffer;
-    VkDeviceMemory texelVertexBuffersMemory;
-    VkBufferView texelVertexBuffersView;
+    // callback(proxyId, maxT)은 맞은 거리 또는 -1. 가장 가까운 proxy (없으면 -1)
+    virtual int raycastProxies(glm::vec3 origin, glm::vec3 dir, float maxT, 
+                                std::function<float(int, float)> callback, float* hitT = nullptr) = 0;
 
-    VkDescriptorPool descriptorPool;
-    std::vector<VkDescriptorSet> descriptorSets;
+protected:
+    // fatAABB가 aabb를 충분히 감싸면 false, 아니면 새로 부풀려 넣고 true
+    bool refit(AABB& fatAABB, const AABB& aabb, glm::vec3 displacement);
+};
 
-    VkPipeline graphicsPipeline;
+// 동적 AABB 트리. 삽입은 표면적 비용으로 형제를 고르고 회전으로 균형을 맞춘다.
+class DynamicAABBTree : public BroadPhase {
+public:
+    struct Node {
+        AABB aabb;
+        void* userData;
 
-    /////////////////////////////////
-    std::string Name;
+        // 빈 노드에서는 free list의 다음 노드
+        int parent;
+        int child1;
+        int child2;
 
-    std::string objectPath;
-    std::string texturePath;
+        // 잎 0, 빈 노드 -1
+        int height;
+        bool moved;
+
+        bool isLeaf() const { return child1 == -1; }
+    };
+
+    int createProxy(const AABB& aabb, void* userData) override;
+    void destroyProxy(int proxyId) override;
+
+    // 부풀린 AABB를 벗어나면 다시 삽입하고 true
+    bool moveProxy(int proxyId, const AABB& aabb, glm::vec3 displacement) override;
+
+    void* getUserData(int proxyId) override             { return nodes[proxyId].userData; }
+    const AABB& getFatAABB(int proxyId) override        { return nodes[proxyId].aabb; }
+    int getHeight()                                     { return root == -1 ? 0 : nodes[root].height; }
+
+    void computePairs(std::vector<std::pair<int, int>>& pairs) override;
+
+    void queryProxies(const AABB& aabb, std::vector<int>& result) override {
+        query(aabb, [&](int proxyId) {
+            result.push_back(proxyId);
+            return true;
+        });
+    }
+
+    int raycastProxies(glm::vec3 origin, glm::vec3 dir, float maxT, 
+                        std::function<float(int, float)> callback, float* hitT = nullptr) override {
+        return raycast(origin, dir, maxT, callback, hitT);
+    }
+
+    // callback(proxyId)이 false를 돌려주면 중단
+    template <typename Func>
+    void query(const AABB& aabb, Func callback) {
+        if (root == -1)
+            return;
+
+        std::vector<int> stack;
+        stack.reserve(64);
+        stack.push_back(root);
+
+        while (!stack.empty()) {
+            int id = stack.back();
+            stack.pop_back();
+
+            const Node& node = nodes[id];
+            if (!node.aabb.overlaps(aabb))
+                continue;
+
+            if (node.isLeaf()) {
+                if (!callback(id))
+                    return;
+            }
+            else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    // callback(proxyId, maxT)은 실제 충돌 거리(없으면 음수)를 돌려준다. 가장 가까운 proxy, 없으면 -1
+    template <typename Func>
+    int raycast(glm::vec3 origin, glm::vec3 dir, float maxT, Func callback, float* hitT = nullptr) {
+        if (root == -1)
+            return -1;
+
+        glm::vec3 invDir(   dir.x != 0.0f ? 1.0f / dir.x : FLT_MAX,
+                            dir.y != 0.0f ? 1.0f / dir.y : FLT_MAX,
+                            dir.z != 0.0f ? 1.0f / dir.z : FLT_MAX);
+
+        int hit = -1;
+
+        std::vector<int> stack;
+        stack.reserve(64);
+        stack.push_back(root);
+
+        while (!stack.empty()) {
+            int id = stack.back();
+            stack.pop_back();
+
+            const Node& node = nodes[id];
+            float t;
+            if (!node.aabb.raycast(origin, invDir, maxT, t))
+                continue;
+
+            if (node.isLeaf()) {
+                float leafT = callback(id, maxT);
+                if (leafT >= 0.0f && leafT < maxT) {
+                    maxT = leafT;
+                    hit = id;
+                }
+            }
+            else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+
+        if (hitT && hit != -1)
+            *hitT = maxT;
+        return hit;
+    }
+
+private:
+    std::vector<Node> nodes;
+    int root = -1;
+    int freeList = -1;
+
+    std::vector<int> moveBuffer;
+
+    int allocateNode();
+    void freeNode(int id);
+
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int id);
+};
+
+// 정렬 축 하나에 대한 sort and sweep. 프레임 사이 순서가 거의 바뀌지 않으므로 삽입 정렬로 유지하고,
+// 정렬 축에서 겹치는 구간 안에서는 나머지 두 축을 SIMD로 여러 개씩 한 번에 거른다.
+// 정렬 축은 중심 분산이 가장 큰 축 (바닥 위 장면이면 보통 x나 z).
+class SweepAndPrune : public BroadPhase {
+public:
+    int createProxy(const AABB& aabb, void* userData) override;
+    void destroyProxy(int proxyId) override;
+    bool moveProxy(int proxyId, const AABB& aabb, glm::vec3 displacement) override;
+
+    void* getUserData(int proxyId) override             { return proxies[proxyId].userData; }
+    const AABB& getFatAABB(int proxyId) override        { return proxies[proxyId].aabb; }
+    int getSortAxis()                                   { return sortAxis; }
+
+    void computePairs(std::vector<std::pair<int, int>>& pairs) override;
+
+    // 아래 둘은 정렬 상태와 무관하게 전체를 훑는다
+    void queryProxies(const AABB& aabb, std::vector<int>& result) override;
+    int raycastProxies(glm::vec3 origin, glm::vec3 dir, float maxT, 
+                        std::function<float(int, float)> callback, float* hitT = nullptr) override;
+
+private:
+    struct Proxy {
+        AABB aabb;
+        void* userData;
+        bool moved;
+        bool alive;
+    };
+
+    std::vector<Proxy> proxies;
+    std::vector<int> freeList;
+
+    // sortAxis 기준 min 오름차순 proxy id
+    std::vector<int> order;
+    // 다음 computePairs에서 order에 넣을 / 뺄 proxy
+    std::vector<int> pendingInsert;
+    std::vector<int> pendingRemove;
+
+    int sortAxis = 0;
+
+    // order 순서로 모은 성분 (sweep 작업 공간, 끝에 lane 폭만큼 +inf 패딩)
+    std::vector<float> sortedMin[3];
+    std::vector<float> sortedMax[3];
+
+    void chooseSortAxis();
+    void sortOrder(bool full);
+    void gatherSorted();
+};
+
+enum BroadPhaseType {
+    BROAD_PHASE_TREE,
+    BROAD_PHASE_SAP
+};
+
+// 균일 격자 공간 해시. 매번 통째로 다시 만들며, 항목은 자기 AABB가 덮는 모든 칸에 들어간다.
+// 칸 버킷은 머리를 CAS로 바꾸는 연결 리스트라 여러 스레드가 락 없이 동시에 넣는다.
+// 크기가 비슷한 물체가 빽빽한 경우의 근접 / 트리거 질의용. 질의는 한 스레드에서만.
+class SpatialHashGrid {
+public:
+    // 물체 크기 정도가 적당하다
+    float cellSize = 2.0f;
+    // 이보다 많은 칸을 덮는 항목은 격자 대신 따로 모아 매 질의마다 직접 검사
+    size_t maxCellsPerItem = 512;
+
+    void build(const std::vector<AABB>& bounds);
+
+    void queryAABB(const AABB& aabb, std::vector<int>& result);
+    void queryRadius(glm::vec3 center, float radius, std::vector<int>& result);
+    // AABB까지 거리가 가까운 순서로 최대 k개
+    void queryNearest(glm::vec3 point, size_t k, std::vector<int>& result);
+
+    size_t size()                           { return bounds.size(); }
+    const AABB& getBounds(int item)         { return bounds[item]; }
+
+private:
+    struct Cell {
+        int x, y, z;
+    };
+
+    struct Entry {
+        int item;
+        int next;
+    };
+
+    std::vector<AABB> bounds;
+    AABB worldBounds;
+
+    // 칸 해시 -> entries 내 첫 항목 (-1은 빈 칸)
+    std::unique_ptr<std::atomic<int>[]> heads;
+    size_t tableSize = 0;
+    std::vector<Entry> entries;
+    std::vector<int> largeItems;
+
+    // 여러 칸에 걸친 항목을 한 질의에서 한 번만 돌려주기 위한 표식
+    std::vector<uint32_t> visitStamp;
+    uint32_t stamp = 0;
+
+    Cell cellOf(glm::vec3 p) {
+        return { int(floorf(p.x / cellSize)), int(floorf(p.y / cellSize)), int(floorf(p.z / cellSize)) };
+    }
+
+    size_t hashCell(int x, int y, int z) {
+        uint32_t h = uint32_t(x) * 73856093u ^ uint32_t(y) * 19349663u ^ uint32_t(z) * 83492791u;
+        return h & (tableSize - 1);
+    }
+
+    // lo ~ hi 칸의 항목 중 처음 보는 것만 func(item)
+    template <typename Func>
+    void forEachInCells(Cell lo, Cell hi, Func func) {
+        if (++stamp == 0) {
+            std::fill(visitStamp.begin(), visitStamp.end(), 0);
+            stamp = 1;
+        }
+
+        for (int item : largeItems) {
+            visitStamp[item] = stamp;
+            func(item);
+        }
+
+        if (tableSize == 0)
+            return;
+
+        for (int x = lo.x; x <= hi.x; x++) {
+            for (int y = lo.y; y <= hi.y; y++) {
+                for (int z = lo.z; z <= hi.z; z++) {
+                    for (int e = heads[hashCell(x, y, z)].load(std::memory_order_relaxed); e != -1; e = entries[e].next) {
+                        int item = entries[e].item;
+                        if (visitStamp[item] == stamp)
+                            continue;
+
+                        visitStamp[item] = stamp;
+                        func(item);
+                    }
+                }
+            }
+        }
+    }
+
+    // 범위를 worldBounds 안으로 잘라 빈 칸 순회를 줄인다
+    bool clampCells(const AABB& aabb, Cell& lo, Cell& hi);
+};
+
+// 충돌 중인 GameObject 쌍과 접촉 정보 (updateCollisions마다 갱신)
+struct CollisionPair {
+    GameObject* a;
+    GameObject* b;
+    ContactManifold contact;
+};
+
+DynamicAABBTree colliderTree;
+SweepAndPrune colliderSAP;
+// 등록된 collider가 들어 있는 broad phase
+BroadPhase* broadPhase = &colliderTree;
+std::vector<CollisionPair> collisionPairs;
+
+// 등록된 collider를 옮겨 담고 backend를 바꾼다
+void setBroadPhase(BroadPhaseType type);
+
+void registerCollider(GameObject* go);
+void unregisterCollider(GameObject* go);
+
+// 모든 collider의 broad phase 위치를 갱신하고 collisionPairs를 다시 채운다
+void updateCollisions(float dt);
+
+std::vector<GameObject*> queryColliders(const AABB& aabb);
+GameObject* raycastColliders(glm::vec3 origin, glm::vec3 dir, float maxDistance, float* hitDistance = nullptr);
+
+// 빠른 물체(continuousCollision)가 한 step에 얇은 collider를 뚫지 않도록 첫 접촉 직전까지만 움직인다.
+// 접촉 앞에 남겨 두는 간격. 다음 step이 겹친 채로 시작하지 않게 한다.
+const float continuousSkin = 0.001f;
+// CCD로 멈춘 쌍. 간격만큼 떨어져 narrow phase에 안 잡히므로 다음 updateCollisions에서 더한다.
+std::vector<CollisionPair> continuousPairs;
+
+// go의 collider를 motion(위치 기준)만큼 옮길 때 처음 닿는 비율 (0 ~ 1, 안 닿으면 1).
+// 상대는 지금 자리에 멈춰 있다고 보고, 시작부터 겹쳐 있는 상대는 무시한다.
+float sweepCollider(GameObject* go, glm::vec3 motion, GameObject** hitObject = nullptr, glm::vec3* hitNormal = nullptr);
+// 첫 접촉 직전까지 줄인 motion. 맞았으면 continuousPairs에 남긴다.
+glm::vec3 clampContinuousMotion(GameObject* go, glm::vec3 motion);
+// integrate 직후, syncColliders 전에 호출. collider가 아직 지난 step 위치에 있는 것을 이용한다.
+void applyContinuousCollision();
+
+// collider가 있는 GameObject의 격자. PhysicalUpdate마다 다시 만든다.
+SpatialHashGrid proximityGrid;
+std::vector<GameObject*> proximityObjects;
+
+void rebuildProximityGrid();
+
+// routine::Update 등 게임 코드용 근접 질의 (collider AABB 기준)
+std::vector<GameObject*> overlapBox(const AABB& aabb);
+std::vector<GameObject*> overlapSphere(glm::vec3 center, float radius);
+std::vector<GameObject*> nearestObjects(glm::vec3 point, size_t k);
+
+// 바닥 위에 흩어진 count개의 박스로 brute force / SAP / 트리 비교
+void benchmarkBroadPhase(std::vector<size_t> counts = { 1000, 5000, 10000, 50000 }, int frames = 20);
+
+// 그래픽스파이프라인 초기 속성 (per GameObject)
+struct initParam {
+public:
+    std::string vertPath;
+    std::string fragPath;
+
+    // VK_PRIMITIVE_TOPOLOGY_
+    VkPrimitiveTopology topologyMode;
+    // VK_POLYGON_
+    VkPolygonMode polygonMode;
+    // VK_CULL_MODE_
+    VkCullModeFlagBits cullMode;
+}; // _initParam
+
+// 블록 안의 빈 구간 (byte 단위)
+struct GeometryRange {
+    VkDeviceSize offset;
+    VkDeviceSize size;
+};
+
+// 정적 메쉬를 한데 모아두는 큰 vertex / index 버퍼
+struct GeometryBlock {
+    VkBuffer vertexBuffer;
+    VkDeviceMemory vertexBufferMemory;
+    VkBuffer indexBuffer;
+    VkDeviceMemory indexBufferMemory;
+
+    // byte 단위
+    VkDeviceSize vertexCapacity;
+    VkDeviceSize indexCapacity;
+    VkDeviceSize vertexUsed;
+    VkDeviceSize indexUsed;
+
+    // used 아래에서 반환된 구간 (offset 순, 인접 구간은 합쳐 둔다)
+    std::vector<GeometryRange> freeVertexRanges;
+    std::vector<GeometryRange> freeIndexRanges;
+};
+
+// Models의 정점/인덱스를 블록 안에 이어 붙이고 firstIndex / vertexOffset만 돌려준다.
+// 반환된 구간을 먼저 재사용하고, 블록이 가득 차면 새 블록을 만든다. 메모리는 cleanup 때 한 번에 해제.
+class GeometryPool {
+public:
+    VkDeviceSize blockVertexSize = 64 * 1024 * 1024;
+    VkDeviceSize blockIndexSize = 32 * 1024 * 1024;
+
+    std::vector<GeometryBlock*> blocks;
+
+    void upload(Models* m);
+    // 모델의 구간을 블록에 반환. GPU가 더 이상 읽지 않을 때 호출
+    void release(Models* m);
+    void destroy();
+
+private:
+    GeometryBlock* createBlock(VkDeviceSize vertexSize, VkDeviceSize indexSize);
+};
+
+GeometryPool geometryPool;
+
+// 위치 / 회전(쿼터니언) / 크기와 부모-자식 관계.
+// local, world 행렬을 캐시하고 값이 바뀐 노드와 그 자손만 다시 계산한다.
+// world = parent.world * local,  local = T * R(q) * S
+class Transform {
+public:
+    Transform() {}
+    Transform(glm::vec3 pos, glm::quat rot, glm::vec3 scale) : position(pos), rotation(rot), scale(scale) {}
+
+    // 부모/자식 포인터를 가지므로 복사 금지
+    Transform(const Transform&) = delete;
+    Transform& operator=(const Transform&) = delete;
+
+    ~Transform() {
+        setParent(nullptr);
+        for (Transform* child : children) {
+            child->parent = nullptr;
+            child->markWorldDirty();
+        }
+    }
+
+    void setPosition(glm::vec3 pos)         { this->position = pos; markLocalDirty(); }
+    void setRotation(glm::quat rot)         { this->rotation = rot; markLocalDirty(); }
+    void setRotate(glm::vec3 rot)           { setRotation(eulerToQuat(rot)); }
+    void setScale(glm::vec3 scale)          { this->scale = scale; markLocalDirty(); }
+
+    // 이미 계산된 local 행렬과 함께 설정 (BodyStore의 일괄 계산 결과)
+    void setLocal(glm::vec3 pos, glm::quat rot, glm::vec3 scale, const glm::mat4& local) {
+        this->position = pos;
+        this->rotation = rot;
+        this->scale = scale;
+        this->localMatrix = local;
+        this->localDirty = false;
+        markWorldDirty();
+    }
+
+    void translate(glm::vec3 delta)         { this->position += delta; markLocalDirty(); }
+    // 로컬 축 기준 회전 (오일러, 도)
+    void rotate(glm::vec3 delta)            { setRotation(rotation * eulerToQuat(delta)); }
+
+    glm::vec3 getPosition()                 { return position; }
+    glm::quat getRotation() const           { return rotation; }
+    glm::vec3 getRotate()                   { return quatToEuler(rotation); }
+    glm::vec3 getScale()                    { return scale; }
+
+    Transform* getParent() const            { return parent; }
+    const std::vector<Transform*>& getChildren() { return children; }
+
+    void setParent(Transform* newParent) {
+        if (parent == newParent)
+            return;
+
+        if (parent) {
+            std::vector<Transform*>& siblings = parent->children;
+            siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
+        }
+
+        parent = newParent;
+        if (parent)
+            parent->children.push_back(this);
+
+        markWorldDirty();
+    }
+
+    void addChild(Transform* child) {
+        child->setParent(this);
+    }
+
+    const glm::mat4& getLocalMatrix() {
+        if (localDirty) {
+            localMatrix =   glm::translate(glm::mat4(1.0f), position)
+                            * glm::mat4_cast(rotation)
+                            * glm::scale(glm::mat4(1.0f), scale);
+            localDirty = false;
+        }
+        return localMatrix;
+    }
+
+    const glm::mat4& getWorldMatrix() {
+        if (worldDirty) {
+            if (parent)
+                worldMatrix = parent->getWorldMatrix() * getLocalMatrix();
+            else
+                worldMatrix = getLocalMatrix();
+
+            worldDirty = false;
+            version++;
+        }
+        return worldMatrix;
+    }
+
+    glm::vec3 getWorldPosition() {
+        return glm::vec3(getWorldMatrix()[3]);
+    }
+
+    // 캐시를 건드리지 않고 로컬 행렬을 계산 (물리 스레드에서 호출해도 안전).
+    // 물리 쪽 world 행렬은 bodyStore.computeWorldMatrix로
+    glm::mat4 computeLocalMatrix() const {
+        return  glm::translate(glm::mat4(1.0f), position)
+                * glm::mat4_cast(rotation)
+                * glm::scale(glm::mat4(1.0f), scale);
+    }
+
+    // world 행렬이 다시 계산될 때마다 증가 (업로드 생략 판단용)
+    uint64_t getVersion() {
+        getWorldMatrix();
+        return version;
+    }
+
+private:
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    Transform* parent = nullptr;
+    std::vector<Transform*> children;
+
+    glm::mat4 localMatrix = glm::mat4(1.0f);
+    glm::mat4 worldMatrix = glm::mat4(1.0f);
+
+    bool localDirty = true;
+    bool worldDirty = true;
+    uint64_t version = 0;
+
+    void markLocalDirty() {
+        localDirty = true;
+        markWorldDirty();
+    }
+
+    // 이미 dirty인 서브트리는 다시 내려가지 않는다
+    void markWorldDirty() {
+        if (worldDirty)
+            return;
+
+        worldDirty = true;
+        for (Transform* child : children)
+            child->markWorldDirty();
+    }
+};
+
+// collider는 world 기준. transform에 부모가 있으면 로컬 pos / rot을 부모의 world 행렬로 옮겨 넣는다.
+void placeCollider(ColliderBox* collider, Transform* transform, glm::vec3 pos, glm::quat rot);
+
+class Models {
+public:
+    VkImage textureImage;
+    VkDeviceMemory textureImageMemory;
+    VkImageView textureImageView;
+
+    VkImage alphaTextureImage;
+    VkDeviceMemory alphaTextureImageMemory;
+    VkImageView alphaTextureImageView;
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+
+    // OBJ에 법선이 없을 때 smooth normal 계산 기준 (도). 인접 면 사이 각이 이보다 크면 모서리를 유지.
+    float creaseAngle = 60.0f;
+
+    // normal mapping 용 tangent (xyz: tangent, w: bitangent 방향). generateTangents일 때만 채움.
+    bool generateTangents = false;
+    std::vector<glm::vec4> tangents;
+
+    // 정점이 65536개 이하면 GPU에는 uint16으로 올린다 (loadModel에서 결정)
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+
+    // geometryPool 내 위치
+    GeometryBlock* geometryBlock = nullptr;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t vertexOffset;
+    // 블록에서 차지한 byte 수 (release 용)
+    VkDeviceSize vertexBytes;
+    VkDeviceSize indexBytes;
+
+    std::vector<VkBuffer> uniformBuffers;
+    std::vector<VkDeviceMemory> uniformBuffersMemory;
+    // createUniformBuffers에서 매핑해 두고 파괴할 때 해제
+    std::vector<void*> uniformBuffersMapped;
+
+    VkBuffer texelUniformBuffer;
+    VkDeviceMemory texelUniformBuffersMemory;
+    VkBufferView texelUniformBuffersView;
+    VkDeviceSize texelDeviceSize;
+    void* texelDataPoint;
+
+    VkBuffer texelVertexBuffer;
+    VkDeviceMemory texelVertexBuffersMemory;
+    VkBufferView texelVertexBuffersView;
+
+    // set 0 : 이번 프레임의 UBO / texel buffer. drawFrame마다 프레임 할당기에서 새로 받는다.
+    VkDescriptorSet frameSet = VK_NULL_HANDLE;
+    // set 1 : 텍스처 (descriptorCache로 같은 텍스처의 모델끼리 공유)
+    VkDescriptorSet materialSet = VK_NULL_HANDLE;
+
+    VkPipeline graphicsPipeline;
+
+    // bindless 모드 : 전역 draw 버퍼 / 텍스처 배열 내 인덱스
+    uint32_t drawIndex;
+    uint32_t textureIndex;
+    uint32_t alphaIndex;
+
+    /////////////////////////////////
+    std::string Name;
+
+    std::string objectPath;
+    std::string texturePath;
     std::string alphaPath;
 
-    glm::vec3 Position;
-    glm::vec3 Rotate;
-    glm::vec3 Scale;
+    // 부모는 GameObject의 transform
+    Transform transform;
 
     struct initParam _initParam;
 
@@ -678,10 +1838,6 @@ public:
         this->texturePath = textPath;
         this->alphaPath = std::string("");
 
-        Position = glm::vec3(0.0f);
-        Rotate = glm::vec3(0.0f);
-        Scale = glm::vec3(1.0f);
-
         this->_initParam.vertPath = "spv/GameObject/vert.spv";
         this->_initParam.fragPath = fragPath;
 
@@ -697,9 +1853,7 @@ public:
         this->texturePath = textPath;
         this->alphaPath = std::string("");
 
-        Position = glm::vec3(0.0f);
-        Rotate = glm::vec3(0.0f);
-        this->Scale = scale;
+        this->transform.setScale(scale);
 
         this->_initParam.vertPath = "spv/GameObject/vert.spv";
         this->_initParam.fragPath = "spv/GameObject/base.spv";
@@ -716,9 +1870,9 @@ public:
         this->texturePath = textPath;
         this->alphaPath = std::string("");
 
-        this->Position = pos;
-        this->Rotate = rot;
-        this->Scale = scale;
+        this->transform.setPosition(pos);
+        this->transform.setRotate(rot);
+        this->transform.setScale(scale);
 
         this->_initParam.vertPath = "spv/GameObject/vert.spv";
         this->_initParam.fragPath = "spv/GameObject/base.spv";
@@ -729,6 +1883,232 @@ public:
     }
 };
 
+// 물체 N개의 위치 / 회전 / 크기 배열 (성분별). 회전은 euler(도) 또는 quat(x, y, z, w) 중 하나만 채운다.
+struct TransformArrays {
+    const float* position[3];
+    const float* euler[3];
+    const float* quat[4];
+    const float* scale[3];
+};
+
+// T * R * S 모델 행렬(열 우선 mat4) N개를 dst부터 stride 바이트 간격으로 기록.
+// 매핑된 uniform / storage 버퍼에 바로 쓸 수 있다. AVX2 / SSE / 스칼라 순으로 처리.
+void composeModelMatrices(const TransformArrays& in, size_t count, void* dst, size_t stride);
+
+void benchmarkMatrixKernel(size_t count = 10000, int iterations = 100);
+
+// BodyStore 슬롯 핸들. 슬롯이 재사용되면 generation이 바뀌어 이전 핸들은 무효가 된다.
+struct BodyHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool valid() const { return index != UINT32_MAX; }
+};
+
+// GameObject의 위치/회전/크기/속도/가속도/토크를 성분별 연속 배열(SoA)로 보관.
+// 삭제는 마지막 원소와 자리를 바꿔서 배열을 항상 빈틈없이 유지한다.
+// GameObject 루트 transform의 원본은 여기이며, syncTransforms에서 Transform으로 옮긴다.
+class BodyStore {
+public:
+    // 성분 시작 열. ROTATION은 쿼터니언 (x, y, z, w), 나머지는 vec3 (x, y, z)
+    // TORQUE / ACCEL_TORQUE는 로컬 축 기준 각속도 / 각가속도 (도)
+    enum Column {
+        POSITION        = 0,
+        ROTATION        = 3,
+        SCALE           = 7,
+        VELOCITY        = 10,
+        ACCEL           = 13,
+        TORQUE          = 16,
+        ACCEL_TORQUE    = 19,
+        COLUMN_COUNT    = 22,
+
+        // 보간 대상 (위치, 회전, 크기)
+        STATE_COUNT     = 10
+    };
+
+    // dirty 비트. 물리 step은 collider만, 렌더링은 transform만 소비한다.
+    enum DirtyBits {
+        DIRTY_TRANSFORM = 1,
+        DIRTY_COLLIDER  = 2,
+        DIRTY_ALL       = 3
+    };
+
+    std::vector<float> columns[COLUMN_COUNT];
+
+    // dense 인덱스별 부가 정보
+    std::vector<uint8_t> dirty;
+    std::vector<Transform*> transforms;
+    std::vector<ColliderBox*> colliders;
+    std::vector<uint32_t> denseToSlot;
+
+    BodyHandle create(glm::vec3 pos, glm::quat rot, glm::vec3 scale, Transform* transform = nullptr);
+    void destroy(BodyHandle handle);
+
+    bool alive(BodyHandle handle) {
+        return handle.index < slots.size() && slots[handle.index].generation == handle.generation && slots[handle.index].dense != UINT32_MAX;
+    }
+
+    uint32_t dense(BodyHandle handle) {
+        if (!alive(handle))
+            throw std::runtime_error("만료된 BodyHandle");
+        return slots[handle.index].dense;
+    }
+
+    size_t size()                                           { return denseToSlot.size(); }
+
+    // vec3 열 (ROTATION 제외)
+    glm::vec3 get(BodyHandle handle, Column col)            { return get(dense(handle), col); }
+    void set(BodyHandle handle, Column col, glm::vec3 v)    { set(dense(handle), col, v); }
+    void add(BodyHandle handle, Column col, glm::vec3 v)    { uint32_t d = dense(handle); set(d, col, get(d, col) + v); }
+
+    glm::quat getRotation(BodyHandle handle)                { return getRotation(dense(handle)); }
+    void setRotation(BodyHandle handle, glm::quat q)        { setRotation(dense(handle), q); }
+
+    void setCollider(BodyHandle handle, ColliderBox* collider) {
+        uint32_t d = dense(handle);
+        colliders[d] = collider;
+        dirty[d] = DIRTY_ALL;
+    }
+
+    // v += a * dt, p += v * dt, 회전은 각속도로 쿼터니언 적분. 움직인 body만 dirty.
+    void integrate(float dt);
+
+    // 마지막 integrate 직전의 로컬 위치 (연속 충돌에서 이번 step 이동 구간의 시작)
+    glm::vec3 getStepStart(BodyHandle handle) {
+        uint32_t d = dense(handle);
+        if (d >= stepStart[0].size())
+            return get(d, POSITION);
+        return glm::vec3(stepStart[0][d], stepStart[1][d], stepStart[2][d]);
+    }
+
+    // dirty인 body를 Transform / ColliderBox에 반영. local 행렬은 composeModelMatrices로 한 번에 만든다.
+    void syncTransforms();
+
+    // 고정 step용 : collider만 반영 (Transform은 syncInterpolated가 맡는다)
+    void syncColliders();
+
+    // step이 끝날 때마다 호출. 직전 상태를 prev로 밀고 현재 위치 / 회전 / 크기를 curr에 복사한다.
+    void captureState();
+
+    // prev와 curr 사이 alpha 지점을 Transform에 반영 (렌더링 스레드)
+    void syncInterpolated(float alpha);
+
+    // 물리 쪽 world 행렬 / 회전. body가 있는 조상은 Transform(스레드 모드에서는 보간된 렌더 상태) 대신
+    // 이 store의 현재 값을 쓴다. body가 없는 조상은 Transform 값 그대로.
+    glm::mat4 computeWorldMatrix(const Transform* transform);
+    glm::quat computeWorldRotation(const Transform* transform);
+
+    TransformArrays arrays(size_t offset = 0)               { return arraysOf(columns, offset); }
+
+private:
+    struct Slot {
+        uint32_t dense;
+        uint32_t generation;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+
+    // Transform -> dense (computeWorldMatrix가 조상의 body를 찾을 때)
+    std::unordered_map<const Transform*, uint32_t> transformBodies;
+
+    // syncTransforms 작업 공간
+    std::vector<glm::mat4> localMatrices;
+
+    // integrate 직전 위치 (열 배치는 columns[POSITION .. POSITION + 3)과 같음)
+    std::vector<float> stepStart[3];
+
+    // 마지막 두 step의 상태 (열 배치는 columns[0 .. STATE_COUNT)와 같음)와 보간 결과
+    std::vector<float> prevState[STATE_COUNT];
+    std::vector<float> currState[STATE_COUNT];
+    std::vector<float> blendedState[STATE_COUNT];
+    // 2 : 이번 step에 움직임, 1 : 멈춘 뒤 최종 상태를 한 번 더 반영, 0 : 건너뜀
+    std::vector<uint8_t> interpolating;
+
+    static TransformArrays arraysOf(std::vector<float>* cols, size_t offset) {
+        TransformArrays in{};
+        for (int c = 0; c < 3; c++) {
+            in.position[c] = cols[POSITION + c].data() + offset;
+            in.scale[c] = cols[SCALE + c].data() + offset;
+        }
+        for (int c = 0; c < 4; c++)
+            in.quat[c] = cols[ROTATION + c].data() + offset;
+        return in;
+    }
+
+    glm::vec3 get(uint32_t d, Column col) {
+        return glm::vec3(columns[col][d], columns[col + 1][d], columns[col + 2][d]);
+    }
+
+    void set(uint32_t d, Column col, glm::vec3 v) {
+        columns[col][d] = v.x;
+        columns[col + 1][d] = v.y;
+        columns[col + 2][d] = v.z;
+
+        if (col == POSITION || col == SCALE)
+            dirty[d] = DIRTY_ALL;
+    }
+
+    glm::quat getRotation(uint32_t d) {
+        return glm::quat(columns[ROTATION + 3][d], columns[ROTATION][d], columns[ROTATION + 1][d], columns[ROTATION + 2][d]);
+    }
+
+    void setRotation(uint32_t d, glm::quat q) {
+        columns[ROTATION][d] = q.x;
+        columns[ROTATION + 1][d] = q.y;
+        columns[ROTATION + 2][d] = q.z;
+        columns[ROTATION + 3][d] = q.w;
+        dirty[d] = DIRTY_ALL;
+    }
+};
+
+BodyStore bodyStore;
+
+void benchmarkBodyStore(size_t count = 100000, int iterations = 100);
+
+// 고정 간격 물리 스케줄러. 흐른 시간을 누적해 1 / stepRate 간격으로 step을 돌리고
+// 렌더링은 마지막 두 step 사이를 보간하므로 시뮬레이션 결과가 프레임 속도에 묶이지 않는다.
+class PhysicsScheduler {
+public:
+    float stepRate = 60.0f;
+    // 한 번에 따라잡을 최대 step 수. 넘는 시간은 버린다.
+    int maxSubSteps = 5;
+    // true면 start()가 전용 스레드를 띄우고 advance()는 아무것도 하지 않는다
+    bool threaded = false;
+
+    // step 한 번과 bodyStore를 읽고 쓰는 쪽(Update, drawFrame)이 잡는 락
+    std::mutex mutex;
+
+    void start(std::function<void()> step);
+    void stop();
+
+    // 메인 스레드 모드에서 프레임마다 흐른 시간(초)을 넘긴다
+    void advance(float frameTime);
+
+    bool isRunning()                { return running; }
+    float getStep()                 { return 1.0f / stepRate; }
+
+    // 마지막 step 이후 흐른 시간 / step 간격 (0 ~ 1)
+    float getAlpha();
+
+    uint64_t getStepCount()         { return stepCount; }
+
+private:
+    std::function<void()> step;
+    std::thread worker;
+    std::atomic<bool> running{ false };
+
+    // 스레드 모드에서는 worker만 쓰고 렌더링 스레드는 읽기만 한다
+    std::atomic<float> accumulator{ 0.0f };
+    std::atomic<int64_t> lastAdvanceNs{ 0 };
+    std::atomic<uint64_t> stepCount{ 0 };
+
+    void runSteps(float frameTime);
+    void threadLoop();
+};
+
+PhysicsScheduler physicsScheduler;
+
 class GameObject {
 public:
     // Union Function
@@ -746,15 +2126,20 @@ public:
 
     std::string Name;
 
-    glm::vec3 Position;
-    glm::vec3 Rotation;
-    glm::vec3 Scale;
+    // models의 부모. 다른 GameObject 아래에 붙일 수도 있다.
+    // 위치/회전/크기의 원본은 bodyStore이고 transform은 매 프레임 동기화된다.
+    Transform transform;
+
+    // bodyStore 내 위치, 회전, 크기, 속도, 가속도, 토크
+    BodyHandle body;
 
     ColliderBox* collider;
 
-    // 속도와 가속도
-    glm::vec3 velo;
-    glm::vec3 accel;
+    // broadPhase 내 proxy (collider가 없으면 -1)
+    int proxyId = -1;
+
+    // 한 step 이동이 collider 크기보다 클 수 있는 빠른 물체. 이동을 첫 접촉까지로 자른다.
+    bool continuousCollision = false;
 
     void createDescriptorSetLayout();
     void createComputePipeline();
@@ -762,118 +2147,133 @@ public:
     void createTextureImage();
     void createTextureImageView();
     void loadModel();
-    void createVertexBuffer();
-    void createIndexBuffer();
+    void createGeometryBuffer();
     void createUniformBuffers();
     void createTexelUniformBuffers();
-    void createDescriptorPool();
     void createDescriptorSets();
     void allocateTexelUniformBuffer();
+    void registerBindless();
 
 public:
     GameObject(std::string Name, std::string objectPath, std::string texturePath) {
         this->Name = Name; 
 
-        models.push_back(new Models(Name, objectPath, texturePath));
-
-        this->Position = glm::vec3(0.0f);
-        this->Rotation = glm::vec3(0.0f);
-        this->Scale = glm::vec3(1.0f);
+        appendModel(Name, objectPath, texturePath);
 
+        this->body = bodyStore.create(glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f), &transform);
         this->collider = NULL;
     }
 
     GameObject(std::string Name, std::string objectPath, std::string texturePath, glm::vec3 Position, glm::vec3 Rotate, glm::vec3 Scale, std::string fragPath) {
         this->Name = Name; 
 
-        models.push_back(new Models(Name, objectPath, texturePath, fragPath));
-
-        this->Position = Position;
-        this->Rotation = Rotate;
-        this->Scale = Scale;
+        appendModel(Name, objectPath, texturePath, fragPath);
 
+        this->body = bodyStore.create(Position, eulerToQuat(Rotate), Scale, &transform);
         this->collider = NULL;
     }
 
+    ~GameObject() {
+        unregisterCollider(this);
+        bodyStore.destroy(body);
+    }
+
     // getter setter
     void setIndex(uint32_t idx)             { this->Index = idx; }
     void setName(std::string name)          { this->Name = name; }
-    void setPosition(glm::vec3 pos)         {   this->Position = pos;
-                                                if (this->collider) {
-                                                    this->collider->posX = this->Position.x;
-                                                    this->collider->posY = this->Position.y;
-                                                    this->collider->posZ = this->Position.z;
-                                                }
+    void setPosition(glm::vec3 pos)         {   bodyStore.set(body, BodyStore::POSITION, pos);
+                                                syncCollider();
                                             }
 
-    void setRotate(glm::vec3 rot)           {   this->Rotation = rot;
-                                                this->Rotation.x *= -1;
+    void setRotate(glm::vec3 rot)           {   rot.x *= -1;
+                                                setRotation(eulerToQuat(rot));
+                                            }
 
-                                                this->collider->rotX = Rotation.x;
-                                                this->collider->rotY = Rotation.y;
-                                                this->collider->rotZ = Rotation.z;
+    void setRotation(glm::quat rot)         {   bodyStore.setRotation(body, rot);
+                                                syncCollider();
                                             }
 
-    void setScale(glm::vec3 scale)          { this->Scale = scale; }
+    void setScale(glm::vec3 scale)          { bodyStore.set(body, BodyStore::SCALE, scale); }
+
+    // 다른 GameObject의 자식으로 붙인다 (NULL이면 루트로)
+    void setParent(GameObject* parent)      {   this->transform.setParent(parent ? &parent->transform : nullptr);
+                                                syncCollider();
+                                            }
 
     uint32_t getIndex()                     { return Index; }
     std::string getName()                   { return Name; }
-    glm::vec3 getPosition()                 { return Position; }
-    glm::vec3 getRotate()                   { return Rotation; }
-    glm::vec3 getScale()                    { return Scale; }
+    glm::vec3 getPosition()                 { return bodyStore.get(body, BodyStore::POSITION); }
+    glm::vec3 getRotate()                   { return quatToEuler(getRotation()); }
+    glm::quat getRotation()                 { return bodyStore.getRotation(body); }
+    glm::vec3 getScale()                    { return bodyStore.get(body, BodyStore::SCALE); }
 
     // Transpose
     void Move(glm::vec3 vel)                { 
-                                                this->Position += vel;
-                                                this->collider->posX = this->Position.x;
-                                                this->collider->posY = this->Position.y;
-                                                this->collider->posZ = this->Position.z;
-
+                                                if (continuousCollision && proxyId != -1)
+                                                    vel = clampContinuousMotion(this, vel);
 
+                                                bodyStore.add(body, BodyStore::POSITION, vel);
+                                                syncCollider();
                                             }
 
     void Rotate(glm::vec3 torq)             { 
-                                                this->Rotation += torq;
-                                                this->collider->rotX = this->Rotation.x;
-                                                this->collider->rotY = this->Rotation.y;
-                                                this->collider->rotZ = this->Rotation.z;
+                                                // 로컬 축 기준 (도)
+                                                setRotation(getRotation() * eulerToQuat(torq));
                                             }
 
     glm::vec3 getNormal() {
-        // return glm::vec3(-sin(glm::radians(Rotation.y)), sin(glm::radians(Rotation.x)), -cos(glm::radians(Rotation.y)));
-        return glm::vec3(-sin(glm::radians(Rotation.y)), 0.0f, -cos(glm::radians(Rotation.y)));
+        // 수평면 위의 앞 방향
+        glm::vec3 front = getRotation() * glm::vec3(0.0f, 0.0f, -1.0f);
+        front.y = 0.0f;
+
+        float len = glm::length(front);
+        return len > 0.0f ? front / len : glm::vec3(0.0f, 0.0f, -1.0f);
     }
 
     // append subModel 
     void appendModel(std::string Name, std::string objectPath, std::string texturePath, std::string fragPath = "spv/GameObject/base.spv") {
         models.push_back(new Models(Name, objectPath, texturePath, fragPath));
+        transform.addChild(&models.back()->transform);
     }
 
     void appendModel(std::string Name, std::string objectPath, std::string texturePath, glm::vec3 pos, glm::vec3 rot, glm::vec3 scale) {
         models.push_back(new Models(Name, objectPath, texturePath, pos, rot, scale));
+        transform.addChild(&models.back()->transform);
     }
 
     void adaptCollider(glm::vec3 scale) {
         this->collider = new ColliderBox();
 
-        this->collider->setSize3D(this->Position, glm::vec3(0.0f), glm::vec3(0.0f), scale);
+        this->collider->setSize3D(getPosition(), glm::vec3(0.0f), glm::vec3(0.0f), scale);
+        syncCollider();
+        bodyStore.setCollider(body, collider);
+        registerCollider(this);
     }
 
     void adaptCollider(glm::vec3 localPos, glm::vec3 scale) {
         this->collider = new ColliderBox();
-        this->collider->setSize3D(this->Position, localPos, glm::vec3(0.0f), scale);
+        this->collider->setSize3D(getPosition(), localPos, glm::vec3(0.0f), scale);
+        syncCollider();
+        bodyStore.setCollider(body, collider);
+        registerCollider(this);
     }
 
     void setCollider() {
         this->collider->setSize3D();
     }
 
+    // collider 위치 / 회전을 world 기준으로 맞춘다
+    void syncCollider() {
+        if (this->collider)
+            placeCollider(this->collider, &transform, getPosition(), getRotation());
+    }
+
     bool onColliderEnter(GameObject* go) {
         return this->collider->isCollisionEnter3D(go->collider);
     }
 
-    bool onCollider(GameObject* go) {
-        return this->collider->isCollision3D(go->collider);
+    bool onCollider(GameObject* go, ContactManifold* contact = nullptr) {
+        return this->collider->isCollision3D(go->collider, contact);
     }
 
     void drawCollider() {
@@ -895,134 +2295,162 @@ public:
     } 
 
     void initObject() {
-        createDescriptorSetLayout();
-        createComputePipeline();
-        createGraphicsPipeline();
-        createTextureImage();
-        createTextureImageView();
-        loadModel();
-        createVertexBuffer();
-        createIndexBuffer();
-        createUniformBuffers();
-        createTexelUniformBuffers();
-        createDescriptorPool();
-        createDescriptorSets();
-    }
+        PROFILE_ZONE("initObject");
 
-    void refresh() {
-        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        {
+            PROFILE_ZONE("initObject/pipelines");
+            createDescriptorSetLayout();
+            createComputePipeline();
+            createGraphicsPipeline();
+        }
+        {
+            PROFILE_ZONE("initObject/textures");
+            createTextureImage();
+            createTextureImageView();
+        }
+        {
+            PROFILE_ZONE("initObject/geometry");
+            loadModel();
+            createGeometryBuffer();
+        }
 
-        for (Models* m : models) {
-            vkDestroyPipeline(device, m->graphicsPipeline, nullptr);
+        {
+            PROFILE_ZONE("initObject/descriptors");
 
-            for (size_t i = 0; i < swapChainImages.size(); i++) {
-                vkDestroyBuffer(device, m->uniformBuffers[i], nullptr);
-                vkFreeMemory(device, m->uniformBuffersMemory[i], nullptr);
+            // bindless : 전역 셋에 텍스처와 draw 슬롯만 등록
+            if (enableBindless) {
+                registerBindless();
+                return;
             }
 
-            vkDestroyBuffer(device, m->texelUniformBuffer, nullptr);
-            vkFreeMemory(device, m->texelUniformBuffersMemory, nullptr);
-            vkDestroyBufferView(device, m->texelUniformBuffersView, nullptr);
-
-            vkDestroyDescriptorPool(device, m->descriptorPool, nullptr);
-
-            createGraphicsPipeline();
             createUniformBuffers();
             createTexelUniformBuffers();
-            createDescriptorPool();
             createDescriptorSets();
         }
     }
 
-    void destroy() {
-        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
-        vkDestroyPipelineLayout(device, computePipelineLayout, nullptr);
+    // drawFrame에서 프레임마다 set 0을 프레임 할당기에서 새로 받는다
+    void allocateFrameSets();
+
+    void refresh() {
+        if (enableBindless) {
+            for (Models* m : models)
+                vkDestroyPipeline(device, m->graphicsPipeline, nullptr);
+
+            createGraphicsPipeline();
+            return;
+        }
 
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-        vkDestroyPipeline(device, computesPipeline, nullptr);
 
         for (Models* m : models) {
             vkDestroyPipeline(device, m->graphicsPipeline, nullptr);
 
-            for (size_t i = 0; i < swapChainImages.size(); i++) {
+            for (size_t i = 0; i < swapChainImageCount(); i++) {
+                vkUnmapMemory(device, m->uniformBuffersMemory[i]);
                 vkDestroyBuffer(device, m->uniformBuffers[i], nullptr);
                 vkFreeMemory(device, m->uniformBuffersMemory[i], nullptr);
             }
-            
+
             vkDestroyBuffer(device, m->texelUniformBuffer, nullptr);
             vkFreeMemory(device, m->texelUniformBuffersMemory, nullptr);
             vkDestroyBufferView(device, m->texelUniformBuffersView, nullptr);
+        }
 
-            vkDestroyBuffer(device, m->texelVertexBuffer, nullptr);
-            vkFreeMemory(device, m->texelVertexBuffersMemory, nullptr);
-            vkDestroyBufferView(device, m->texelVertexBuffersView, nullptr);
+        createGraphicsPipeline();
+        createUniformBuffers();
+        createTexelUniformBuffers();
+        createDescriptorSets();
+    }
 
-            vkDestroyDescriptorPool(device, m->descriptorPool, nullptr);
+    void destroy() {
+        // bindless 모드의 셋 레이아웃, 파이프라인 레이아웃은 전역 소유
+        if (!enableBindless) {
+            // 재질 셋은 캐시로 반환. 프레임 셋은 프레임 할당기 reset 때 같이 사라진다.
+            for (Models* m : models) {
+                descriptorCache.release(m->materialSet);
+                m->materialSet = VK_NULL_HANDLE;
+            }
 
-            if (!m->alphaPath.empty()) {
-                vkDestroyImageView(device, m->alphaTextureImageView, nullptr);
+            vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+            vkDestroyPipelineLayout(device, computePipelineLayout, nullptr);
+            vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        }
+        vkDestroyPipeline(device, computesPipeline, nullptr);
 
-                vkDestroyImage(device, m->alphaTextureImage, nullptr);
-                vkFreeMemory(device, m->alphaTextureImageMemory, nullptr);            
-            }
-            vkDestroyImageView(device, m->textureImageView, nullptr);
+        for (Models* m : models) {
+            vkDestroyPipeline(device, m->graphicsPipeline, nullptr);
 
-            vkDestroyImage(device, m->textureImage, nullptr);
-            vkFreeMemory(device, m->textureImageMemory, nullptr);
+            geometryPool.release(m);
 
-            vkDestroyBuffer(device, m->indexBuffer, nullptr);
-            vkFreeMemory(device, m->indexBufferMemory, nullptr);
+            if (enableBindless) {
+                releaseBindlessDraw(m->drawIndex);
+                releaseBindlessTexture(m->textureIndex);
+                if (!m->alphaPath.empty())
+                    releaseBindlessTexture(m->alphaIndex);
+            }
+            else {
+                for (size_t i = 0; i < swapChainImageCount(); i++) {
+                    vkUnmapMemory(device, m->uniformBuffersMemory[i]);
+                    vkDestroyBuffer(device, m->uniformBuffers[i], nullptr);
+                    vkFreeMemory(device, m->uniformBuffersMemory[i], nullptr);
+                }
+                
+                vkDestroyBuffer(device, m->texelUniformBuffer, nullptr);
+                vkFreeMemory(device, m->texelUniformBuffersMemory, nullptr);
+                vkDestroyBufferView(device, m->texelUniformBuffersView, nullptr);
+
+                vkDestroyBuffer(device, m->texelVertexBuffer, nullptr);
+                vkFreeMemory(device, m->texelVertexBuffersMemory, nullptr);
+                vkDestroyBufferView(device, m->texelVertexBuffersView, nullptr);
+            }
 
-            vkDestroyBuffer(device, m->vertexBuffer, nullptr);
-            vkFreeMemory(device, m->vertexBufferMemory, nullptr);
+            // 같은 경로를 쓰는 다른 모델이 남아 있으면 이미지는 유지
+            if (!m->alphaPath.empty())
+                releaseTexture(m->alphaPath);
+            releaseTexture(m->texturePath);
         }
     }
 
-    // Transpose
-
-    // 회전 속도와 회전 가속도
-    glm::vec3 torque;
-    glm::vec3 accelTorque;
-
     // Transpose 
     void setVelocity(glm::vec3 vel) {
-        this->velo = vel;
+        bodyStore.set(body, BodyStore::VELOCITY, vel);
     }
     void setAccel(glm::vec3 accel) {
-        this->accel = accel;
+        bodyStore.set(body, BodyStore::ACCEL, accel);
     }
 
     void setTorque(glm::vec3 torq) {
-        this->torque = torq;
+        bodyStore.set(body, BodyStore::TORQUE, torq);
     }
 
     void setAccelTorque(glm::vec3 accelTorq) {
-        this->accelTorque = accelTorq;
+        bodyStore.set(body, BodyStore::ACCEL_TORQUE, accelTorq);
     }
 
     glm::vec3 getVelocity() {
-        return this->velo;
+        return bodyStore.get(body, BodyStore::VELOCITY);
     }
     glm::vec3 getAccel() {
-        return this->accel;
+        return bodyStore.get(body, BodyStore::ACCEL);
     }
     glm::vec3 getTorque() {
-        return this->torque;
+        return bodyStore.get(body, BodyStore::TORQUE);
     }
     glm::vec3 getAccelTorque() {
-        return this->accelTorque;
+        return bodyStore.get(body, BodyStore::ACCEL_TORQUE);
     }
 
-    // 초당 속도 계산기
+    // 초당 속도 계산기 (여러 물체는 bodyStore.integrate로 한 번에)
     glm::vec3 velBySec(float nanoSec) {
-        velo += accel * nanoSec;
-        return velo * nanoSec;
+        bodyStore.add(body, BodyStore::VELOCITY, getAccel() * nanoSec);
+        return getVelocity() * nanoSec;
     }
 
     // 초당 토크 계산기
     glm::vec3 torqBySec(float nanoSec) {
-        torque += accelTorque * nanoSec;
-        return torque * nanoSec;
+        bodyStore.add(body, BodyStore::TORQUE, getAccelTorque() * nanoSec);
+        return getTorque() * nanoSec;
     }
 
     // void interaction(GameObject* target, float delta) 
@@ -1041,69 +2469,274 @@ public:
     void interaction(   GameObject* target,
                         float delta) 
     {
-        glm::vec3 theta(Position - target->Position);   
+        glm::vec3 theta(getPosition() - target->getPosition());   
         float R = glm::length(theta);
-        float zDegree = target->Rotation.z;
+        float zDegree = target->getRotate().z;
         
-        this->velo = R * glm::vec3(     cos(glm::radians(zDegree)), 
+        setVelocity(R * glm::vec3(      cos(glm::radians(zDegree)), 
                                         sin(glm::radians(zDegree)), 
                                         0
-                                    ) - Position;
+                                    ) - getPosition());
     }
 };
 
-class UI {
+// 클릭 가능한 UI의 Extent(WIDTH x HEIGHT 기준 픽셀)를 담는 AABB 트리.
+// 점 질의는 O(log n)이고, 겹치면 zOrder가 큰 (같으면 나중에 만든) UI가 위에 있다.
+class UIHitIndex {
 public:
-    VkImage textureImage;
-    VkDeviceMemory textureImageMemory;
-    VkImageView textureImageView;
+    UIHitIndex() { tree.fatMargin = 0.0f; }
+
+    void insert(UI* ui);
+    void remove(UI* ui);
+    // Extent가 바뀐 뒤 호출 (zOrder는 pick에서 바로 읽는다)
+    void update(UI* ui);
+
+    // 기준 해상도 좌표 (x, y)의 가장 위 UI, 없으면 NULL
+    UI* pick(float x, float y);
+
+    size_t size()                           { return count; }
+
+private:
+    DynamicAABBTree tree;
+    size_t count = 0;
+};
+
+UIHitIndex uiHitIndex;
+
+// 창 좌표 (glfwGetCursorPos)를 기준 해상도로 바꿔서 uiHitIndex.pick
+UI* pickUI(double windowX, double windowY);
+
+// 보이는 UI와 Text 사각형을 프레임마다 하나의 영구 매핑 정점 버퍼에 모아 draw 한 번(사각형 16384개마다 하나)으로 그린다.
+// 텍스처와 글리프는 하나의 atlas에 모으고, 인덱스는 사각형 패턴 (0 1 2 2 3 0)을 미리 채운 고정 uint16 버퍼.
+// 배치는 유지(retained)된다: 요소가 바뀌면 버전을 올리고, record는 바뀐 요소의 사각형만 다시 만들어
+// 그 frame 버퍼의 해당 구간에만 쓴다. 아무것도 바뀌지 않은 프레임은 정점을 건드리지 않고 bind / draw만 한다.
+class UIBatcher {
+public:
+    struct UIVertex {
+        glm::vec2 pos;
+        glm::vec2 texCoord;
+    };
+
+    // 정규화 좌표 (x0, y0, x1, y1)와 atlas uv (u0, v0, u1, v1)
+    struct UIQuad {
+        glm::vec4 rect;
+        glm::vec4 uv;
+    };
+
+    // WIDTH x HEIGHT 기준 픽셀 사각형을 정규화 좌표로
+    static glm::vec4 toNormExtent(glm::vec4 extent) {
+        float hw = WIDTH / 2.0f, hh = HEIGHT / 2.0f;
+        return glm::vec4((extent[0] - hw) / hw, (extent[1] - hh) / hh, (extent[2] - hw) / hw, (extent[3] - hh) / hh);
+    }
+
+    // uint16 인덱스 한 벌로 그릴 수 있는 사각형 수
+    static const uint32_t quadsPerDraw = 65536 / 4;
+
+    uint32_t atlasSize = 2048;
+
+    void init();
+    void destroy();
+    // swapchain을 다시 만든 뒤 (renderPass와 viewport가 바뀐다)
+    void refresh();
+
+    // 텍스처를 atlas에 넣고 uv 사각형 (u0, v0, u1, v1)을 돌려준다. 같은 경로는 한 번만 올린다.
+    glm::vec4 addTexture(const std::string& path);
+    // RGBA 픽셀을 key 이름으로 올린다. inset이면 가장자리 텍셀 중심까지의 uv, 아니면 칸 경계 그대로
+    glm::vec4 addImage(const std::string& key, const unsigned char* rgba, int width, int height, bool inset = true);
+
+    // 보이는 UI와 Text를 zOrder 순으로 그린다. frame의 정점 버퍼는 마지막으로 쓴 뒤 바뀐 부분만 갱신
+    void record(VkCommandBuffer commandBuffer, uint32_t frame);
+
+    // 요소 하나의 사각형만 바뀜 (위치 / 글자 내용). 그 요소만 다시 쓴다.
+    void touch(uint64_t& elementVersion)    { elementVersion = ++version; }
+    // 그릴 요소 / 순서 / 사각형 수가 바뀜. 전체를 다시 배치한다.
+    void touchLayout()                      { layoutVersion = ++version; }
+
+    uint32_t getQuadCount()                 { return quadCount; }
+    uint32_t getDrawCount()                 { return drawCount; }
+    // 마지막 record에서 정점 버퍼에 쓴 사각형 수 (바뀐 것이 없으면 0)
+    uint32_t getWrittenQuadCount()          { return writtenQuadCount; }
+
+private:
+    VkImage atlasImage = VK_NULL_HANDLE;
+    VkDeviceMemory atlasMemory;
+    VkImageView atlasView;
+    VkSampler atlasSampler;
+
+    // 선반(shelf) 방식 배치: 한 줄씩 왼쪽부터 채우고 넘치면 다음 줄
+    uint32_t shelfX = 0, shelfY = 0, shelfHeight = 0;
+    std::unordered_map<std::string, glm::vec4> atlasEntries;
 
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
-    VkBuffer vertexBuffer;
-    VkDeviceMemory vertexBufferMemory;
     VkBuffer indexBuffer;
     VkDeviceMemory indexBufferMemory;
 
-    std::vector<VkBuffer> uniformBuffers;
-    std::vector<VkDeviceMemory> uniformBuffersMemory;
-
-    VkDescriptorPool descriptorPool;
-    std::vector<VkDescriptorSet> descriptorSets;
+    VkBuffer vertexBuffers[MAX_FRAMES_IN_FLIGHT] = {};
+    VkDeviceMemory vertexBuffersMemory[MAX_FRAMES_IN_FLIGHT];
+    void* vertexDataPoint[MAX_FRAMES_IN_FLIGHT];
+    uint32_t vertexCapacity[MAX_FRAMES_IN_FLIGHT] = {};
 
     VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorSet descriptorSet;
     VkPipelineLayout pipelineLayout;
     VkPipeline graphicsPipeline;
 
-    //////////////////////
+    // zOrder로 정렬할 UI 또는 Text와 quads 안의 구간
+    struct DrawItem {
+        int zOrder;
+        UI* ui;
+        Text* text;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    std::vector<DrawItem> drawItems;
+    std::vector<UIQuad> quads;
+    uint32_t quadCount = 0;
+    uint32_t drawCount = 0;
+    uint32_t writtenQuadCount = 0;
+
+    // 바뀔 때마다 증가. 요소 / 배치 / 버퍼가 반영한 버전을 비교해 바뀐 것만 다시 쓴다.
+    uint64_t version = 1;
+    uint64_t layoutVersion = 1;
+    // quads(CPU 쪽)가 반영한 버전
+    uint64_t builtVersion = 0;
+    uint64_t builtLayoutVersion = 0;
+    // frame별 정점 버퍼가 반영한 버전 (버퍼가 둘이라 바뀐 요소는 각 버퍼에 한 번씩 쓴다)
+    uint64_t frameVersion[MAX_FRAMES_IN_FLIGHT] = {};
+    uint64_t frameLayoutVersion[MAX_FRAMES_IN_FLIGHT] = {};
+
+    void createAtlas();
+    void createIndexBuffer();
+    void createGraphicsPipeline();
+    // frame의 정점 버퍼가 사각형 count개를 담을 수 있게 (fence를 기다린 뒤라 바로 바꿔도 된다)
+    void reserveVertices(uint32_t frame, uint32_t count);
+
+    // UI 트리를 앞에서부터 (부모 먼저) 모은다. 숨긴 UI는 자식까지 빠진다.
+    void collectUI(UI* ui);
+    // drawItems 순서와 quads 전체를 다시 만든다
+    void buildLayout();
+    // 바뀐 요소의 사각형만 quads에 다시 만든다 (글자 수가 바뀌면 buildLayout)
+    void updateQuads();
+    void writeQuads(uint32_t frame, uint32_t first, uint32_t count);
+};
+
+UIBatcher uiBatcher;
+
+// 이름 붙인 GPU 구간의 시간 (timestamp 쌍)과 pipeline statistics.
+// frame마다 query pool 한 벌을 쓰고, 그 frame의 fence를 기다린 다음 기록 직전에 지난 결과를 읽는다 (GPU를 기다리지 않는다)
+class GpuProfiler {
+public:
+    // input assembly 정점 / 프리미티브, vertex shader, clipping 프리미티브, fragment shader, compute shader 호출 수
+    static const uint32_t statisticCount = 6;
+    // 기록하지 않은 구간 (꺼져 있거나 maxScopes를 넘음). endScope에 넘겨도 된다
+    static const uint32_t noScope = UINT32_MAX;
+
+    struct Scope {
+        std::string name;
+        // ms. 최근 historySize 프레임
+        float last = 0.0f, min = 0.0f, avg = 0.0f, max = 0.0f;
+        // statistics 구간의 마지막 값 (statisticCount 순서)
+        uint64_t statistics[statisticCount] = {};
+        bool hasStatistics = false;
+
+        std::vector<float> history;
+        uint32_t cursor = 0;
+        uint32_t count = 0;
+    };
+
+    // initVulkan 전에 켠다 (device feature와 query pool)
+    bool enabled = false;
+    // GameObject마다 구간을 하나씩
+    bool perObject = false;
+    // 한 프레임의 구간 수 상한 (넘으면 기록하지 않는다)
+    uint32_t maxScopes = 256;
+    uint32_t historySize = 120;
+
+    // createLogicalDevice가 켤 device feature
+    void requestFeatures(VkPhysicalDeviceFeatures& features);
+    // 커맨드 풀을 만들 때 (그 큐 패밀리가 timestamp를 지원하지 않으면 꺼진다)
+    void init(uint32_t queueFamily);
+    void destroy();
+
+    bool isActive()                         { return active; }
+
+    // frame의 command buffer를 시작한 직후 (render pass 밖). 이 frame의 지난 결과를 모으고 query를 reset
+    void beginFrame(VkCommandBuffer commandBuffer, uint32_t frame);
+    // 같은 render pass (또는 밖) 안에서 짝을 맞춘다. 중첩 가능하고 statistics는 한 번에 한 구간만 (안쪽은 시간만)
+    uint32_t beginScope(VkCommandBuffer commandBuffer, const std::string& name, bool statistics = false);
+    void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+    const std::vector<Scope>& getScopes()   { return scopes; }
+    // vkDeviceWaitIdle 뒤에 (남은 프레임의 결과까지 모은다)
+    void report(std::ostream& out);
+
+private:
+    struct Record {
+        uint32_t scope;
+        // statistics query 번호 (없으면 noScope)
+        uint32_t statisticsQuery;
+    };
+
+    bool active = false;
+    bool statisticsSupported = false;
+    // ns / tick
+    float timestampPeriod = 1.0f;
+    uint64_t timestampMask = ~0ull;
+
+    VkQueryPool timestampPools[MAX_FRAMES_IN_FLIGHT] = {};
+    VkQueryPool statisticsPools[MAX_FRAMES_IN_FLIGHT] = {};
+    // frame마다 기록한 구간 (record i의 timestamp는 2i, 2i + 1)
+    std::vector<Record> records[MAX_FRAMES_IN_FLIGHT];
+    uint32_t statisticsCount[MAX_FRAMES_IN_FLIGHT] = {};
+
+    uint32_t frame = 0;
+    bool statisticsOpen = false;
+
+    std::vector<Scope> scopes;
+    std::unordered_map<std::string, uint32_t> scopeIds;
+
+    // frame의 query 결과를 scopes에 더한다 (아직이면 건너뛴다)
+    void collect(uint32_t frame);
+    void addSample(Scope& scope, float ms);
+};
+
+GpuProfiler gpuProfiler;
+
+class UI {
+public:
     uint32_t Index;
 
     std::string Name;
 
     bool clickable;
 
+    // 클릭 판정에서 큰 값이 위
+    int zOrder = 0;
+    // uiHitIndex 내 proxy (clickable이 아니면 -1)
+    int hitProxy = -1;
+
     std::string objectPath;
-    std::string texturePath;
+    std::string texturePath = "textures/Button.png";
+
+    // uiBatcher atlas 안의 (u0, v0, u1, v1). initObject 전에는 그리지 않는다.
+    glm::vec4 uvRect = glm::vec4(0.0f);
+    bool inAtlas = false;
+    bool visible = true;
+    // uiBatcher가 바뀐 요소를 찾는 버전
+    uint64_t batchVersion = 0;
+
+    // UI 트리. Extent와 Position은 부모 Extent의 왼쪽 위 기준 (부모가 없으면 화면)
+    UI* parent = NULL;
+    std::vector<UI*> children;
 
     glm::vec3 Position;
     glm::vec3 Rotate;
 
+    // 화면 기준 픽셀 사각형과 그 정규화 좌표 (그리기 / 클릭 판정용)
+    glm::vec4 worldExtent;
     glm::vec4 normExtent;
     glm::vec4 Extent;
 
-    struct initParam _initParam;
-
-    void createDescriptorSetLayout();
-    void createGraphicsPipeline();
-    void createTextureImage();
-    void createTextureImageView();
-    void createUniformBuffers();
-    void loadModel();
-    void createVertexBuffer();
-    void createIndexBuffer();
-    void createDescriptorPool();
-    void createDescriptorSets();
-
 public:
     UI(std::string Name) {
         this->Name = Name; 
@@ -1111,13 +2744,8 @@ public:
         this->Position = glm::vec3(0.0f);
         this->Rotate = glm::vec3(0.0f);
         this->Extent = glm::vec4(1.0f);
-
-        this->_initParam.vertPath = "spv/UI/vert.spv";
-        this->_initParam.fragPath = "spv/UI/frag.spv";
-
-        this->_initParam.topologyMode = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-        this->_initParam.polygonMode = VK_POLYGON_MODE_FILL;
-        this->_initParam.cullMode = VK_CULL_MODE_NONE;
+        this->worldExtent = this->Extent;
+        this->normExtent = UIBatcher::toNormExtent(this->Extent);
     }
 
     UI(std::string Name, glm::vec3 Position, glm::vec3 Rotate, glm::vec4 extent, glm::vec4 normExtent, bool clickable) {
@@ -1128,14 +2756,8 @@ public:
         this->Position = Position;
         this->Rotate = Rotate;
         this->Extent = extent;
+        this->worldExtent = extent;
         this->normExtent = normExtent;
-
-        this->_initParam.vertPath = "spv/UI/vert.spv";
-        this->_initParam.fragPath = "spv/UI/frag.spv";
-
-        this->_initParam.topologyMode = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-        this->_initParam.polygonMode = VK_POLYGON_MODE_FILL;
-        this->_initParam.cullMode = VK_CULL_MODE_NONE;
     }
 
     UI(std::string Name, glm::vec3 Position, glm::vec3 Rotate, glm::vec4 Extent, bool clickable) {
@@ -1157,24 +2779,33 @@ public:
         this->Position = Position;
         this->Rotate = Rotate;
         this->Extent = Extent;
+        this->worldExtent = Extent;
         this->normExtent = normExtent;
-
-        this->_initParam.vertPath = "spv/UI/vert.spv";
-        this->_initParam.fragPath = "spv/UI/frag.spv";
-
-        this->_initParam.topologyMode = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-        this->_initParam.polygonMode = VK_POLYGON_MODE_FILL;
-        this->_initParam.cullMode = VK_CULL_MODE_NONE;
     }
 
     void setIndex(uint32_t idx)             { this->Index = idx; }
     void setName(std::string name)          { this->Name = name; }
     void setObjectPath(std::string path)    { this->objectPath = path; }
     void setTexturePath(std::string path)   { this->texturePath = path; }
-    void setPosition(glm::vec3 pos)         { this->Position = pos; }
+    // 크기는 그대로 두고 Extent의 왼쪽 위를 pos.xy로 옮긴다
+    void setPosition(glm::vec3 pos)         {   this->Position = pos;
+                                                setExtent(glm::vec4(pos.x, pos.y, pos.x + Extent[2] - Extent[0], pos.y + Extent[3] - Extent[1]));
+                                            }
     void setRotate(glm::vec3 rot)           { this->Rotate = rot; }
-    void setExtent(glm::vec4 ext)           { this->Extent = ext; }
-    void setNormExtent(glm::vec4 ext)           { this->normExtent = ext; }
+    void setExtent(glm::vec4 ext)           { this->Extent = ext; updateWorldExtent(); }
+    void setZOrder(int z)                   { if (z != zOrder) { this->zOrder = z; uiBatcher.touchLayout(); } }
+    void setVisible(bool v)                 { if (v != visible) { this->visible = v; uiBatcher.touchLayout(); } }
+    void setNormExtent(glm::vec4 ext)       { this->normExtent = ext; uiBatcher.touch(batchVersion); }
+
+    // 부모를 바꾼다 (NULL이면 화면). Extent는 새 부모 기준으로 그대로 둔다.
+    void setParent(UI* p)                   {   detach();
+                                                parent = p;
+                                                if (p)
+                                                    p->children.push_back(this);
+
+                                                updateWorldExtent();
+                                                uiBatcher.touchLayout();
+                                            }
 
     uint32_t getIndex()                     { return Index; }
     std::string getName()                   { return Name; }
@@ -1183,75 +2814,163 @@ public:
     glm::vec3 getPosition()                 { return Position; }
     glm::vec3 getRotate()                   { return Rotate; }
     glm::vec4 getExtent()                   { return Extent; }
+    glm::vec4 getWorldExtent()              { return worldExtent; }
     glm::vec4 getNormExtent()               { return normExtent; }
-
+    int getZOrder()                         { return zOrder; }
+    bool isVisible()                        { return visible; }
+    // 자신과 모든 부모가 보일 때
+    bool isShown()                          { return visible && (!parent || parent->isShown()); }
+    UI* getParent()                         { return parent; }
+    const std::vector<UI*>& getChildren()   { return children; }
+
+    // 텍스처를 atlas에 올린다. 정점 / 파이프라인은 uiBatcher가 모든 UI에 대해 하나씩만 가진다.
     void initObject() {
-        createDescriptorSetLayout();
-        createGraphicsPipeline();
-        createTextureImage();
-        createTextureImageView();
-        createUniformBuffers();
-        loadModel();
-        createVertexBuffer();
-        createIndexBuffer();
-        createDescriptorPool();
-        createDescriptorSets();
+        uvRect = uiBatcher.addTexture(texturePath);
+        inAtlas = true;
+        uiBatcher.touchLayout();
     }
 
-    void refresh() {
-        vkDestroyPipeline(device, graphicsPipeline, nullptr);
-        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    // 트리에서 빠지고 자식은 화면 기준으로 남는다 (종료 시 어떤 순서로 불러도 된다)
+    void destroy() {
+        uiHitIndex.remove(this);
 
-        for (size_t i = 0; i < swapChainImages.size(); i++) {
-            vkDestroyBuffer(device, uniformBuffers[i], nullptr);
-            vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
-        }
+        detach();
+        for (UI* child : children)
+            child->parent = NULL;
+        children.clear();
 
-        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        inAtlas = false;
+        uiBatcher.touchLayout();
+    }
 
-        createGraphicsPipeline();
-        createUniformBuffers();
-        createDescriptorPool();
-        createDescriptorSets();
+private:
+    void detach() {
+        if (!parent)
+            return;
+
+        parent->children.erase(std::remove(parent->children.begin(), parent->children.end(), this), parent->children.end());
+        parent = NULL;
     }
 
-    void destroy() {
-        vkDestroyPipeline(device, graphicsPipeline, nullptr);
-        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    // 자신과 자손의 화면 사각형을 다시 계산하고 바뀐 것으로 표시
+    void updateWorldExtent() {
+        glm::vec2 origin = parent ? glm::vec2(parent->worldExtent[0], parent->worldExtent[1]) : glm::vec2(0.0f);
+        worldExtent = Extent + glm::vec4(origin, origin);
+        normExtent = UIBatcher::toNormExtent(worldExtent);
 
-        for (size_t i = 0; i < swapChainImages.size(); i++) {
-            vkDestroyBuffer(device, uniformBuffers[i], nullptr);
-            vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
-        }
+        if (hitProxy != -1)
+            uiHitIndex.update(this);
+        uiBatcher.touch(batchVersion);
+
+        for (UI* child : children)
+            child->updateWorldExtent();
+    }
+};
+
+// TTF 하나를 한 크기로 래스터화한 글리프 (ASCII 32 ~ 126).
+// 흰 글자에 coverage를 alpha로 넣은 비트맵 하나가 uiBatcher atlas의 한 칸을 차지한다.
+class Font {
+public:
+    static const int firstChar = 32;
+    static const int charCount = 95;
 
-        vkDestroyImageView(device, textureImageView, nullptr);
+    // 파일이 없거나 읽을 수 없으면 throw
+    Font(const std::string& path, float pixelHeight);
 
-        vkDestroyImage(device, textureImage, nullptr);
-        vkFreeMemory(device, textureImageMemory, nullptr);
+    float getPixelHeight()                  { return pixelHeight; }
+    float getAscent()                       { return ascent; }
+    float getLineHeight()                   { return lineHeight; }
 
-        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+    // pen(기준선 위, 픽셀)에 c를 놓은 사각형과 uv. pen.x는 다음 글자 자리로 간다. 없는 글자면 false
+    bool getGlyph(char c, glm::vec2& pen, glm::vec4& rect, glm::vec4& uv) {
+        int idx = static_cast<unsigned char>(c) - firstChar;
+        if (idx < 0 || idx >= charCount)
+            return false;
 
-        vkDestroyBuffer(device, indexBuffer, nullptr);
-        vkFreeMemory(device, indexBufferMemory, nullptr);
+        stbtt_aligned_quad q;
+        stbtt_GetPackedQuad(glyphs, bitmapSize, bitmapSize, idx, &pen.x, &pen.y, &q, 1);
 
-        vkDestroyBuffer(device, vertexBuffer, nullptr);
-        vkFreeMemory(device, vertexBufferMemory, nullptr);
+        glm::vec2 uvSize(atlasRect[2] - atlasRect[0], atlasRect[3] - atlasRect[1]);
+        rect = glm::vec4(q.x0, q.y0, q.x1, q.y1);
+        uv = glm::vec4( atlasRect[0] + q.s0 * uvSize.x, atlasRect[1] + q.t0 * uvSize.y,
+                        atlasRect[0] + q.s1 * uvSize.x, atlasRect[1] + q.t1 * uvSize.y);
+        return true;
     }
+
+private:
+    float pixelHeight;
+    float ascent;
+    float lineHeight;
+
+    int bitmapSize;
+    // atlas 안의 글리프 비트맵 영역
+    glm::vec4 atlasRect;
+    stbtt_packedchar glyphs[charCount];
 };
 
-class Text{
-    public:
-        std::vector<UI*> textUI;
-        std::string text;
+// 한 덩어리의 글자. 문자열이 바뀔 때만 글자 사각형을 다시 배치하고 Vulkan 객체는 만들지 않는다.
+// 그리기는 uiBatcher가 UI와 같은 정점 버퍼 / draw에 넣는다.
+class Text {
+public:
+    Text(Font* font, std::string text, glm::vec2 position) : font(font), text(text), position(position) {}
+
+    // uiBatcher가 바뀐 요소를 찾는 버전
+    uint64_t batchVersion = 0;
+
+    // 같은 문자열이면 아무것도 하지 않는다 (FPS 표시 등 매 프레임 호출용)
+    void setText(const std::string& text)   {   if (text != this->text) { this->text = text; markDirty(); } }
+    // 왼쪽 위 (WIDTH x HEIGHT 기준 픽셀)
+    void setPosition(glm::vec2 pos)         { if (pos != position) { this->position = pos; markDirty(); } }
+    void setZOrder(int z)                   { if (z != zOrder) { this->zOrder = z; uiBatcher.touchLayout(); } }
+    void setVisible(bool v)                 { if (v != visible) { this->visible = v; uiBatcher.touchLayout(); } }
+
+    std::string getText()                   { return text; }
+    glm::vec2 getPosition()                 { return position; }
+    int getZOrder()                         { return zOrder; }
+    bool isVisible()                        { return visible; }
+
+    // 배치된 글자 사각형 (공백 / 없는 글자는 빠진다)
+    const std::vector<UIBatcher::UIQuad>& getQuads() {
+        if (dirty)
+            layout();
+        return quads;
+    }
+
+private:
+    Font* font;
+    std::string text;
+    glm::vec2 position;
 
-    void initObject(std::string text, glm::vec3 position) {
-        this->text = text;
+    int zOrder = 0;
+    bool visible = true;
 
-        textUI.resize(text.size());
-        for (int i = 0; i < text.size(); i++) {
-            textUI[i] = new UI("", position, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec4(0, 0, 16, 16), false);
+    bool dirty = true;
+    std::vector<UIBatcher::UIQuad> quads;
+
+    void markDirty() {
+        dirty = true;
+        uiBatcher.touch(batchVersion);
+    }
+
+    void layout() {
+        quads.clear();
+
+        glm::vec2 pen(position.x, position.y + font->getAscent());
+        for (char c : text) {
+            if (c == '\n') {
+                pen.x = position.x;
+                pen.y += font->getLineHeight();
+                continue;
+            }
+
+            glm::vec4 rect, uv;
+            if (!font->getGlyph(c, pen, rect, uv) || rect[0] == rect[2] || rect[1] == rect[3])
+                continue;
+
+            quads.push_back({ UIBatcher::toNormExtent(rect), uv });
         }
+
+        dirty = false;
     }
 };
 
@@ -1267,7 +2986,8 @@ private:
     glm::vec3 cameraFront;
     glm::vec3 cameraUp;
 
-    glm::vec3 Rotation;
+    // view에 곱해지는 회전 (pitch * yaw * roll)
+    glm::quat Orientation;
 
 public: 
     GameObject* target;
@@ -1276,6 +2996,8 @@ public:
         cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
         cameraUp    = glm::vec3(0.0f, 1.0f,  0.0f);
 
+        Orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+
         target = NULL;
     }
 
@@ -1284,7 +3006,7 @@ public:
         cameraUp    = glm::vec3(0.0f, 1.0f,  0.0f);
 
         CameraPosition = pos;
-        Rotation = rot;
+        Orientation = eulerToQuat(rot);
 
         target = NULL;
     }
@@ -1295,7 +3017,8 @@ public:
     void setDirection(glm::vec3 direc)      { this->CameraDirection = direc; }
     void setFront(glm::vec3 front)          { this->cameraFront = front; }
     void setUp(glm::vec3 up)                { this->cameraUp = up; }
-    void setRotate(glm::vec3 rot)           { this->Rotation = rot; }
+    void setRotate(glm::vec3 rot)           { this->Orientation = eulerToQuat(rot); }
+    void setOrientation(glm::quat q)        { this->Orientation = q; }
 
     uint32_t  getIndex()                    { return Index; }
     glm::vec3 getPosition()                 { return CameraPosition; }
@@ -1303,11 +3026,20 @@ public:
     glm::vec3 getDirection()                { return CameraDirection; }
     glm::vec3 getFront()                    { return cameraFront; }
     glm::vec3 getUp()                       { return cameraUp; }
-    glm::vec3 getRotate()                   { return Rotation; }
+    glm::vec3 getRotate()                   { return quatToEuler(Orientation); }
+    glm::quat getOrientation()              { return Orientation; }
+    glm::mat4 getRotationMatrix()           { return glm::mat4_cast(Orientation); }
 
-    void pitch  (float x)                   { this->Rotation.x += x; }
-    void yaw    (float y)                   { this->Rotation.y += y; }
-    void roll   (float z)                   { this->Rotation.z += z; }
+    // 수평 방향 각 (도). pitch가 ±90도를 넘지 않으면 yaw를 누적한 값과 같다.
+    float getYaw() {
+        glm::vec3 front = glm::inverse(Orientation) * glm::vec3(0.0f, 0.0f, -1.0f);
+        return glm::degrees(atan2f(front.x, -front.z));
+    }
+
+    // pitch는 카메라의 x축, yaw는 월드 y축 기준 (roll이 0이면 기존 Rx * Ry * Rz와 같음)
+    void pitch  (float x)                   { this->Orientation = glm::angleAxis(glm::radians(x), glm::vec3(1.0f, 0.0f, 0.0f)) * Orientation; }
+    void yaw    (float y)                   { this->Orientation = Orientation * glm::angleAxis(glm::radians(y), glm::vec3(0.0f, 1.0f, 0.0f)); }
+    void roll   (float z)                   { this->Orientation = Orientation * glm::angleAxis(glm::radians(z), glm::vec3(0.0f, 0.0f, 1.0f)); }
 
     void moveX(glm::vec3 delta) {
         CameraPosition += delta * 0.001f; 
@@ -1365,9 +3097,15 @@ public:
 
 std::vector<GameObject*> gameObjectList;
 std::vector<UI*> UIList;
+std::vector<Text*> textList;
+std::vector<Font*> fontList;
 std::vector<Camera*> cameraObejctList;
 std::vector<Light*> lightObjectList;
 
+// inputReplay.frame (아래 InputReplay). 기록 중이면 이번 프레임 입력과 frameTime을 남기고,
+// 재생 중이면 둘 다 파일 값으로 바꾸고 time에 누적 시간을 넣는다 (true)
+bool replayInputFrame(float& frameTime, float& time);
+
 class routine {
 public:
     std::chrono::_V2::system_clock::time_point startTime;
@@ -1375,6 +3113,8 @@ public:
     std::chrono::_V2::system_clock::time_point previousTime;
     // Time Per Routine
     float _TIME, _TIME_PER_UPDATE;
+    // PhysicalUpdate 간격 (physicsScheduler의 고정 step)
+    float _TIME_PER_PHYSICAL_UPDATE;
 
     virtual void Awake() {
         TexelBufferObject.push_back(1.0f);
@@ -1390,46 +3130,276 @@ public:
     virtual void Start() {
         startTime = std::chrono::high_resolution_clock::now();
         previousTime = startTime;
+
+        _TIME_PER_PHYSICAL_UPDATE = physicsScheduler.getStep();
     }
 
     virtual void Update() {
+        PROFILE_ZONE("routine::Update");
+
         currentTime = std::chrono::high_resolution_clock::now();
 
         _TIME = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
         _TIME_PER_UPDATE = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - previousTime).count();
 
         previousTime = currentTime;
+
+        replayInputFrame(_TIME_PER_UPDATE, _TIME);
     }
 
+    // physicsScheduler가 고정 간격으로 호출 (Transform은 drawFrame에서 보간)
     virtual void PhysicalUpdate() {
+        PROFILE_ZONE("routine::PhysicalUpdate");
 
+        bodyStore.integrate(_TIME_PER_PHYSICAL_UPDATE);
+        applyContinuousCollision();
+        bodyStore.syncColliders();
+        updateCollisions(_TIME_PER_PHYSICAL_UPDATE);
+        rebuildProximityGrid();
     }
 
     virtual void End() {}
 };
 
+// 생산자 하나 / 소비자 하나의 고정 크기 링 (락 없음). N은 2의 거듭제곱
+template <typename T, size_t N>
+class SPSCQueue {
+    static_assert((N & (N - 1)) == 0, "SPSCQueue 크기는 2의 거듭제곱");
+
+public:
+    // 생산 스레드에서만. 꽉 차면 버리고 false
+    bool push(const T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        items[h & (N - 1)] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 소비 스레드에서만. 비었으면 false
+    bool pop(T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+
+        value = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint64_t getDropped()                   { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    // 생산 / 소비 쪽 index가 같은 cache line을 두고 다투지 않게 떨어뜨린다
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+    T items[N];
+};
+
+// GLFW 콜백이 쌓는 입력 하나. time은 glfwGetTime (초)
+struct InputEvent {
+    enum Type : uint8_t { Key, MouseButton, MouseMove, Scroll };
+
+    Type type;
+    // Key / MouseButton: GLFW key / button 번호, MouseMove: 1이면 위치만 다시 잡는다 (delta 없음)
+    int code;
+    // GLFW_PRESS / GLFW_RELEASE / GLFW_REPEAT
+    int action;
+    // MouseMove: 커서 위치 (raw 모드면 가속 없는 누적 좌표), Scroll: offset
+    double x, y;
+    double time;
+};
+
+// input::update 한 번 사이에 모인 입력 상태
+struct InputSnapshot {
+    static const int keyCount = GLFW_KEY_LAST + 1;
+    static const int buttonCount = GLFW_MOUSE_BUTTON_LAST + 1;
+
+    // bit: held = 눌려 있음, pressed / released = 이번 update 사이에 바뀜 (한 프레임에 눌렀다 떼도 둘 다 남는다)
+    enum : uint8_t { held = 1, pressed = 2, released = 4 };
+
+    uint8_t keys[keyCount] = {};
+    uint8_t buttons[buttonCount] = {};
+    // 마지막으로 바뀐 시각
+    double keyTime[keyCount] = {};
+    double buttonTime[buttonCount] = {};
+
+    glm::dvec2 mousePos = glm::dvec2(0.0);
+    // 이번 update 사이 이동량 합과 휠
+    glm::dvec2 mouseDelta = glm::dvec2(0.0);
+    glm::dvec2 scroll = glm::dvec2(0.0);
+    bool hasMousePos = false;
+
+    // update 시각과 반영한 이벤트 수
+    double time = 0.0;
+    uint32_t eventCount = 0;
+};
+
+// GLFW 콜백(메인 스레드)이 이벤트를 events에 넣고, update를 부르는 스레드 하나가 꺼내 snapshot을 만든다.
+// 조회 함수는 모두 마지막 snapshot을 읽으므로 Update 안에서 언제 불러도 같은 값이다.
 namespace input {
-        bool mouseLock = false;
-        bool keyLock = false;
-
-        double _hX = -1;
-        double _hY = -1;
-        double _hpX = -1;
-        double _hpY = -1;
-        double _vX = -1;
-        double _vY = -1;
-        double _vpX = -1;
-        double _vpY = -1;
+        SPSCQueue<InputEvent, 4096> events;
+        InputSnapshot snapshot;
+
+        // 콜백 등록. initWindow에서
+        void init(GLFWwindow* window);
+        // 쌓인 이벤트를 snapshot에 반영. 프레임(또는 시뮬레이션 step)마다 한 스레드에서만
+        void update();
+        // 콜백과 같은 스레드에서 이벤트를 직접 넣는다
+        void push(const InputEvent& e);
+
+        // 커서를 숨기고 가속 없는 마우스 이동을 받는다 (지원하지 않으면 false). 메인 스레드에서
+        bool setRawMouse(bool enable);
+
+        const InputSnapshot& getSnapshot();
 
         bool getKeyDown(int key);
         bool getKey(int key);
         bool getKeyUp(int key);
+        double getKeyTime(int key);
 
         bool getMouseButtonDown(int key);
         bool getMouseButton(int key);
         bool getMouseButtonUp(int key);
 
         void getMousePos(double& w, double& h);
+        void getMouseDelta(double& dx, double& dy);
         int getMouseVAxis();
         int getMouseHAxis();
-}
\ No newline at end of file
+}
+
+// 프레임마다 input snapshot과 _TIME_PER_UPDATE를 이진 파일로 남기고 (--record), 그대로 되돌린다 (--replay).
+// 재생 중에는 실제 입력과 시계 대신 파일 값을 쓰므로 같은 파일이면 카메라 / 빛 / 물리 step이 매번 같다.
+// 파일: "VKIR" + 버전, 프레임마다 frameTime, 바뀐 key / button 상태, 마우스 / 휠 (바뀐 것만)
+class InputReplay {
+public:
+    enum Mode { Off, Recording, Replaying };
+
+    static const uint32_t version = 1;
+
+    // 파일을 열 수 없거나 형식이 다르면 throw
+    void startRecording(const std::string& path);
+    void startReplay(const std::string& path);
+    // 파일을 닫는다. 재생이었으면 프레임 수와 평균 프레임 시간 (실제 시계)을 출력
+    void stop();
+
+    // routine::Update에서 프레임 시간이 정해진 뒤 (replayInputFrame). 재생할 프레임이 끝나면 창을 닫는다.
+    bool frame(float& frameTime, float& totalTime);
+
+    Mode getMode()                          { return mode; }
+    uint64_t getFrameCount()                { return frameCount; }
+
+private:
+    Mode mode = Off;
+    std::ofstream out;
+    std::ifstream in;
+
+    // 직전 프레임 상태. 기록은 이것과 다른 것만 쓰고 재생은 여기에 바뀐 것을 덮어 쓴다.
+    InputSnapshot state;
+    uint64_t frameCount = 0;
+    double time = 0.0;
+    std::chrono::steady_clock::time_point wallStart;
+
+    void writeFrame(float frameTime);
+    bool readFrame(float& frameTime);
+};
+
+InputReplay inputReplay;
+
+// buffer / image 내용을 한 번 읽어 온다 (복사가 끝날 때까지 기다림). 매 프레임 읽기는 frameCapture.
+// buffer는 TRANSFER_SRC usage, image는 4바이트 픽셀 형식이고 layout 상태여야 한다 (끝나면 layout으로 되돌린다).
+std::vector<unsigned char> getBufferData(VkBuffer buffer, VkDeviceSize deviceSize);
+std::vector<unsigned char> getImageData(VkImage src, VkImageLayout layout, VkExtent2D extent);
+
+// 그린 이미지를 프레임마다 영구 매핑된 readback 버퍼 ring에 복사하고, 복사가 끝난 (fence) 슬롯을
+// 몇 프레임 뒤 소비 스레드에 넘긴다. 렌더링 스레드는 fence를 기다리지 않고, ring이 꽉 차면 그 프레임을 버린다.
+// 동영상 저장, 스트리밍, golden image 비교용
+class FrameCapture {
+public:
+    struct Frame {
+        // 캡처 순번 (버린 프레임은 번호를 받지 않는다)
+        uint64_t index;
+        uint32_t width, height;
+        // 4바이트 픽셀 (B8G8R8A8 / R8G8B8A8)
+        VkFormat format;
+        // 빈틈 없이 width * 4 바이트씩. 콜백 안에서만 유효
+        const unsigned char* pixels;
+    };
+
+    typedef std::function<void(const Frame&)> Consumer;
+
+    // 슬롯 수. 소비가 이만큼 밀리면 프레임을 버린다
+    uint32_t ringSize = 3;
+
+    // initVulkan 뒤. 창 모드는 swapchain 이미지를 복사할 수 있어야 한다 (아니면 throw)
+    void start(Consumer consumer);
+    // 남은 복사를 기다려 모두 소비시키고 정리
+    void stop();
+    // swapchain을 다시 만든 뒤 (크기 / 형식에 맞춰 ring을 다시 만든다)
+    void refresh();
+
+    bool isActive()                         { return active; }
+
+    // drawFrame에서 프레임 submit 직후. image(layout)를 빈 슬롯으로 복사하는 submit을 하나 더 한다.
+    // wait가 있으면 그것을 기다리고 present가 대신 기다릴 semaphore를 돌려준다. 버린 프레임이면 VK_NULL_HANDLE
+    VkSemaphore capture(VkImage image, VkImageLayout layout, VkSemaphore wait);
+
+    uint64_t getCapturedCount()             { return capturedCount; }
+    uint64_t getDroppedCount()              { return droppedCount; }
+
+    // B8G8R8A8 / R8G8B8A8 프레임을 binary PPM으로 (다른 형식이면 throw)
+    static void savePPM(const Frame& frame, const std::string& path);
+
+private:
+    enum SlotState { Free, InFlight, Consuming };
+
+    struct Slot {
+        VkBuffer buffer;
+        VkDeviceMemory memory;
+        void* data;
+        VkCommandBuffer commandBuffer;
+        VkFence fence;
+        VkSemaphore semaphore;
+        uint64_t index;
+        // Free -> InFlight (렌더링 스레드) -> Consuming (collect) -> Free (소비 스레드)
+        std::atomic<int> state{ Free };
+    };
+
+    bool active = false;
+    Consumer consumer;
+
+    std::unique_ptr<Slot[]> slots;
+    uint32_t slotCount = 0;
+    // 다음에 쓸 슬롯이자 가장 오래된 슬롯
+    uint32_t next = 0;
+    uint64_t frameIndex = 0;
+
+    VkExtent2D extent;
+    VkFormat format;
+    VkDeviceSize frameSize;
+    // HOST_COHERENT가 아니면 넘기기 전에 invalidate
+    bool coherent;
+
+    std::atomic<uint64_t> capturedCount{ 0 };
+    uint64_t droppedCount = 0;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable readyCondition;
+    // 복사가 끝나 소비를 기다리는 슬롯
+    std::deque<uint32_t> ready;
+    bool stopping = false;
+
+    void createSlots();
+    void destroySlots();
+    // 복사가 끝난 슬롯을 오래된 것부터 소비 스레드에 넘긴다 (기다리지 않는다)
+    void collect();
+    void consumeLoop();
+};
+
+FrameCapture frameCapture;